@@ -0,0 +1,84 @@
+#include "json2doc/batch_renderer.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Benchmark: BatchRenderer throughput by thread count
+ *
+ * Renders a DOCX-like template against the same set of JSON records with
+ * 1, 2, 4, ... worker threads up to the hardware thread count and reports
+ * records per second and the speedup over one thread.
+ */
+
+std::string buildTemplate(int paragraphs)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (int p = 0; p < paragraphs; p++)
+    {
+        xml += "<w:p><w:r><w:t>Dear {{customer.name}}, order {{order.id}} totals {{order.total}}.</w:t></w:r></w:p>"
+               "<w:p><w:r><w:t>Static paragraph text that has no placeholder in it.</w:t></w:r></w:p>";
+    }
+    xml += "</w:body></w:document>";
+    return xml;
+}
+
+int main()
+{
+    const size_t recordCount = 20000;
+    std::vector<std::string> records;
+    for (size_t i = 0; i < recordCount; i++)
+    {
+        std::string n = std::to_string(i);
+        records.push_back("{\"customer\": {\"name\": \"Customer " + n + "\"}, \"order\": {\"id\": \"A-" + n +
+                          "\", \"total\": " + n + ".50}}");
+    }
+    std::string xml = buildTemplate(20);
+
+    size_t hardware = std::thread::hardware_concurrency();
+    if (hardware == 0)
+    {
+        hardware = 1;
+    }
+
+    std::cout << "\nBatch rendering benchmark (" << recordCount << " records, " << xml.size() << " byte template)\n\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(16) << "records/s" << "speedup\n";
+
+    double baseline = 0;
+    for (size_t threads = 1; threads <= hardware; threads *= 2)
+    {
+        json2doc::BatchRenderer renderer(threads);
+        if (!renderer.loadTemplateString(xml))
+        {
+            std::cerr << renderer.getLastError() << "\n";
+            return 1;
+        }
+
+        size_t bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        size_t rendered = renderer.render(records.begin(), records.end(), [&bytes](json2doc::BatchRenderer::Result &&result)
+                                          { bytes += result.output.size(); });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (rendered != recordCount || bytes == 0)
+        {
+            std::cerr << "rendering failed\n";
+            return 1;
+        }
+
+        double rate = recordCount / seconds;
+        if (threads == 1)
+        {
+            baseline = rate;
+        }
+        std::cout << std::left << std::setw(10) << threads << std::fixed << std::setprecision(0) << std::setw(16)
+                  << rate << std::setprecision(2) << rate / baseline << "x\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
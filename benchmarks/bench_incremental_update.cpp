@@ -0,0 +1,84 @@
+#include "json2doc/json_merge.h"
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Benchmark: one-field edit, full re-render vs applyPatch() + updateXml()
+ *
+ * The full path reloads the template and merges it again. The incremental
+ * path patches one JSON field and rewrites only the text nodes that use it.
+ */
+
+const size_t kFields = 1000;
+
+std::string buildTemplate(size_t paragraphs)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (size_t i = 0; i < paragraphs; i++)
+    {
+        xml += "<w:p><w:r><w:t>{{customer.name}}: {{items.field" + std::to_string(i % kFields) + "}}</w:t></w:r></w:p>";
+    }
+    xml += "</w:body></w:document>";
+    return xml;
+}
+
+std::string buildJson()
+{
+    std::string json = "{\"customer\": {\"name\": \"Ana\", \"city\": \"Lisboa\"}, \"items\": {";
+    for (size_t i = 0; i < kFields; i++)
+    {
+        json += (i ? ", " : "") + std::string("\"field") + std::to_string(i) + "\": " + std::to_string(i);
+    }
+    json += "}}";
+    return json;
+}
+
+int main()
+{
+    std::cout << "\nOne-field edit on a rendered document (" << kFields << " distinct fields)\n\n";
+    std::cout << std::left << std::setw(12) << "paragraphs" << std::setw(16) << "full (ms)" << std::setw(18)
+              << "incremental (us)" << "nodes rewritten\n";
+
+    for (size_t paragraphs : {10000, 50000, 100000})
+    {
+        std::string xml = buildTemplate(paragraphs);
+        json2doc::JsonMerge merger;
+        json2doc::XmlDocument doc;
+        if (!merger.loadJsonString(buildJson()) || !doc.loadFromString(xml))
+        {
+            std::cerr << "load failed\n";
+            return 1;
+        }
+        merger.bindToXml(doc);
+
+        // Full: reload and merge everything
+        auto start = std::chrono::steady_clock::now();
+        json2doc::XmlDocument full;
+        full.loadFromString(xml);
+        merger.mergeIntoXml(full);
+        auto fullDone = std::chrono::steady_clock::now();
+
+        // Incremental: a field used by one paragraph in kFields
+        std::vector<std::string> keys = merger.applyPatch("{\"items\": {\"field7\": \"edited\"}}");
+        int rewritten = merger.updateXml(doc, keys);
+        auto incrementalDone = std::chrono::steady_clock::now();
+
+        if (rewritten != static_cast<int>((paragraphs + kFields - 8) / kFields))
+        {
+            std::cerr << "unexpected rewrite count " << rewritten << "\n";
+            return 1;
+        }
+
+        double fullMs = std::chrono::duration<double, std::milli>(fullDone - start).count();
+        double incrementalUs = std::chrono::duration<double, std::micro>(incrementalDone - fullDone).count();
+        std::cout << std::left << std::setw(12) << paragraphs << std::fixed << std::setprecision(2) << std::setw(16)
+                  << fullMs << std::setw(18) << incrementalUs << rewritten << "\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
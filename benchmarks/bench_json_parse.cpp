@@ -0,0 +1,289 @@
+#include "json2doc/json_merge.h"
+#include "json2doc/json_parser.h"
+#include "json2doc/structural_index.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <string>
+#include <cctype>
+
+/**
+ * @brief Benchmark: single-pass JsonParser vs the former recursive flattener
+ *
+ * The legacy implementation below is the algorithm JsonMerge used before the
+ * single-pass parser (trim + extractObject substring copy + recursion), kept
+ * here only as a baseline. A second table reports the throughput of the
+ * structural indexing stage for each kernel the CPU supports.
+ */
+
+namespace legacy
+{
+    std::string trim(const std::string &str)
+    {
+        if (str.empty())
+        {
+            return str;
+        }
+        size_t start = 0;
+        size_t end = str.length() - 1;
+        while (start <= end && std::isspace(str[start]))
+        {
+            start++;
+        }
+        while (end >= start && std::isspace(str[end]))
+        {
+            end--;
+        }
+        if (start > end)
+        {
+            return "";
+        }
+        return str.substr(start, end - start + 1);
+    }
+
+    std::string extractBalanced(const std::string &json, size_t startPos, char open, char close)
+    {
+        int count = 0;
+        for (size_t pos = startPos; pos < json.length(); pos++)
+        {
+            if (json[pos] == open)
+            {
+                count++;
+            }
+            else if (json[pos] == close && --count == 0)
+            {
+                return json.substr(startPos, pos - startPos + 1);
+            }
+        }
+        return "";
+    }
+
+    void parseNestedJson(const std::string &jsonString, const std::string &prefix,
+                         std::map<std::string, std::string> &out)
+    {
+        std::string cleaned = trim(jsonString);
+        if (cleaned.empty() || cleaned.front() != '{')
+        {
+            return;
+        }
+
+        size_t pos = 1;
+        while (pos < cleaned.length())
+        {
+            while (pos < cleaned.length() && std::isspace(cleaned[pos]))
+            {
+                pos++;
+            }
+            if (pos >= cleaned.length() || cleaned[pos] == '}')
+            {
+                break;
+            }
+            if (cleaned[pos] != '"')
+            {
+                pos++;
+                continue;
+            }
+
+            size_t keyStart = pos + 1;
+            size_t keyEnd = cleaned.find('"', keyStart);
+            if (keyEnd == std::string::npos)
+            {
+                break;
+            }
+            std::string key = cleaned.substr(keyStart, keyEnd - keyStart);
+            pos = keyEnd + 1;
+            while (pos < cleaned.length() && cleaned[pos] != ':')
+            {
+                pos++;
+            }
+            pos++;
+            while (pos < cleaned.length() && std::isspace(cleaned[pos]))
+            {
+                pos++;
+            }
+
+            std::string fullKey = prefix.empty() ? key : prefix + "." + key;
+            if (cleaned[pos] == '"')
+            {
+                size_t valueStart = pos + 1;
+                size_t valueEnd = cleaned.find('"', valueStart);
+                if (valueEnd != std::string::npos)
+                {
+                    out[fullKey] = cleaned.substr(valueStart, valueEnd - valueStart);
+                    pos = valueEnd + 1;
+                }
+            }
+            else if (cleaned[pos] == '{')
+            {
+                std::string obj = extractBalanced(cleaned, pos, '{', '}');
+                parseNestedJson(obj, fullKey, out);
+                pos += obj.length() + 1;
+            }
+            else if (cleaned[pos] == '[')
+            {
+                std::string arr = extractBalanced(cleaned, pos, '[', ']');
+                out[fullKey] = arr;
+                pos += arr.length() + 1;
+            }
+            else
+            {
+                size_t valueStart = pos;
+                while (pos < cleaned.length() && cleaned[pos] != ',' && cleaned[pos] != '}' && cleaned[pos] != ']')
+                {
+                    pos++;
+                }
+                out[fullKey] = trim(cleaned.substr(valueStart, pos - valueStart));
+            }
+
+            while (pos < cleaned.length() && (cleaned[pos] == ',' || std::isspace(cleaned[pos])))
+            {
+                pos++;
+            }
+        }
+    }
+} // namespace legacy
+
+// Build a data.json-style document with `records` top-level objects nested `depth` levels
+std::string buildNestedJson(int records, int depth)
+{
+    std::string json = "{\n";
+    for (int r = 0; r < records; r++)
+    {
+        json += "    \"record" + std::to_string(r) + "\": ";
+        for (int d = 0; d < depth; d++)
+        {
+            json += "{\n        \"title\": \"Sample Document " + std::to_string(r) + "\",\n";
+            json += "        \"author\": \"John Doe\",\n";
+            json += "        \"version\": " + std::to_string(d) + ",\n";
+            json += "        \"sections\": [{\"heading\": \"Introduction\"}, {\"heading\": \"Features\"}],\n";
+            json += "        \"level\": ";
+        }
+        json += "\"leaf\"";
+        for (int d = 0; d < depth; d++)
+        {
+            json += "}";
+        }
+        json += (r + 1 < records) ? ",\n" : "\n";
+    }
+    json += "}\n";
+    return json;
+}
+
+template <typename Fn>
+double timeMs(Fn fn, int iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main()
+{
+    std::cout << "\nJSON flattening benchmark (legacy recursive vs single-pass)\n\n";
+    std::cout << std::left << std::setw(10) << "records" << std::setw(8) << "depth"
+              << std::setw(12) << "size (KB)" << std::setw(14) << "legacy (ms)"
+              << std::setw(14) << "parser (ms)" << "speedup\n";
+
+    const int configs[][2] = {{100, 2}, {100, 8}, {1000, 4}, {1000, 16}, {5000, 8}};
+
+    for (const auto &config : configs)
+    {
+        std::string json = buildNestedJson(config[0], config[1]);
+        int iterations = json.size() > (4 << 20) ? 3 : 10;
+
+        std::map<std::string, std::string> legacyOut;
+        double legacyMs = timeMs([&]()
+                                 { legacyOut.clear(); legacy::parseNestedJson(json, "", legacyOut); },
+                                 iterations);
+
+        json2doc::JsonMerge merger;
+        double parserMs = timeMs([&]()
+                                 { merger.loadJsonString(json); },
+                                 iterations);
+
+        if (merger.getAllKeys().size() != legacyOut.size())
+        {
+            std::cerr << "Key count mismatch: " << merger.getAllKeys().size()
+                      << " vs " << legacyOut.size() << "\n";
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(10) << config[0] << std::setw(8) << config[1]
+                  << std::setw(12) << json.size() / 1024 << std::setw(14) << std::fixed
+                  << std::setprecision(2) << legacyMs << std::setw(14) << parserMs
+                  << legacyMs / parserMs << "x\n";
+    }
+
+    // Stage 1 throughput per kernel, and the full parse without map insertion
+    std::string json = buildNestedJson(5000, 8);
+    double megabytes = json.size() / (1024.0 * 1024.0);
+    std::vector<uint32_t> positions;
+
+    std::cout << "\nStructural indexing (" << std::fixed << std::setprecision(1) << megabytes << " MB)\n\n";
+    std::cout << std::left << std::setw(10) << "kernel" << std::setw(14) << "time (ms)" << "MB/s\n";
+
+    const json2doc::StructuralIndex::Backend backends[] = {json2doc::StructuralIndex::Backend::Scalar,
+                                                           json2doc::StructuralIndex::Backend::Sse42,
+                                                           json2doc::StructuralIndex::Backend::Avx2};
+    for (auto backend : backends)
+    {
+        if (!json2doc::StructuralIndex::isSupported(backend))
+        {
+            continue;
+        }
+        double ms = timeMs([&]()
+                           { positions.clear(); json2doc::StructuralIndex::classify(json.data(), json.size(), backend, positions); },
+                           10);
+        std::cout << std::left << std::setw(10) << json2doc::StructuralIndex::backendName(backend)
+                  << std::setw(14) << std::setprecision(2) << ms << std::setprecision(0)
+                  << megabytes / (ms / 1000.0) << "\n";
+    }
+
+    json2doc::JsonParser parser;
+    size_t values = 0;
+    double parseMs = timeMs([&]()
+                            { parser.parse(json, [&](const std::string &, const char *, size_t, uint32_t)
+                                           { values++; }); },
+                            10);
+    std::cout << std::left << std::setw(10) << "parse" << std::setw(14) << std::setprecision(2) << parseMs
+              << std::setprecision(0) << megabytes / (parseMs / 1000.0) << "  (no storage)\n";
+
+    // Demand-driven loading: a template that references a dozen of the keys
+    std::vector<std::string> required;
+    for (int r = 0; r < 4; r++)
+    {
+        std::string record = "record" + std::to_string(r * 1000);
+        required.push_back(record + ".title");
+        required.push_back(record + ".author");
+        required.push_back(record + ".level.level.version");
+    }
+
+    json2doc::JsonMerge fullMerger;
+    double fullMs = timeMs([&]()
+                           { fullMerger.loadJsonString(json); },
+                           10);
+    json2doc::JsonMerge requiredMerger;
+    requiredMerger.setRequiredVariables(required);
+    double requiredMs = timeMs([&]()
+                               { requiredMerger.loadJsonString(json); },
+                               10);
+    if (requiredMerger.getAllKeys().size() != required.size())
+    {
+        std::cerr << "Required key count mismatch\n";
+        return 1;
+    }
+
+    std::cout << "\nLoading with " << required.size() << " required variables\n\n";
+    std::cout << std::left << std::setw(10) << "all keys" << std::setw(14) << std::setprecision(2) << fullMs
+              << fullMerger.getAllKeys().size() << " keys\n";
+    std::cout << std::left << std::setw(10) << "required" << std::setw(14) << requiredMs
+              << requiredMerger.getAllKeys().size() << " keys, " << fullMs / requiredMs << "x faster\n";
+
+    std::cout << "\n";
+    return 0;
+}
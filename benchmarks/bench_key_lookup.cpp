@@ -0,0 +1,128 @@
+#include "json2doc/key_index.h"
+#include "json2doc/json_merge.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+/**
+ * @brief Benchmark: flattened key lookup, std::map vs KeyIndex
+ *
+ * Looks up every key of a data.json-style key set (plus as many misses) in
+ * the std::map JsonMerge used to store its data, in std::unordered_map for
+ * reference, and in the open-addressing KeyIndex that backs JsonMerge now.
+ */
+
+std::vector<std::string> buildKeys(size_t count)
+{
+    const char *fields[] = {"title", "author", "metadata.version", "metadata.status", "sections"};
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; keys.size() < count; i++)
+    {
+        for (const char *field : fields)
+        {
+            if (keys.size() == count)
+            {
+                break;
+            }
+            keys.push_back("record" + std::to_string(i) + "." + field);
+        }
+    }
+    return keys;
+}
+
+template <typename Fn>
+double nsPerLookup(Fn fn, size_t lookups)
+{
+    // Repeat small sets so every measurement covers at least ~2M lookups
+    size_t rounds = std::max<size_t>(1, 2000000 / lookups);
+    auto start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        hits += fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (hits == 0)
+    {
+        std::cerr << "no hits\n";
+    }
+    return std::chrono::duration<double, std::nano>(end - start).count() / (rounds * lookups);
+}
+
+int main()
+{
+    std::cout << "\nKey lookup benchmark (ns per lookup, 50% hits)\n\n";
+    std::cout << std::left << std::setw(10) << "keys" << std::setw(12) << "std::map"
+              << std::setw(16) << "unordered_map" << std::setw(12) << "KeyIndex"
+              << "vs map\n";
+
+    const size_t sizes[] = {10, 100, 1000, 10000, 100000, 1000000};
+    std::string value = "value";
+
+    for (size_t count : sizes)
+    {
+        std::vector<std::string> keys = buildKeys(count);
+        std::vector<std::string> probes;
+        probes.reserve(count * 2);
+        for (const auto &key : keys)
+        {
+            probes.push_back(key);
+            probes.push_back(key + "x");
+        }
+        // Random order, so consecutive probes do not share a path in the tree
+        std::shuffle(probes.begin(), probes.end(), std::mt19937(42));
+
+        std::map<std::string, std::string> ordered;
+        std::unordered_map<std::string, std::string> unordered;
+        json2doc::KeyIndex index;
+        json2doc::Arena indexKeys;
+        for (const auto &key : keys)
+        {
+            ordered[key] = value;
+            unordered[key] = value;
+            index.insert(key, value, indexKeys);
+        }
+
+        double mapNs = nsPerLookup([&]()
+                                   {
+                                       size_t hits = 0;
+                                       for (const auto &probe : probes)
+                                       {
+                                           hits += ordered.find(probe) != ordered.end();
+                                       }
+                                       return hits; },
+                                   probes.size());
+        double unorderedNs = nsPerLookup([&]()
+                                         {
+                                             size_t hits = 0;
+                                             for (const auto &probe : probes)
+                                             {
+                                                 hits += unordered.find(probe) != unordered.end();
+                                             }
+                                             return hits; },
+                                         probes.size());
+        double indexNs = nsPerLookup([&]()
+                                     {
+                                         size_t hits = 0;
+                                         for (const auto &probe : probes)
+                                         {
+                                             hits += index.find(probe) != nullptr;
+                                         }
+                                         return hits; },
+                                     probes.size());
+
+        std::cout << std::left << std::setw(10) << count << std::fixed << std::setprecision(1)
+                  << std::setw(12) << mapNs << std::setw(16) << unorderedNs << std::setw(12) << indexNs
+                  << std::setprecision(2) << mapNs / indexNs << "x\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "json2doc/placeholder_scanner.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Microbenchmark: {{variable}} scanning, std::regex vs PlaceholderScanner
+ *
+ * Runs the regex loop the merge code used before (regex_search per match)
+ * and PlaceholderScanner over the same inputs: many short text nodes as in a
+ * DOCX body, one large text, and inputs full of unmatched braces.
+ */
+
+struct Input
+{
+    std::string name;
+    std::vector<std::string> texts;
+};
+
+size_t scanRegex(const std::vector<std::string> &texts)
+{
+    // Built once, outside the loop, which is already kinder than the old call sites
+    static const std::regex varRegex(R"(\{\{([^}]+)\}\})");
+    size_t matches = 0;
+    for (const auto &text : texts)
+    {
+        std::smatch match;
+        std::string::const_iterator searchStart(text.cbegin());
+        while (std::regex_search(searchStart, text.cend(), match, varRegex))
+        {
+            matches++;
+            searchStart = match.suffix().first;
+        }
+    }
+    return matches;
+}
+
+size_t scanScanner(const std::vector<std::string> &texts)
+{
+    size_t matches = 0;
+    for (const auto &text : texts)
+    {
+        json2doc::PlaceholderScanner scanner(text);
+        json2doc::PlaceholderScanner::Match match;
+        while (scanner.next(match))
+        {
+            matches++;
+        }
+    }
+    return matches;
+}
+
+template <typename Fn>
+double mbPerSecond(Fn fn, const std::vector<std::string> &texts, size_t &matches)
+{
+    size_t bytes = 0;
+    for (const auto &text : texts)
+    {
+        bytes += text.size();
+    }
+
+    // Repeat until at least ~0.2 s has been measured
+    size_t rounds = 0;
+    double seconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (seconds < 0.2)
+    {
+        matches = fn(texts);
+        rounds++;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return bytes * rounds / seconds / 1e6;
+}
+
+int main()
+{
+    std::vector<Input> inputs;
+
+    Input nodes{"docx text nodes", {}};
+    for (int i = 0; i < 5000; i++)
+    {
+        nodes.texts.push_back(i % 4 == 0 ? "Client: {{client.name}} ({{ client.id }})" : "Plain paragraph text without any placeholder at all.");
+    }
+    inputs.push_back(nodes);
+
+    Input large{"single 1 MB text", {""}};
+    while (large.texts[0].size() < (1 << 20))
+    {
+        large.texts[0] += "Lorem ipsum dolor sit amet, {{section.title}} consectetur adipiscing elit. ";
+    }
+    inputs.push_back(large);
+
+    Input braces{"unmatched braces", {""}};
+    while (braces.texts[0].size() < (1 << 16))
+    {
+        braces.texts[0] += "{{{{ a } b {{ c }";
+    }
+    inputs.push_back(braces);
+
+    std::cout << "\nPlaceholder scanning benchmark (MB/s)\n\n";
+    std::cout << std::left << std::setw(20) << "input" << std::setw(10) << "matches" << std::setw(12) << "regex"
+              << std::setw(12) << "scanner" << "speedup\n";
+
+    for (const auto &input : inputs)
+    {
+        size_t regexMatches = 0;
+        size_t scannerMatches = 0;
+        double regexMb = mbPerSecond(scanRegex, input.texts, regexMatches);
+        double scannerMb = mbPerSecond(scanScanner, input.texts, scannerMatches);
+
+        if (regexMatches != scannerMatches)
+        {
+            std::cerr << "match count differs for " << input.name << "\n";
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(20) << input.name << std::setw(10) << scannerMatches << std::fixed
+                  << std::setprecision(1) << std::setw(12) << regexMb << std::setw(12) << scannerMb
+                  << scannerMb / regexMb << "x\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "json2doc/json_merge.h"
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Benchmark: {{#rows}} table expansion by row count
+ *
+ * Merges a one-row Word table template against JSON arrays of 1k to 50k
+ * elements and reports the time per row, which should stay flat as the row
+ * count grows (linear total cost).
+ */
+
+std::string buildTemplate()
+{
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>"
+           "<w:p><w:r><w:t>{{title}}</w:t></w:r></w:p><w:tbl>"
+           "<w:tr><w:tc><w:p><w:r><w:t>Name</w:t></w:r></w:p></w:tc><w:tc><w:p><w:r><w:t>Amount</w:t></w:r></w:p></w:tc></w:tr>"
+           "<w:tr><w:tc><w:p><w:r><w:t>{{#rows}}{{name}}</w:t></w:r></w:p></w:tc>"
+           "<w:tc><w:p><w:r><w:t>{{amount}}{{/rows}}</w:t></w:r></w:p></w:tc></w:tr>"
+           "</w:tbl></w:body></w:document>";
+}
+
+std::string buildJson(size_t rows)
+{
+    std::string json = "{\"title\": \"Ledger\", \"rows\": [";
+    for (size_t i = 0; i < rows; i++)
+    {
+        std::string n = std::to_string(i);
+        json += (i ? ", " : "") + std::string("{\"name\": \"Row ") + n + "\", \"amount\": " + n + ".25}";
+    }
+    json += "]}";
+    return json;
+}
+
+int main()
+{
+    std::string xml = buildTemplate();
+
+    std::cout << "\nRepeating section expansion (one w:tr per array element)\n\n";
+    std::cout << std::left << std::setw(10) << "rows" << std::setw(14) << "load (ms)" << std::setw(14) << "merge (ms)"
+              << "ns/row\n";
+
+    for (size_t rows : {1000, 5000, 10000, 50000})
+    {
+        std::string json = buildJson(rows);
+        json2doc::JsonMerge merger;
+        json2doc::XmlDocument doc;
+
+        auto start = std::chrono::steady_clock::now();
+        if (!merger.loadJsonString(json) || !doc.loadFromString(xml))
+        {
+            std::cerr << "load failed\n";
+            return 1;
+        }
+        auto loaded = std::chrono::steady_clock::now();
+        int replaced = merger.mergeIntoXml(doc);
+        auto merged = std::chrono::steady_clock::now();
+
+        if (replaced != static_cast<int>(rows * 2 + 1))
+        {
+            std::cerr << "expected " << rows * 2 + 1 << " replacements, got " << replaced << "\n";
+            return 1;
+        }
+
+        double loadMs = std::chrono::duration<double, std::milli>(loaded - start).count();
+        double mergeMs = std::chrono::duration<double, std::milli>(merged - loaded).count();
+        std::cout << std::left << std::setw(10) << rows << std::fixed << std::setprecision(2) << std::setw(14) << loadMs
+                  << std::setw(14) << mergeMs << std::setprecision(0) << mergeMs * 1e6 / rows << "\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "json2doc/json_merge.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+
+/**
+ * @brief Benchmark: loading a shared dataset, JSON parse vs binary snapshot
+ *
+ * Writes a product catalog of 10k to 500k products as JSON, saves it once as
+ * a snapshot, then times loadJson() against loadSnapshot() and the lookups
+ * a job does afterwards. The snapshot load only maps the file and rebuilds
+ * the typed tree, so it should stay far below the parse time.
+ */
+
+std::string buildJson(size_t products)
+{
+    std::string json = "{\"catalog\": {\"name\": \"Spring\", \"currency\": \"EUR\"}, \"products\": {";
+    for (size_t i = 0; i < products; i++)
+    {
+        std::string n = std::to_string(i);
+        json += (i ? ", " : "") + std::string("\"p") + n + "\": {\"name\": \"Product " + n + "\", \"price\": " + n +
+                ".99, \"stock\": " + std::to_string(i % 97) + ", \"active\": true, \"tags\": [\"a\", \"b\"]}";
+    }
+    json += "}}";
+    return json;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    const std::string base = "/tmp/bench_snapshot_" + std::to_string(getpid());
+    const std::string jsonPath = base + ".json";
+    const std::string snapshotPath = base + ".snap";
+    const size_t lookups = 100000;
+
+    std::cout << "\nShared dataset load (loadJson vs loadSnapshot)\n\n";
+    std::cout << std::left << std::setw(10) << "products" << std::setw(12) << "JSON (MB)" << std::setw(12) << "snap (MB)"
+              << std::setw(14) << "parse (ms)" << std::setw(16) << "snapshot (ms)" << "lookup ns (json/snap)\n";
+
+    for (size_t products : {10000, 100000, 500000})
+    {
+        std::string json = buildJson(products);
+        {
+            std::ofstream file(jsonPath, std::ios::binary | std::ios::trunc);
+            file << json;
+        }
+
+        json2doc::JsonMerge parsed;
+        auto start = std::chrono::steady_clock::now();
+        if (!parsed.loadJson(jsonPath))
+        {
+            std::cerr << "load failed: " << parsed.getLastError() << "\n";
+            return 1;
+        }
+        double parseMs = elapsedMs(start);
+        if (!parsed.saveSnapshot(snapshotPath))
+        {
+            std::cerr << "save failed: " << parsed.getLastError() << "\n";
+            return 1;
+        }
+
+        json2doc::JsonMerge snapshot;
+        start = std::chrono::steady_clock::now();
+        if (!snapshot.loadSnapshot(snapshotPath))
+        {
+            std::cerr << "snapshot load failed: " << snapshot.getLastError() << "\n";
+            return 1;
+        }
+        double snapshotMs = elapsedMs(start);
+
+        // Same keys against both, checking they agree
+        double lookupNs[2];
+        json2doc::JsonMerge *mergers[2] = {&parsed, &snapshot};
+        size_t checksum[2] = {0, 0};
+        for (int m = 0; m < 2; m++)
+        {
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < lookups; i++)
+            {
+                size_t p = (i * 7919) % products;
+                checksum[m] += mergers[m]->getValue("products.p" + std::to_string(p) + ".price").size();
+            }
+            lookupNs[m] = elapsedMs(start) * 1e6 / lookups;
+        }
+        if (checksum[0] != checksum[1] || snapshot.getValue("catalog.currency") != "EUR")
+        {
+            std::cerr << "snapshot lookups disagree with the parsed data\n";
+            return 1;
+        }
+
+        std::ifstream snapshotFile(snapshotPath, std::ios::binary | std::ios::ate);
+        double jsonMb = json.size() / 1048576.0;
+        double snapMb = static_cast<double>(snapshotFile.tellg()) / 1048576.0;
+        std::cout << std::left << std::setw(10) << products << std::fixed << std::setprecision(1) << std::setw(12) << jsonMb
+                  << std::setw(12) << snapMb << std::setprecision(2) << std::setw(14) << parseMs << std::setw(16)
+                  << snapshotMs << std::setprecision(0) << lookupNs[0] << " / " << lookupNs[1] << "\n";
+    }
+
+    std::remove(jsonPath.c_str());
+    std::remove(snapshotPath.c_str());
+    std::cout << "\n";
+    return 0;
+}
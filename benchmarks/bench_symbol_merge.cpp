@@ -0,0 +1,95 @@
+#include "json2doc/json_merge.h"
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Benchmark: mergeIntoXml on documents with 10k+ placeholders
+ *
+ * Each document repeats 200 distinct variable names. The placeholder index
+ * is built once per document (index), every distinct name is looked up once
+ * (bind), and substitution reads the value table by symbol id (replace).
+ */
+
+const size_t kDistinct = 200;
+
+std::string buildTemplate(size_t placeholders)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (size_t i = 0; i < placeholders; i += 4)
+    {
+        xml += "<w:p><w:r><w:t>";
+        for (size_t j = i; j < i + 4; j++)
+        {
+            xml += "{{section.field" + std::to_string(j * 7 % kDistinct) + "}} ";
+        }
+        xml += "</w:t></w:r></w:p>";
+    }
+    xml += "</w:body></w:document>";
+    return xml;
+}
+
+std::string buildJson()
+{
+    std::string json = "{\"section\": {";
+    for (size_t i = 0; i < kDistinct; i++)
+    {
+        json += (i ? ", " : "") + std::string("\"field") + std::to_string(i) + "\": \"value " + std::to_string(i) + "\"";
+    }
+    json += "}}";
+    return json;
+}
+
+int main()
+{
+    json2doc::JsonMerge merger;
+    if (!merger.loadJsonString(buildJson()))
+    {
+        std::cerr << "JSON load failed\n";
+        return 1;
+    }
+
+    std::cout << "\nPlaceholder substitution through interned symbols (" << kDistinct << " distinct names)\n\n";
+    std::cout << std::left << std::setw(14) << "placeholders" << std::setw(12) << "index (ms)" << std::setw(12) << "bind (ms)"
+              << std::setw(14) << "replace (ms)" << std::setw(10) << "lookups" << "ns/placeholder\n";
+
+    for (size_t placeholders : {10000, 50000, 100000, 500000})
+    {
+        std::string xml = buildTemplate(placeholders);
+        json2doc::XmlDocument doc;
+        if (!doc.loadFromString(xml))
+        {
+            std::cerr << "XML load failed\n";
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const json2doc::SymbolTable &symbols = doc.getSymbols();
+        auto indexed = std::chrono::steady_clock::now();
+        json2doc::SymbolValues values;
+        size_t lookups = symbols.size();
+        merger.bindSymbols(symbols, values);
+        auto bound = std::chrono::steady_clock::now();
+        int replaced = doc.replaceVariables(values);
+        auto done = std::chrono::steady_clock::now();
+
+        if (replaced != static_cast<int>(placeholders))
+        {
+            std::cerr << "expected " << placeholders << " replacements, got " << replaced << "\n";
+            return 1;
+        }
+
+        double indexMs = std::chrono::duration<double, std::milli>(indexed - start).count();
+        double bindMs = std::chrono::duration<double, std::milli>(bound - indexed).count();
+        double replaceMs = std::chrono::duration<double, std::milli>(done - bound).count();
+        std::cout << std::left << std::setw(14) << placeholders << std::fixed << std::setprecision(2) << std::setw(12)
+                  << indexMs << std::setw(12) << bindMs << std::setw(14) << replaceMs << std::setw(10) << lookups
+                  << std::setprecision(0) << (indexMs + bindMs + replaceMs) * 1e6 / placeholders << "\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
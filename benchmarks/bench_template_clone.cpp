@@ -0,0 +1,78 @@
+#include "json2doc/prepared_template.h"
+#include "json2doc/docx_reader.h"
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Benchmark: per-render template setup, reparse vs PreparedTemplate copy
+ *
+ * Reads word/document.xml of a DOCX (google_docs_example.docx by default)
+ * and times what each render does before substituting values: parsing the
+ * XML text again with loadFromString() versus copying the prepared
+ * prototype with PreparedTemplate::instantiate(). Both are followed by
+ * getSymbols(), so the placeholder index is included in each.
+ */
+
+int main(int argc, char **argv)
+{
+    const std::string docxPath = argc > 1 ? argv[1] : "google_docs_example.docx";
+    const size_t iterations = 2000;
+
+    json2doc::DocxReader reader;
+    if (!reader.open(docxPath) || !reader.decompress())
+    {
+        std::cerr << "cannot read " << docxPath << ": " << reader.getLastError() << "\n";
+        return 1;
+    }
+    std::string xml = reader.readDocumentXml();
+    reader.cleanup();
+
+    json2doc::PreparedTemplate prepared;
+    if (!prepared.load(xml))
+    {
+        std::cerr << "template failed: " << prepared.getLastError() << "\n";
+        return 1;
+    }
+
+    std::cout << "\nPer-render template setup for " << docxPath << " (" << xml.size() / 1024 << " KiB document.xml, "
+              << prepared.getVariables().size() << " variables, " << iterations << " renders)\n\n";
+    std::cout << std::left << std::setw(24) << "mode" << std::setw(12) << "ms" << "us/render\n";
+
+    json2doc::XmlDocument doc;
+    size_t checksum[2] = {0, 0};
+    double ms[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            bool ok = mode == 0 ? doc.loadFromString(xml) : prepared.instantiate(doc);
+            if (!ok)
+            {
+                std::cerr << "setup failed: " << doc.getLastError() << "\n";
+                return 1;
+            }
+            checksum[mode] += doc.getSymbols().size();
+        }
+        ms[mode] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        const char *names[] = {"loadFromString", "PreparedTemplate copy"};
+        std::cout << std::left << std::setw(24) << names[mode] << std::fixed << std::setprecision(2) << std::setw(12)
+                  << ms[mode] << ms[mode] * 1000 / iterations << "\n";
+    }
+
+    // Both modes must end with the same document
+    json2doc::XmlDocument parsed;
+    parsed.loadFromString(xml);
+    if (checksum[0] != checksum[1] || doc.toString() != parsed.toString())
+    {
+        std::cerr << "copies differ from the parsed template\n";
+        return 1;
+    }
+
+    std::cout << "\nspeedup: " << std::setprecision(1) << ms[0] / ms[1] << "x\n\n";
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "json2doc/json_merge.h"
+#include "json2doc/compiled_template.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Benchmark: per-record template rendering, text path vs CompiledTemplate
+ *
+ * Loads one JSON record at a time (as a mail-merge loop does) and renders the
+ * same template against it, either through replaceVariables(std::string),
+ * which rescans the text for placeholders on every call, or through a
+ * CompiledTemplate built once before the loop. Only rendering is timed.
+ */
+
+std::string buildTemplate(int paragraphs)
+{
+    std::string text;
+    for (int p = 0; p < paragraphs; p++)
+    {
+        text += "<w:p><w:r><w:t>Dear {{customer.name}}, your order {{order.id}} of {{order.date}} "
+                "totals {{order.total}}. Status: {{ order.status }}. Missing: {{order.coupon}}."
+                "</w:t></w:r></w:p>";
+    }
+    return text;
+}
+
+std::string buildRecord(int i)
+{
+    std::string n = std::to_string(i);
+    return "{\"customer\": {\"name\": \"Customer " + n + "\"}, \"order\": {\"id\": \"A-" + n +
+           "\", \"date\": \"2024-01-" + std::to_string(1 + i % 28) + "\", \"total\": " + n +
+           ".50, \"status\": \"shipped\"}}";
+}
+
+template <typename Fn>
+double usPerRecord(json2doc::JsonMerge &merger, const std::vector<std::string> &records, Fn render)
+{
+    double total = 0;
+    size_t checksum = 0;
+    for (const auto &record : records)
+    {
+        merger.loadJsonString(record);
+        auto start = std::chrono::steady_clock::now();
+        checksum += render().size();
+        auto end = std::chrono::steady_clock::now();
+        total += std::chrono::duration<double, std::micro>(end - start).count();
+    }
+    if (checksum == 0)
+    {
+        std::cerr << "empty output\n";
+    }
+    return total / records.size();
+}
+
+int main()
+{
+    const int recordCount = 2000;
+    std::vector<std::string> records;
+    for (int i = 0; i < recordCount; i++)
+    {
+        records.push_back(buildRecord(i));
+    }
+
+    std::cout << "\nTemplate rendering benchmark (" << recordCount << " records, us per record)\n\n";
+    std::cout << std::left << std::setw(14) << "placeholders" << std::setw(12) << "bytes"
+              << std::setw(12) << "text" << std::setw(12) << "compiled" << "speedup\n";
+
+    const int sizes[] = {1, 10, 100};
+    for (int paragraphs : sizes)
+    {
+        std::string text = buildTemplate(paragraphs);
+        json2doc::JsonMerge merger;
+
+        double textUs = usPerRecord(merger, records, [&]()
+                                    { return merger.replaceVariables(text); });
+
+        json2doc::CompiledTemplate tmpl(text);
+        double compiledUs = usPerRecord(merger, records, [&]()
+                                        { return merger.replaceVariables(tmpl); });
+
+        std::cout << std::left << std::setw(14) << tmpl.getVariableCount() << std::setw(12) << text.size()
+                  << std::fixed << std::setprecision(2) << std::setw(12) << textUs << std::setw(12) << compiledUs
+                  << std::setprecision(1) << textUs / compiledUs << "x\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Benchmark: reading document text, XPath tree walk vs the text table
+ *
+ * Builds WordprocessingML bodies of 2k to 50k paragraphs, each with
+ * paragraph and run properties around three runs, and collects all text
+ * with findTextNodes("//w:t") (an XPath evaluation visiting every node)
+ * and with findTextNodes(), which reads the text table built at load.
+ * getTextContent() reads the same table. Both lists are compared.
+ */
+
+std::string buildDocument(size_t paragraphs)
+{
+    std::string xml = "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (size_t i = 0; i < paragraphs; i++)
+    {
+        xml += "<w:p><w:pPr><w:pStyle w:val=\"Normal\"/><w:spacing w:after=\"120\"/><w:jc w:val=\"left\"/></w:pPr>";
+        for (int run = 0; run < 3; run++)
+        {
+            xml += "<w:r><w:rPr><w:rFonts w:ascii=\"Arial\"/><w:b/><w:sz w:val=\"22\"/></w:rPr><w:t>Run " +
+                   std::to_string(run) + " of paragraph " + std::to_string(i) + "</w:t></w:r>";
+        }
+        xml += "</w:p>";
+    }
+    xml += "</w:body></w:document>";
+    return xml;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::cout << "\nCollecting all text (XPath //w:t vs text table)\n\n";
+    std::cout << std::left << std::setw(12) << "paragraphs" << std::setw(14) << "XPath (ms)" << std::setw(14)
+              << "table (ms)" << std::setw(20) << "getTextContent (ms)" << "speedup\n";
+
+    for (size_t paragraphs : {2000, 10000, 50000})
+    {
+        json2doc::XmlDocument doc;
+        if (!doc.loadFromString(buildDocument(paragraphs)))
+        {
+            std::cerr << "load failed: " << doc.getLastError() << "\n";
+            return 1;
+        }
+
+        const int rounds = 10;
+        double ms[3] = {0, 0, 0};
+        std::vector<std::string> walked;
+        std::vector<std::string> table;
+        size_t length = 0;
+        for (int round = 0; round < rounds; round++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            walked = doc.findTextNodes("//w:t");
+            ms[0] += elapsedMs(start) / rounds;
+
+            start = std::chrono::steady_clock::now();
+            table = doc.findTextNodes();
+            ms[1] += elapsedMs(start) / rounds;
+
+            start = std::chrono::steady_clock::now();
+            length += doc.getTextContent().size();
+            ms[2] += elapsedMs(start) / rounds;
+        }
+
+        if (walked != table || walked.size() != 3 * paragraphs || length == 0)
+        {
+            std::cerr << "text lists differ\n";
+            return 1;
+        }
+
+        std::cout << std::left << std::setw(12) << paragraphs << std::fixed << std::setprecision(2) << std::setw(14)
+                  << ms[0] << std::setw(14) << ms[1] << std::setw(20) << ms[2] << std::setprecision(1)
+                  << ms[0] / ms[1] << "x\n";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
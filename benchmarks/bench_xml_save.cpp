@@ -0,0 +1,111 @@
+#include "json2doc/xml_document.h"
+#include "json2doc/output_sink.h"
+#include "json2doc/zip_writer.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Benchmark: writing a large document.xml to disk
+ *
+ * Compares toString() followed by an ofstream write (indented, the document
+ * held as a string) with save() streaming raw XML to a file and into a
+ * deflated ZIP entry. The streamed modes run first, so the peak RSS growth
+ * printed after each mode is attributable to it.
+ */
+
+std::string buildDocument(size_t paragraphs)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (size_t i = 0; i < paragraphs; i++)
+    {
+        xml += "<w:p><w:pPr><w:jc w:val=\"left\"/></w:pPr><w:r><w:rPr><w:b/></w:rPr><w:t>Paragraph " +
+               std::to_string(i) + " of the generated report</w:t></w:r></w:p>";
+    }
+    xml += "</w:body></w:document>";
+    return xml;
+}
+
+long peakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+size_t fileSize(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+int main()
+{
+    const size_t paragraphs = 300000;
+    const std::string path = "/tmp/bench_xml_save_" + std::to_string(getpid());
+
+    json2doc::XmlDocument doc;
+    {
+        std::string xml = buildDocument(paragraphs);
+        if (!doc.loadFromString(xml))
+        {
+            std::cerr << "load failed: " << doc.getLastError() << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << "\nSaving a document with " << paragraphs << " paragraphs\n\n";
+    std::cout << std::left << std::setw(26) << "mode" << std::setw(12) << "ms" << std::setw(14) << "output (MB)"
+              << "peak RSS growth (MB)\n";
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        long rssBefore = peakRssKb();
+        auto start = std::chrono::steady_clock::now();
+        bool ok = true;
+        if (mode == 0)
+        {
+            ok = doc.saveToFile(path);
+        }
+        else if (mode == 1)
+        {
+            FILE *file = std::fopen(path.c_str(), "wb");
+            {
+                json2doc::FileSink sink(file);
+                json2doc::ZipWriter zip(sink);
+                json2doc::OutputSink *entry = zip.beginEntry("word/document.xml");
+                ok = entry != nullptr && doc.save(*entry) && zip.finish();
+            }
+            ok = std::fclose(file) == 0 && ok;
+        }
+        else
+        {
+            std::string xml = doc.toString();
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << xml;
+            ok = file.good();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (!ok)
+        {
+            std::cerr << "save failed: " << doc.getLastError() << "\n";
+            return 1;
+        }
+
+        const char *names[] = {"saveToFile (raw)", "ZIP entry (raw, deflate)", "toString + ofstream"};
+        std::cout << std::left << std::setw(26) << names[mode] << std::fixed << std::setprecision(2) << std::setw(12) << ms
+                  << std::setprecision(1) << std::setw(14) << fileSize(path) / 1048576.0
+                  << (peakRssKb() - rssBefore) / 1024.0 << "\n";
+    }
+
+    std::remove(path.c_str());
+    std::cout << "\n";
+    return 0;
+}
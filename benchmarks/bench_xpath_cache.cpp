@@ -0,0 +1,89 @@
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Benchmark: repeated XPath calls, recompiled vs cached vs prepared
+ *
+ * Issues the same handful of absolute XPath expressions many times against a
+ * small document, the way post-processing scripts do, with the compiled
+ * query cache turned off (every call recompiles), with the default cache,
+ * and through prepare() handles.
+ */
+
+std::string buildDocument()
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (int i = 0; i < 20; i++)
+    {
+        xml += "<w:p><w:pPr><w:jc w:val=\"left\"/></w:pPr><w:r><w:t>Paragraph " + std::to_string(i) + "</w:t></w:r></w:p>";
+    }
+    xml += "<w:sectPr><w:pgSz w:w=\"11906\" w:h=\"16838\"/></w:sectPr></w:body></w:document>";
+    return xml;
+}
+
+const std::vector<std::string> kExpressions = {
+    "/w:document/w:body/w:sectPr/w:pgSz",
+    "/w:document/w:body/w:p/w:pPr/w:jc",
+    "/w:document/w:body/w:p/w:r/w:t",
+    "/w:document/w:body/w:sectPr",
+};
+
+int main()
+{
+    const size_t calls = 200000;
+    json2doc::XmlDocument doc;
+    if (!doc.loadFromString(buildDocument()))
+    {
+        std::cerr << "load failed: " << doc.getLastError() << "\n";
+        return 1;
+    }
+
+    std::vector<json2doc::XmlDocument::XPathQuery> prepared;
+    for (const auto &expression : kExpressions)
+    {
+        prepared.push_back(doc.prepare(expression));
+    }
+
+    std::cout << "\nRepeated XPath calls (" << calls << " getAttributeValue() over " << kExpressions.size()
+              << " expressions)\n\n";
+    std::cout << std::left << std::setw(14) << "mode" << std::setw(12) << "ms" << "ns/call\n";
+
+    size_t reference = 0;
+    for (int mode = 0; mode < 3; mode++)
+    {
+        doc.setXPathCacheCapacity(mode == 0 ? 0 : 64);
+        size_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++)
+        {
+            size_t e = i % kExpressions.size();
+            std::string value = mode == 2 ? doc.getAttributeValue(prepared[e], "w:val")
+                                          : doc.getAttributeValue(kExpressions[e], "w:val");
+            checksum += value.size();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (mode == 0)
+        {
+            reference = checksum;
+        }
+        else if (checksum != reference)
+        {
+            std::cerr << "results differ between modes\n";
+            return 1;
+        }
+
+        const char *names[] = {"recompile", "cached", "prepared"};
+        std::cout << std::left << std::setw(14) << names[mode] << std::fixed << std::setprecision(2) << std::setw(12) << ms
+                  << std::setprecision(0) << ms * 1e6 / calls << "\n";
+    }
+
+    json2doc::XmlDocument::XPathCacheStats stats = doc.getXPathCacheStats();
+    std::cout << "\ncache: " << stats.hits << " hits, " << stats.misses << " misses\n\n";
+    return 0;
+}
@@ -0,0 +1,100 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Bump allocator for data that is released all at once
+     *
+     * Memory is handed out from large blocks by advancing an offset. reset()
+     * rewinds to the first block in O(1) and keeps every block for reuse, so a
+     * loop that refills the arena (e.g. one JSON record per iteration) stops
+     * calling the system allocator once the blocks are large enough.
+     * Blocks never move, so pointers stay valid when the arena is moved.
+     */
+    class Arena
+    {
+    public:
+        /**
+         * @brief Allocation counters since the last reset()
+         */
+        struct Stats
+        {
+            size_t bytesUsed = 0;        // Bytes handed out
+            size_t allocations = 0;      // Number of allocate()/copy() calls
+            size_t bytesReserved = 0;    // Total size of all blocks held
+            size_t blocks = 0;           // Number of blocks held
+            size_t blockAllocations = 0; // Blocks obtained from the system allocator
+        };
+
+        /**
+         * @brief Construct an empty Arena object
+         *
+         * @param blockSize Size of the first block (later blocks grow geometrically)
+         */
+        explicit Arena(size_t blockSize = 4096);
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+        Arena(Arena &&other) noexcept;
+        Arena &operator=(Arena &&other) noexcept;
+
+        /**
+         * @brief Allocate uninitialized memory
+         *
+         * @param size Number of bytes
+         * @param alignment Required alignment (power of two)
+         * @return char* Pointer valid until reset() or destruction
+         */
+        char *allocate(size_t size, size_t alignment = 1);
+
+        /**
+         * @brief Copy bytes into the arena
+         *
+         * @param text The bytes to copy
+         * @return std::string_view View of the copy
+         */
+        std::string_view copy(std::string_view text);
+
+        /**
+         * @brief Release all allocations in O(1), keeping the blocks for reuse
+         */
+        void reset();
+
+        /**
+         * @brief Release all allocations and free every block
+         */
+        void release();
+
+        /**
+         * @brief Get the allocation counters since the last reset()
+         *
+         * @return Stats The counters
+         */
+        Stats getStats() const;
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<char[]> data;
+            size_t size;
+        };
+
+        std::vector<Block> blocks_;
+        size_t current_; // Block being filled
+        size_t offset_;  // Bytes used in the current block
+        size_t blockSize_;
+        Stats stats_;
+
+        void nextBlock(size_t minSize);
+    };
+
+} // namespace json2doc
+
+#endif // ARENA_H
@@ -0,0 +1,182 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include "json2doc/prepared_template.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief Renders one XML template against many JSON records in parallel
+     *
+     * The template is loaded and prepared once (split placeholders joined,
+     * see PreparedTemplate), and each record parses the prepared XML.
+     * render() pulls records from a source,
+     * merges each one on a pool of worker threads and hands the rendered XML
+     * to a sink strictly in input order. Every worker keeps its
+     * own XmlDocument and JsonMerge for the whole batch, so per-record buffers
+     * (e.g. the JsonMerge arena) are reused instead of reallocated, and only
+     * the JSON fields referenced by the template are materialized.
+     *
+     * Usage:
+     * @code
+     * BatchRenderer renderer(8);
+     * renderer.loadTemplate("template.docx");
+     * renderer.render(records.begin(), records.end(), [](BatchRenderer::Result &&r) { save(r); });
+     * @endcode
+     */
+    class BatchRenderer
+    {
+    public:
+        /**
+         * @brief Outcome of rendering one record
+         */
+        struct Result
+        {
+            size_t index = 0;   // Position of the record in the input
+            bool ok = false;    // false if the record was not valid JSON
+            std::string output; // Rendered XML (empty on failure)
+            std::string error;  // Error message on failure
+            int replaced = 0;   // Number of placeholders replaced
+        };
+
+        /**
+         * @brief Produces the next JSON record; returns false when exhausted
+         *
+         * Called from worker threads, one call at a time.
+         */
+        using RecordSource = std::function<bool(std::string &record)>;
+
+        /**
+         * @brief Receives results in input order, one call at a time
+         */
+        using ResultSink = std::function<void(Result &&result)>;
+
+        /**
+         * @brief Construct a new BatchRenderer object
+         *
+         * @param threadCount Number of worker threads (0 = one per hardware thread)
+         */
+        explicit BatchRenderer(size_t threadCount = 0);
+
+        /**
+         * @brief Load the template from the main document XML of a DOCX file
+         *
+         * @param docxPath Path to the .docx template
+         * @return true if the template was loaded and is well-formed XML
+         * @return false otherwise (see getLastError())
+         */
+        bool loadTemplate(const std::string &docxPath);
+
+        /**
+         * @brief Load the template from XML text
+         *
+         * @param xmlContent The template XML
+         * @return true if the template is well-formed XML
+         * @return false otherwise (see getLastError())
+         */
+        bool loadTemplateString(const std::string &xmlContent);
+
+        /**
+         * @brief Get the variable names referenced by the template
+         *
+         * @return const std::vector<std::string>& Distinct names in document order
+         */
+        const std::vector<std::string> &getTemplateVariables() const;
+
+        /**
+         * @brief Render every record produced by a source
+         *
+         * Blocks until the source is exhausted and every result was delivered.
+         * At most a few records per thread are in flight at any time, so memory
+         * stays bounded however long the input is.
+         *
+         * If the source or the sink throws, no further record is taken or
+         * delivered; once every worker thread has stopped, the first exception
+         * is rethrown on the calling thread.
+         *
+         * @param source Supplies the JSON records
+         * @param sink Receives the results in input order
+         * @return size_t Number of records rendered successfully
+         */
+        size_t render(const RecordSource &source, const ResultSink &sink);
+
+        /**
+         * @brief Render a range of JSON records
+         *
+         * @param first Iterator to the first record (dereferences to std::string)
+         * @param last Iterator past the last record
+         * @param sink Receives the results in input order
+         * @return size_t Number of records rendered successfully
+         */
+        template <typename InputIt>
+        size_t render(InputIt first, InputIt last, const ResultSink &sink)
+        {
+            return render([&first, &last](std::string &record)
+                          {
+                              if (first == last)
+                              {
+                                  return false;
+                              }
+                              record = *first;
+                              ++first;
+                              return true; },
+                          sink);
+        }
+
+        /**
+         * @brief Render a list of JSON records and collect the results
+         *
+         * @param records The JSON records
+         * @return std::vector<Result> Results in input order
+         */
+        std::vector<Result> renderAll(const std::vector<std::string> &records);
+
+        /**
+         * @brief Get the number of worker threads
+         *
+         * @return size_t Thread count
+         */
+        size_t getThreadCount() const;
+
+        /**
+         * @brief Cap the pugixml memory of each rendered document
+         *
+         * A record whose document would take more fails with a "Memory
+         * limit exceeded" error; the other records are unaffected (see
+         * XmlDocument::setMemoryLimit()).
+         *
+         * @param bytes The limit per document (0 = no limit, the default)
+         */
+        void setMemoryLimit(size_t bytes);
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const;
+
+    private:
+        size_t threadCount_;
+        size_t memoryLimit_;
+        PreparedTemplate template_;
+        std::string templateXml_; // The prepared template, as save() writes it
+        bool loaded_;
+        std::string lastError_;
+
+        /**
+         * @brief Keep the prepared template as XML text for the workers to parse
+         *
+         * @return true if it was serialized
+         */
+        bool storeTemplate();
+    };
+
+} // namespace json2doc
+
+#endif // BATCH_RENDERER_H
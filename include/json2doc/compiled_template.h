@@ -0,0 +1,96 @@
+#ifndef COMPILED_TEMPLATE_H
+#define COMPILED_TEMPLATE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Template text split once into literals and {{variable}} slots
+     *
+     * Compiling scans the text a single time. Each slot keeps its trimmed key
+     * and the key's KeyIndex hash, so rendering against any number of loaded
+     * JSON records only does hashed lookups and one concatenation per record
+     * (see JsonMerge::replaceVariables(const CompiledTemplate &)).
+     */
+    class CompiledTemplate
+    {
+    public:
+        /**
+         * @brief A literal run followed by an optional placeholder
+         *
+         * Offsets refer to getText(). The placeholder starts right after the
+         * literal; the last segment of a template has no placeholder.
+         */
+        struct Segment
+        {
+            size_t literalOffset;     // Start of the literal text
+            size_t literalLength;     // Length of the literal text
+            size_t placeholderLength; // Length of "{{ name }}", 0 if there is none
+            size_t keyOffset;         // Start of the trimmed variable name
+            size_t keyLength;         // Length of the trimmed variable name
+            uint64_t keyHash;         // KeyIndex::hash(key)
+        };
+
+        /**
+         * @brief Construct an empty CompiledTemplate object
+         */
+        CompiledTemplate();
+
+        /**
+         * @brief Construct and compile a template
+         *
+         * @param text The template text containing {{variable}} placeholders
+         */
+        explicit CompiledTemplate(const std::string &text);
+
+        /**
+         * @brief Compile a template, replacing any previous one
+         *
+         * @param text The template text containing {{variable}} placeholders
+         */
+        void compile(const std::string &text);
+
+        /**
+         * @brief Get the template text the offsets refer to
+         *
+         * @return const std::string& The template text
+         */
+        const std::string &getText() const;
+
+        /**
+         * @brief Get the compiled segments in text order
+         *
+         * @return const std::vector<Segment>& The segments
+         */
+        const std::vector<Segment> &getSegments() const;
+
+        /**
+         * @brief Get the variable name of a segment
+         *
+         * @param segment A segment of this template
+         * @return std::string_view The trimmed variable name
+         */
+        std::string_view key(const Segment &segment) const;
+
+        /**
+         * @brief Get the number of placeholders
+         *
+         * @return size_t Number of {{variable}} slots
+         */
+        size_t getVariableCount() const;
+
+    private:
+        std::string text_;
+        std::vector<Segment> segments_;
+        size_t variableCount_;
+    };
+
+} // namespace json2doc
+
+#endif // COMPILED_TEMPLATE_H
@@ -2,6 +2,7 @@
 #define JSON2DOC_CONVERTER_H
 
 #include <string>
+#include <string_view>
 
 namespace json2doc {
 
@@ -28,7 +29,7 @@ public:
      * @return true if JSON is valid
      * @return false if JSON is invalid
      */
-    static bool isValidJson(const std::string& json);
+    static bool isValidJson(std::string_view json);
 };
 
 } // namespace json2doc
@@ -0,0 +1,142 @@
+#ifndef EDIT_BATCH_H
+#define EDIT_BATCH_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "json2doc/symbol_table.h"
+#include "json2doc/xml_document.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief Text and attribute edits applied to a document together
+     *
+     * Collects the operations setNodeText() and setAttributeValue() would
+     * perform one at a time. XmlDocument::applyEdits() compiles each distinct
+     * expression once (kept in the batch, so applying it to many documents
+     * compiles nothing more), resolves the targets of every operation, and
+     * only then changes the document. Plain child paths, such as the
+     * positional paths findTemplateNodes() returns
+     * (/w:document/w:body/w:p[3]/w:r/w:t), are resolved all together by one
+     * walk of the document along a trie of their steps; other expressions
+     * are evaluated by pugixml, once each.
+     *
+     * Since every target is resolved first, an edit never changes which
+     * nodes a later operation of the same batch selects. Operations are
+     * applied in the order they were added, so for the same node the last
+     * one wins. A batch compiles its expressions on first use: give each
+     * thread its own.
+     *
+     * Usage:
+     * @code
+     * EditBatch batch;
+     * batch.setText("/w:document/w:body/w:p[3]/w:r/w:t", "Total");
+     * batch.setAttribute("//w:jc", "w:val", "center", EditBatch::Match::All);
+     * std::vector<size_t> hits = doc.applyEdits(batch);
+     * @endcode
+     */
+    class EditBatch
+    {
+    public:
+        /**
+         * @brief Which of the selected nodes an operation changes
+         */
+        enum class Match
+        {
+            First, // The first in document order, like setNodeText()
+            All    // Every selected node
+        };
+
+        /**
+         * @brief One queued edit
+         */
+        struct Operation
+        {
+            uint32_t expression; // Id in getExpressions()
+            Match match;
+            bool attribute;      // false: set the node text
+            std::string name;    // Attribute name (attribute edits only)
+            std::string value;   // New text or attribute value
+        };
+
+        /**
+         * @brief Construct an empty EditBatch object
+         */
+        EditBatch();
+
+        EditBatch(const EditBatch &) = delete;
+        EditBatch &operator=(const EditBatch &) = delete;
+        EditBatch(EditBatch &&other) noexcept = default;
+        EditBatch &operator=(EditBatch &&other) noexcept = default;
+
+        /**
+         * @brief Queue setting the text of the selected nodes
+         *
+         * @param xpath The XPath expression
+         * @param text New text content
+         * @param match First node or all of them
+         * @return size_t Index of the operation (its entry in applyEdits() results)
+         */
+        size_t setText(const std::string &xpath, const std::string &text, Match match = Match::First);
+
+        /**
+         * @brief Queue setting an attribute of the selected nodes (added if missing)
+         *
+         * @param xpath The XPath expression
+         * @param attributeName Name of the attribute
+         * @param value New attribute value
+         * @param match First node or all of them
+         * @return size_t Index of the operation (its entry in applyEdits() results)
+         */
+        size_t setAttribute(const std::string &xpath, const std::string &attributeName, const std::string &value,
+                            Match match = Match::First);
+
+        /**
+         * @brief Get the queued operations
+         *
+         * @return const std::vector<Operation>& Operations in the order added
+         */
+        const std::vector<Operation> &getOperations() const;
+
+        /**
+         * @brief Get the distinct expressions, ids in order of first use
+         *
+         * @return const SymbolTable& The expressions
+         */
+        const SymbolTable &getExpressions() const;
+
+        /**
+         * @brief Get the number of queued operations
+         *
+         * @return size_t Operation count
+         */
+        size_t size() const;
+
+        /**
+         * @brief Check if no operation is queued
+         *
+         * @return true if empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Remove all operations and expressions
+         */
+        void clear();
+
+    private:
+        friend class XmlDocument;
+        struct Plan; // Compiled expressions and path trie (see XmlDocument::applyEdits())
+
+        SymbolTable expressions_;
+        std::vector<Operation> operations_;
+        std::shared_ptr<Plan> plan_;
+    };
+
+} // namespace json2doc
+
+#endif // EDIT_BATCH_H
@@ -2,6 +2,8 @@
 #define JSON2DOC_H
 
 #include <string>
+#include <string_view>
+#include "json2doc/mapped_file.h"
 
 namespace json2doc {
 
@@ -23,6 +25,9 @@ public:
      */
     ~Json2Doc();
 
+    Json2Doc(const Json2Doc&) = delete;
+    Json2Doc& operator=(const Json2Doc&) = delete;
+
     /**
      * @brief Get the version of the library
      * 
@@ -39,6 +44,25 @@ public:
      */
     bool loadJson(const std::string& jsonData);
 
+    /**
+     * @brief Load JSON data from a file through a read-only memory mapping
+     * 
+     * The file is not copied into memory; the mapping is kept until the next
+     * load or the destruction of this object.
+     * 
+     * @param jsonFilePath Path to the JSON file
+     * @return true if the file was mapped and is not empty
+     * @return false if the file could not be mapped or is empty
+     */
+    bool loadJsonFile(const std::string& jsonFilePath);
+
+    /**
+     * @brief Get the loaded JSON text
+     * 
+     * @return std::string_view The JSON text (valid until the next load)
+     */
+    std::string_view getJsonData() const;
+
     /**
      * @brief Convert loaded JSON to document format
      * 
@@ -48,7 +72,9 @@ public:
     std::string convertToDocument(const std::string& templatePath);
 
 private:
-    std::string jsonData_;
+    std::string jsonStorage_;
+    MappedFile jsonFile_;
+    std::string_view jsonData_;
 };
 
 } // namespace json2doc
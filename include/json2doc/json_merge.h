@@ -2,14 +2,24 @@
 #define JSON_MERGE_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include "json2doc/mapped_file.h"
+#include "json2doc/key_index.h"
+#include "json2doc/arena.h"
+#include "json2doc/json_parser.h"
+#include "json2doc/json_value.h"
+#include "json2doc/symbol_table.h"
+#include "json2doc/json_snapshot.h"
 
 // Forward declaration
 namespace json2doc
 {
     class XmlDocument;
+    class CompiledTemplate;
 }
 
 namespace json2doc
@@ -25,10 +35,35 @@ namespace json2doc
      * - Supporting nested JSON structures with dot notation (e.g., {{metadata.version}})
      * - Working with parsed XML documents via XmlDocument class
      * - XPath-based XML manipulation
+     *
+     * Once data is loaded, the const methods only read it: any number of
+     * threads can merge against one JsonMerge at the same time, as long as
+     * none of them loads, patches or clears it meanwhile. Use the overloads
+     * taking a MergeStats to get per-call counts; getStats() only reports
+     * whichever call finished last.
      */
     class JsonMerge
     {
     public:
+        /**
+         * @brief Placeholder counts of one merge
+         */
+        struct MergeStats
+        {
+            int found = 0;    // Placeholders seen
+            int replaced = 0; // Placeholders replaced with a value
+            int missing = 0;  // Placeholders left as they were
+        };
+
+        /**
+         * @brief How loadJson() brings the file into memory
+         */
+        enum class LoadMode
+        {
+            Mapped,  // mmap the file and parse straight from the mapped pages
+            Buffered // read the file into the arena owned by this object
+        };
+
         /**
          * @brief Construct a new JsonMerge object
          */
@@ -39,24 +74,90 @@ namespace json2doc
          */
         ~JsonMerge();
 
+        /**
+         * @brief Copy loaded data (a mapped source is copied into the arena)
+         */
+        JsonMerge(const JsonMerge &other);
+        JsonMerge &operator=(const JsonMerge &other);
+        JsonMerge(JsonMerge &&other) noexcept;
+        JsonMerge &operator=(JsonMerge &&other) noexcept;
+
         /**
          * @brief Load JSON data from a file
          *
+         * In Mapped mode (the default) values are slices of the file mapping,
+         * which stays alive until the next load, clear() or destruction.
+         * Files that cannot be mapped fall back to Buffered mode.
+         *
          * @param jsonFilePath Path to the JSON file
+         * @param mode How the file is brought into memory
          * @return true if JSON was successfully loaded and parsed
          * @return false if loading or parsing failed
          */
-        bool loadJson(const std::string &jsonFilePath);
+        bool loadJson(const std::string &jsonFilePath, LoadMode mode = LoadMode::Mapped);
 
         /**
          * @brief Load JSON data from a string
          *
+         * The text is copied once into the arena; keys and values then live
+         * in that single allocation region until the next load or clear().
+         *
          * @param jsonString JSON content as string
          * @return true if JSON was successfully parsed
          * @return false if parsing failed
          */
         bool loadJsonString(const std::string &jsonString);
 
+        /**
+         * @brief Write the loaded data to a binary snapshot file
+         *
+         * The snapshot holds the key index, the typed tree and the text they
+         * point into (see JsonSnapshot). loadSnapshot() reopens it without
+         * parsing, so a dataset shared by many jobs is parsed only once.
+         * Only the keys kept by setRequiredVariables() are saved.
+         *
+         * @param snapshotPath Path of the snapshot (replaced atomically)
+         * @return true if the snapshot was written
+         * @return false if it could not be written (see getLastError())
+         */
+        bool saveSnapshot(const std::string &snapshotPath);
+
+        /**
+         * @brief Load data from a snapshot written by saveSnapshot()
+         *
+         * The file is mapped and lookups probe its hash table in place; only
+         * the typed tree is rebuilt from fixed-size records. The file must
+         * not be modified while loaded (replace it instead, as saveSnapshot()
+         * does). applyPatch() first copies the index into memory.
+         *
+         * @param snapshotPath Path to the snapshot
+         * @return true if the snapshot was loaded
+         * @return false if it is missing or invalid
+         */
+        bool loadSnapshot(const std::string &snapshotPath);
+
+        /**
+         * @brief Only materialize the given variables on later loads
+         *
+         * Typically fed with the template's variables (findVariables() or
+         * BatchRenderer::getTemplateVariables()). Loads then skip every JSON
+         * subtree that cannot contain one of them, so unused fields cost a
+         * bracket-matching scan instead of a full flatten. Keys that were not
+         * requested are absent from getValue(), getAllKeys() etc. The
+         * selection survives clear() and loads; an empty list turns it off.
+         * Section markers ("#items", "/items") select the whole array.
+         *
+         * @param variables Dot-notation variable names
+         */
+        void setRequiredVariables(const std::vector<std::string> &variables);
+
+        /**
+         * @brief Get the variables selected by setRequiredVariables()
+         *
+         * @return std::vector<std::string> The selection (empty = all keys)
+         */
+        std::vector<std::string> getRequiredVariables() const;
+
         /**
          * @brief Find all {{variable}} placeholders in text
          *
@@ -73,14 +174,99 @@ namespace json2doc
          */
         std::string replaceVariables(const std::string &text) const;
 
+        /**
+         * @brief Replace all {{variable}} placeholders, reporting counts to the caller
+         *
+         * Does not touch getStats(), so it is safe to call from many threads.
+         *
+         * @param text The text containing placeholders
+         * @param stats Receives the counts of this call
+         * @return std::string Text with placeholders replaced
+         */
+        std::string replaceVariables(const std::string &text, MergeStats &stats) const;
+
+        /**
+         * @brief Render a precompiled template with the loaded JSON values
+         *
+         * Equivalent to replaceVariables(tmpl.getText()), including the
+         * statistics reported by getStats(), without rescanning the text.
+         *
+         * @param tmpl The compiled template
+         * @return std::string Text with placeholders replaced
+         */
+        std::string replaceVariables(const CompiledTemplate &tmpl) const;
+
+        /**
+         * @brief Render a precompiled template, reporting counts to the caller
+         *
+         * @param tmpl The compiled template
+         * @param stats Receives the counts of this call
+         * @return std::string Text with placeholders replaced
+         */
+        std::string replaceVariables(const CompiledTemplate &tmpl, MergeStats &stats) const;
+
         /**
          * @brief Get a JSON value by key (supports dot notation for nested access)
          *
+         * Numeric segments index arrays, so "sections.1.heading" resolves the
+         * second element of "sections" directly. Elements that are arrays or
+         * objects yield their raw JSON text.
+         *
          * @param key The key to look up (e.g., "name" or "metadata.version")
          * @return std::string The value as string, or empty string if not found
          */
         std::string getValue(const std::string &key) const;
 
+        /**
+         * @brief Get a typed value by key
+         *
+         * Unlike getValue(), objects resolve too (e.g. "metadata"). The handle
+         * stays valid until the next load or clear().
+         *
+         * @param key Dot-notation key, numeric segments index arrays
+         * @return JsonValue The value, invalid if the key does not resolve
+         */
+        JsonValue getJsonValue(const std::string &key) const;
+
+        /**
+         * @brief Get the typed root object of the loaded document
+         *
+         * @return JsonValue The root, invalid if nothing is loaded
+         */
+        JsonValue getRoot() const;
+
+        /**
+         * @brief Resolve every name of a symbol table against the loaded data
+         *
+         * Each name is looked up once; ids whose name does not resolve stay
+         * unbound. The values are slices of the loaded JSON and stay valid
+         * until the next load or clear().
+         *
+         * @param symbols The names to resolve (e.g. XmlDocument::getSymbols())
+         * @param values Receives one entry per id
+         * @return size_t Number of names that resolved
+         */
+        size_t bindSymbols(const SymbolTable &symbols, SymbolValues &values) const;
+
+        /**
+         * @brief Overlay a partial JSON document on the loaded data
+         *
+         * Objects are merged member by member; any other value replaces the
+         * value at the same path, and new members are added. The patch text
+         * is kept with the loaded data until the next load or clear(). The
+         * raw text of enclosing objects (JsonValue::getText()) is not updated.
+         *
+         * Replacing an object or array with another kind of value removes
+         * the flattened keys below it, and replacing a scalar or array with an
+         * object removes its own key. Such keys are returned too.
+         *
+         * @param patchJson A JSON object
+         * @return std::vector<std::string> Flattened keys whose value changed or
+         *         that were removed; empty when nothing changed or the patch is malformed (see
+         *         getLastError(), the loaded data is then left untouched)
+         */
+        std::vector<std::string> applyPatch(const std::string &patchJson);
+
         /**
          * @brief Check if a key exists in the JSON data
          *
@@ -107,12 +293,26 @@ namespace json2doc
         /**
          * @brief Get statistics about the last merge operation
          *
+         * With concurrent merges this is the last one to finish; prefer the
+         * MergeStats overloads there.
+         *
          * @return std::map<std::string, int> Map with "found", "replaced", "missing" counts
          */
         std::map<std::string, int> getStats() const;
 
         /**
-         * @brief Clear all loaded JSON data
+         * @brief Get arena usage of the current load
+         *
+         * Counters restart at every load, so bytesUsed and allocations describe
+         * the last loaded document and blockAllocations shows how many times the
+         * load had to go to the system allocator.
+         *
+         * @return Arena::Stats Arena counters
+         */
+        Arena::Stats getLoadStats() const;
+
+        /**
+         * @brief Clear all loaded JSON data (the arena is reset in O(1))
          */
         void clear();
 
@@ -121,11 +321,55 @@ namespace json2doc
         /**
          * @brief Merge JSON data into an XmlDocument
          *
+         * {{#array}}...{{/array}} sections are expanded first (see
+         * XmlDocument::expandSections()), then every placeholder is replaced.
+         *
          * @param xmlDoc The XmlDocument to merge data into
          * @return int Number of variables replaced
          */
         int mergeIntoXml(XmlDocument &xmlDoc) const;
 
+        /**
+         * @brief Merge JSON data into an XmlDocument, reporting counts to the caller
+         *
+         * Does not touch getStats(), so many threads can merge their own
+         * documents against one JsonMerge.
+         *
+         * @param xmlDoc The XmlDocument to merge data into
+         * @param stats Receives the counts of this call
+         * @return int Number of variables replaced
+         */
+        int mergeIntoXml(XmlDocument &xmlDoc, MergeStats &stats) const;
+
+        /**
+         * @brief Merge JSON data into an XmlDocument and keep it bound to its template
+         *
+         * Same result as mergeIntoXml(), but the document remembers the
+         * template text of every node it rewrites (see
+         * XmlDocument::bindVariables()), so updateXml() can re-render only
+         * what a later applyPatch() changed.
+         *
+         * @param xmlDoc The XmlDocument to merge data into
+         * @return int Number of variables replaced
+         */
+        int bindToXml(XmlDocument &xmlDoc) const;
+
+        /**
+         * @brief Re-render the text nodes of a bound document that use changed keys
+         *
+         * A placeholder is affected when its name equals a changed key or
+         * one is a dot-path prefix of the other (a replaced array affects
+         * {{array.0.field}}). Sections are not expanded again, so a patch
+         * that changes an array's length needs a fresh bindToXml().
+         *
+         * @param xmlDoc A document prepared with bindToXml()
+         * @param changedKeys Keys returned by applyPatch()
+         * @param changedPaths Optional; receives the XPath of each rewritten element
+         * @return int Number of text nodes rewritten, -1 if the document is not bound
+         */
+        int updateXml(XmlDocument &xmlDoc, const std::vector<std::string> &changedKeys,
+                      std::vector<std::string> *changedPaths = nullptr) const;
+
         /**
          * @brief Find all template nodes in XML document
          *
@@ -151,62 +395,145 @@ namespace json2doc
         std::map<std::string, std::string> getVariableMap() const;
 
     private:
-        std::map<std::string, std::string> jsonData_;
+        // Raw JSON text: either the file mapping or a copy in arena_.
+        // Keys in jsonData_ live in arena_, values are slices of source_
+        MappedFile mappedSource_;
+        Arena arena_;
+        std::string_view source_;
+        std::vector<std::string_view> patches_; // Patch texts in arena_, values may point into them
+        JsonSnapshot snapshot_;                 // Loaded snapshot, tree text points into it
+        bool snapshotIndex_;                    // Keys are looked up in snapshot_ instead of jsonData_
+
+        KeyIndex jsonData_;
+        JsonTree tree_;                    // Typed document, text slices of source_
+        std::vector<uint32_t> entryNodes_; // Tree node of every jsonData_ entry
+        JsonParser parser_;
+        std::vector<std::string> requiredVariables_;
         std::string lastError_;
+        mutable std::mutex statsMutex_; // Guards lastStats_
         mutable std::map<std::string, int> lastStats_;
 
         /**
-         * @brief Parse JSON string into the internal map
+         * @brief Parse JSON text into the internal map
          *
-         * @param jsonString The JSON content
+         * @param data Pointer to the JSON content (must outlive the loaded data)
+         * @param size Size of the JSON content in bytes
          * @return true if parsing was successful
          * @return false if parsing failed
          */
-        bool parseJson(const std::string &jsonString);
+        bool parseJson(const char *data, size_t size);
 
         /**
-         * @brief Extract value from JSON string by key
+         * @brief Look up a value without allocating
          *
-         * @param jsonString The JSON content
-         * @param key The key to extract
-         * @param startPos Starting position to search from
-         * @return std::string The extracted value
+         * @param key The key (surrounding whitespace is ignored)
+         * @param value Receives the value slice, or an empty view if absent
+         * @return true if the key exists
+         * @return false if the key does not exist
          */
-        std::string extractJsonValue(const std::string &jsonString, const std::string &key, size_t startPos = 0) const;
+        bool lookup(std::string_view key, std::string_view &value) const;
 
         /**
-         * @brief Parse nested JSON objects and flatten to dot notation
+         * @brief Look up an already trimmed key whose hash is known
          *
-         * @param jsonString The JSON content
-         * @param prefix Current prefix for nested keys
+         * @param key The key
+         * @param keyHash KeyIndex::hash(key)
+         * @param value Receives the value slice, or an empty view if absent
+         * @return true if the key exists
+         * @return false if the key does not exist
          */
-        void parseNestedJson(const std::string &jsonString, const std::string &prefix = "");
+        bool lookup(std::string_view key, uint64_t keyHash, std::string_view &value) const;
 
         /**
-         * @brief Trim whitespace and quotes from a string
+         * @brief Resolve a key that goes through an array index
          *
-         * @param str The string to trim
-         * @return std::string Trimmed string
+         * @param key The trimmed key (e.g. "sections.1.heading")
+         * @return uint32_t The tree node, JsonTree::npos if it does not resolve
          */
-        std::string trim(const std::string &str) const;
+        uint32_t findElement(std::string_view key) const;
 
         /**
-         * @brief Extract JSON object content between { }
+         * @brief Find a flattened key in jsonData_ or the snapshot
          *
-         * @param jsonString The JSON content
-         * @param startPos Starting position
-         * @return std::string The extracted object content
+         * @param key The trimmed key
+         * @param keyHash KeyIndex::hash(key)
+         * @param value Receives the value slice
+         * @param node Receives the tree node (JsonTree::npos for none)
+         * @return true if the key exists
+         * @return false if it does not
+         */
+        bool findEntry(std::string_view key, uint64_t keyHash, std::string_view &value, uint32_t &node) const;
+
+        /**
+         * @brief Copy the snapshot's key index into jsonData_ so it can be modified
          */
-        std::string extractObject(const std::string &jsonString, size_t startPos) const;
+        void materializeSnapshot();
 
         /**
-         * @brief Extract JSON array content between [ ]
+         * @brief Publish the counts of a finished call to getStats()
+         *
+         * @param stats The counts
+         */
+        void recordStats(const MergeStats &stats) const;
+
+        /**
+         * @brief Merge the tree of a patch into tree_
+         *
+         * @param patch The parsed patch (its slices must outlive tree_)
+         */
+        void mergeTree(const JsonTree &patch);
+
+        /**
+         * @brief Find the paths whose value a patch replaces rather than merges
+         *
+         * These are the members present in both trees where the two values are
+         * not both objects. Flattened keys at or below them are stale.
+         *
+         * @param patch The parsed patch
+         * @return std::vector<std::string> Dot paths of the replaced values
+         */
+        std::vector<std::string> replacedPaths(const JsonTree &patch) const;
+
+        /**
+         * @brief Expand {{#array}} sections of a document against the loaded data
+         *
+         * @param xmlDoc The document
+         */
+        void expandSectionsInXml(XmlDocument &xmlDoc) const;
+
+        /**
+         * @brief Read a file into the arena and point source_ at it
+         *
+         * @param jsonFilePath Path to the JSON file
+         * @return true if the file was read
+         * @return false if the file could not be opened
+         */
+        bool readSource(const std::string &jsonFilePath);
+
+        /**
+         * @brief Copy another object's data, re-pointing slices into our own arena
+         *
+         * @param other The object to copy from
+         */
+        void copyFrom(const JsonMerge &other);
+
+        /**
+         * @brief Extract value from JSON string by key
          *
          * @param jsonString The JSON content
-         * @param startPos Starting position
-         * @return std::string The extracted array content
+         * @param key The key to extract
+         * @param startPos Starting position to search from
+         * @return std::string The extracted value
          */
-        std::string extractArray(const std::string &jsonString, size_t startPos) const;
+        std::string extractJsonValue(const std::string &jsonString, const std::string &key, size_t startPos = 0) const;
+
+        /**
+         * @brief Trim whitespace and quotes from a string
+         *
+         * @param str The string to trim
+         * @return std::string Trimmed string
+         */
+        std::string trim(const std::string &str) const;
     };
 
 } // namespace json2doc
@@ -0,0 +1,157 @@
+#ifndef JSON_PARSER_H
+#define JSON_PARSER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include "json2doc/key_index.h"
+#include "json2doc/arena.h"
+#include "json2doc/json_value.h"
+
+namespace json2doc
+{
+
+    class StructuralIndex;
+
+    /**
+     * @brief Single-pass JSON flattener used by JsonMerge
+     *
+     * Walks the input buffer exactly once and reports every leaf value together
+     * with its dot-notation key (e.g. "metadata.version"). Nested objects are
+     * tracked on an explicit stack, so deep nesting cannot overflow the call
+     * stack, and sub-objects are never copied out of the input buffer. Tokens
+     * come from a StructuralIndex, so the parser only visits structural
+     * characters and the bytes of literal values.
+     *
+     * Values are reported as slices of the input:
+     * - strings without the surrounding quotes (escape sequences kept verbatim)
+     * - arrays as their raw text, brackets included
+     * - numbers, booleans and null as their trimmed literal text
+     *
+     * The same pass also builds a typed JsonTree of the document. Array
+     * elements are not flattened; they only exist as tree nodes, so an array
+     * is parsed once and its elements can then be indexed directly.
+     *
+     * When a set of required keys is given, only those keys are reported:
+     * objects that cannot contain a required key are skipped by bracket
+     * matching without building their key paths, and other values are
+     * skipped without calling the handler. Skipped subtrees are only checked
+     * for balanced brackets and terminated strings, and appear in the tree as
+     * unexpanded containers.
+     */
+    class JsonParser
+    {
+    public:
+        /**
+         * @brief Callback invoked for every flattened value
+         *
+         * @param key Full dot-notation key of the value
+         * @param value Pointer to the first character of the value inside the input
+         * @param length Length of the value in bytes
+         * @param node Id of the value in the JsonTree being built
+         */
+        using ValueHandler = std::function<void(const std::string &key, const char *value, size_t length, uint32_t node)>;
+
+        /**
+         * @brief Construct a new JsonParser object
+         */
+        JsonParser();
+
+        /**
+         * @brief Parse a JSON buffer and report its flattened values
+         *
+         * @param data Pointer to the JSON text
+         * @param size Size of the JSON text in bytes
+         * @param handler Callback receiving each key/value pair
+         * @return true if the whole document was parsed
+         * @return false if the document is malformed (see getLastError())
+         */
+        bool parse(const char *data, size_t size, const ValueHandler &handler);
+
+        /**
+         * @brief Parse a JSON buffer into a tree and report its flattened values
+         *
+         * @param data Pointer to the JSON text (must outlive the tree)
+         * @param size Size of the JSON text in bytes
+         * @param tree Receives the document (cleared first; empty unless the
+         *             document is an object)
+         * @param handler Callback receiving each key/value pair
+         * @return true if the whole document was parsed
+         * @return false if the document is malformed (see getLastError())
+         */
+        bool parse(const char *data, size_t size, JsonTree &tree, const ValueHandler &handler);
+
+        /**
+         * @brief Parse a JSON string and report its flattened values
+         *
+         * @param json The JSON content
+         * @param handler Callback receiving each key/value pair
+         * @return true if the whole document was parsed
+         * @return false if the document is malformed (see getLastError())
+         */
+        bool parse(const std::string &json, const ValueHandler &handler);
+
+        /**
+         * @brief Report only the given keys (and skip everything else)
+         *
+         * The selection applies to every later parse() until it is changed.
+         * An empty list restores reporting of every key.
+         *
+         * @param keys Full dot-notation keys to report
+         */
+        void setRequiredKeys(const std::vector<std::string> &keys);
+
+        /**
+         * @brief Check whether a required-key selection is active
+         *
+         * @return true if only selected keys are reported
+         */
+        bool hasRequiredKeys() const;
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message (empty after a successful parse)
+         */
+        std::string getLastError() const;
+
+    private:
+        const char *data_;
+        size_t size_;
+        size_t pos_;
+        std::string lastError_;
+
+        // One open object or array, innermost last
+        struct Frame
+        {
+            uint32_t node;     // Tree node of the container
+            size_t start;      // Offset of the opening bracket
+            size_t childBase;  // First child of the container in children_
+            size_t pathLength; // Length of the key path of the container
+            bool array;
+            bool flat;   // Members are flattened (objects outside arrays)
+            bool report; // Report the raw text on close (flattened arrays)
+        };
+
+        std::vector<Frame> stack_;
+        std::vector<uint32_t> children_; // Child ids of the open containers
+        std::string path_;
+        JsonTree scratch_; // Tree for the overloads that do not take one
+
+        // Required-key selection: the keys themselves, and every key path
+        // of an object that leads to one of them ("a" and "a.b" for "a.b.c")
+        bool filtered_;
+        KeyIndex requiredKeys_;
+        KeyIndex requiredPrefixes_;
+        Arena requiredStorage_;
+
+        bool closeString(StructuralIndex &index, size_t &end);
+        bool skipContainer(StructuralIndex &index, size_t &end);
+        void closeContainer(JsonTree &tree, const ValueHandler &handler);
+        bool fail(const std::string &message);
+    };
+
+} // namespace json2doc
+
+#endif // JSON_PARSER_H
@@ -0,0 +1,176 @@
+#ifndef JSON_SNAPSHOT_H
+#define JSON_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "json2doc/mapped_file.h"
+#include "json2doc/key_index.h"
+#include "json2doc/json_value.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief Binary image of loaded JSON data, read in place from a mapping
+     *
+     * A snapshot holds the flattened key index (an open-addressing table like
+     * KeyIndex's), the typed tree as fixed-size node records and one blob with
+     * every key and value byte. Opening one maps the file and checks the header
+     * and section bounds; lookups then probe the table in place and return
+     * views of the blob, so nothing is parsed or hashed at load time. Records
+     * use 32-bit offsets, so the blob is limited to 4 GiB.
+     *
+     * Snapshots use the byte order of the machine that wrote them and are
+     * rejected elsewhere.
+     */
+    class JsonSnapshot
+    {
+    public:
+        /**
+         * @brief Construct an empty (closed) JsonSnapshot object
+         */
+        JsonSnapshot();
+
+        JsonSnapshot(const JsonSnapshot &) = delete;
+        JsonSnapshot &operator=(const JsonSnapshot &) = delete;
+        JsonSnapshot(JsonSnapshot &&other) noexcept;
+        JsonSnapshot &operator=(JsonSnapshot &&other) noexcept;
+
+        /**
+         * @brief Write loaded data to a snapshot file
+         *
+         * Keys are copied into the blob. Values and tree text are stored as
+         * offsets into the regions, which are copied once each; slices outside
+         * every region are copied on their own.
+         *
+         * @param filePath Path of the file to create or replace
+         * @param index The flattened keys and values
+         * @param entryNodes Tree node of every index entry (JsonTree::npos for none)
+         * @param tree The typed tree
+         * @param regions Buffers the values and tree text are slices of
+         * @param error Receives the error message on failure
+         * @return true if the file was written
+         * @return false if it could not be written
+         */
+        static bool write(const std::string &filePath, const KeyIndex &index, const std::vector<uint32_t> &entryNodes,
+                          const JsonTree &tree, const std::vector<std::string_view> &regions, std::string &error);
+
+        /**
+         * @brief Map a snapshot file
+         *
+         * @param filePath Path to the snapshot
+         * @return true if the file is a valid snapshot
+         * @return false if it cannot be mapped or is not a snapshot
+         */
+        bool open(const std::string &filePath);
+
+        /**
+         * @brief Read a snapshot from memory the caller owns
+         *
+         * @param data Snapshot bytes, 8-byte aligned (must outlive the object)
+         * @param size Size in bytes
+         * @return true if the bytes are a valid snapshot
+         * @return false if they are not
+         */
+        bool attach(const char *data, size_t size);
+
+        /**
+         * @brief Unmap or detach the snapshot
+         */
+        void close();
+
+        /**
+         * @brief Check if a snapshot is open
+         *
+         * @return true if open
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Get the whole snapshot image
+         *
+         * @return std::string_view The bytes (write them out to copy the snapshot)
+         */
+        std::string_view bytes() const;
+
+        /**
+         * @brief Get the blob every key, value and tree text points into
+         *
+         * @return std::string_view The string section
+         */
+        std::string_view strings() const;
+
+        /**
+         * @brief Get the number of index entries
+         *
+         * @return size_t Entry count
+         */
+        size_t size() const;
+
+        /**
+         * @brief Find an entry by key
+         *
+         * @param key The flattened key
+         * @param keyHash KeyIndex::hash(key)
+         * @param entry Receives the entry number when found
+         * @return true if the key exists
+         * @return false if it does not
+         */
+        bool find(std::string_view key, uint64_t keyHash, size_t &entry) const;
+
+        std::string_view key(size_t entry) const;
+        std::string_view value(size_t entry) const;
+
+        /**
+         * @brief Get the tree node of an entry
+         *
+         * @param entry An entry number below size()
+         * @return uint32_t The node, JsonTree::npos if the entry has none
+         */
+        uint32_t node(size_t entry) const;
+
+        /**
+         * @brief Rebuild the typed tree from the node records
+         *
+         * Node text stays in the snapshot, so the tree is only valid while it
+         * is open.
+         *
+         * @param tree Receives the nodes (cleared first)
+         * @return true if every record is consistent
+         * @return false if a record points outside the snapshot
+         */
+        bool loadTree(JsonTree &tree) const;
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const;
+
+    private:
+        struct Header;
+        struct Slot;
+        struct EntryRecord;
+        struct NodeRecord;
+
+        MappedFile file_;
+        const char *data_;
+        size_t size_;
+        const Header *header_;
+        const Slot *slots_;
+        const EntryRecord *entries_;
+        const NodeRecord *nodes_;
+        const uint32_t *children_;
+        std::string_view strings_;
+        std::string lastError_;
+
+        std::string_view slice(uint32_t offset, uint32_t length) const;
+    };
+
+} // namespace json2doc
+
+#endif // JSON_SNAPSHOT_H
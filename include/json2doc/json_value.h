@@ -0,0 +1,344 @@
+#ifndef JSON_VALUE_H
+#define JSON_VALUE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Kind of a JSON value
+     */
+    enum class JsonType : uint8_t
+    {
+        Null,
+        Bool,
+        Int,
+        Double,
+        String,
+        Array,
+        Object
+    };
+
+    class JsonTree;
+
+    /**
+     * @brief Read-only handle to one value of a JsonTree
+     *
+     * A handle is two words (tree pointer and node id) and is cheap to copy.
+     * It stays valid until the tree it points into is reloaded, cleared or
+     * destroyed. Accessors on an invalid handle return the default value.
+     */
+    class JsonValue
+    {
+    public:
+        /**
+         * @brief Construct an invalid (missing) value
+         */
+        JsonValue();
+
+        /**
+         * @brief Construct a handle to a node of a tree
+         *
+         * @param tree The tree holding the node
+         * @param node The node id
+         */
+        JsonValue(const JsonTree *tree, uint32_t node);
+
+        /**
+         * @brief Check if the handle refers to a value
+         *
+         * @return true if the value exists
+         */
+        bool isValid() const;
+
+        /**
+         * @brief Get the kind of the value
+         *
+         * @return JsonType The type (Null for an invalid handle)
+         */
+        JsonType getType() const;
+
+        bool isNull() const;
+        bool isBool() const;
+        bool isNumber() const;
+        bool isString() const;
+        bool isArray() const;
+        bool isObject() const;
+
+        /**
+         * @brief Get a boolean (numbers are true when non-zero)
+         *
+         * @param defaultValue Returned for other types
+         * @return bool The value
+         */
+        bool asBool(bool defaultValue = false) const;
+
+        /**
+         * @brief Get an integer (doubles are truncated)
+         *
+         * @param defaultValue Returned for other types or out-of-range numbers
+         * @return int64_t The value
+         */
+        int64_t asInt(int64_t defaultValue = 0) const;
+
+        /**
+         * @brief Get a floating-point number
+         *
+         * @param defaultValue Returned for other types
+         * @return double The value
+         */
+        double asDouble(double defaultValue = 0.0) const;
+
+        /**
+         * @brief Get the value as text
+         *
+         * @return std::string Strings with escape sequences decoded; the raw
+         *         JSON text for every other type
+         */
+        std::string asString() const;
+
+        /**
+         * @brief Get the raw JSON text of the value without copying
+         *
+         * @return std::string_view String contents without quotes (escapes kept),
+         *         literal text, or the full text of an array/object
+         */
+        std::string_view getText() const;
+
+        /**
+         * @brief Get the member name when the value belongs to an object
+         *
+         * @return std::string_view The raw key, empty otherwise
+         */
+        std::string_view getKey() const;
+
+        /**
+         * @brief Get the number of elements (array) or members (object)
+         *
+         * @return size_t The count, 0 for scalars
+         */
+        size_t size() const;
+
+        /**
+         * @brief Check whether the children of a container were parsed
+         *
+         * Containers skipped by a required-variable selection keep only their
+         * raw text and report size() == 0.
+         *
+         * @return true for parsed containers and for scalars
+         */
+        bool isExpanded() const;
+
+        /**
+         * @brief Get an array element or object member by position in O(1)
+         *
+         * @param index Zero-based position
+         * @return JsonValue The child, invalid if out of range
+         */
+        JsonValue operator[](size_t index) const;
+
+        /**
+         * @brief Get an object member by name
+         *
+         * @param key The member name
+         * @return JsonValue The member, invalid if absent
+         */
+        JsonValue get(std::string_view key) const;
+
+        /**
+         * @brief Resolve a dot path below this value
+         *
+         * Numeric segments index arrays: "sections.1.heading".
+         *
+         * @param path The relative path
+         * @return JsonValue The value, invalid if the path does not resolve
+         */
+        JsonValue find(std::string_view path) const;
+
+        /**
+         * @brief Get the node id inside the tree
+         *
+         * @return uint32_t The node id
+         */
+        uint32_t getNode() const;
+
+    private:
+        const JsonTree *tree_;
+        uint32_t node_;
+    };
+
+    /**
+     * @brief Compact typed tree of one parsed JSON document
+     *
+     * Nodes are stored in one vector in document order. The children of every
+     * container are contiguous in a second vector, so indexing an array is a
+     * single offset computation. Text and keys are slices of the parsed input,
+     * which must outlive the tree. Numbers are converted when they are read.
+     */
+    class JsonTree
+    {
+    public:
+        /**
+         * @brief One value of the document
+         */
+        struct Node
+        {
+            std::string_view text; // Raw text (see JsonValue::getText())
+            std::string_view key;  // Member name, empty for array elements and the root
+            uint32_t first;        // Position of the first child id in the child table
+            uint32_t count;        // Number of children
+            JsonType type;
+            bool expanded; // false for containers whose children were skipped
+        };
+
+        static const uint32_t npos = 0xffffffffu;
+
+        /**
+         * @brief Construct an empty JsonTree object
+         */
+        JsonTree();
+
+        /**
+         * @brief Append a node
+         *
+         * @param type The node type
+         * @param text The raw text
+         * @param key The member name
+         * @return uint32_t The new node id
+         */
+        uint32_t addNode(JsonType type, std::string_view text, std::string_view key);
+
+        /**
+         * @brief Record the children of a container
+         *
+         * @param node The container id
+         * @param children Child ids in order
+         * @param count Number of children
+         */
+        void setChildren(uint32_t node, const uint32_t *children, size_t count);
+
+        /**
+         * @brief Access a node
+         *
+         * @param node The node id
+         * @return Node& The node
+         */
+        Node &getNode(uint32_t node);
+        const Node &getNode(uint32_t node) const;
+
+        /**
+         * @brief Get a child by position
+         *
+         * @param node The container id
+         * @param index Zero-based position
+         * @return uint32_t The child id, npos if out of range
+         */
+        uint32_t child(uint32_t node, size_t index) const;
+
+        /**
+         * @brief Get an object member by name (linear in the member count)
+         *
+         * @param node The object id
+         * @param key The member name
+         * @return uint32_t The member id, npos if absent
+         */
+        uint32_t member(uint32_t node, std::string_view key) const;
+
+        /**
+         * @brief Resolve a dot path below a node
+         *
+         * @param node The starting node
+         * @param path Dot-separated member names and array indexes
+         * @return uint32_t The node id, npos if the path does not resolve
+         */
+        uint32_t find(uint32_t node, std::string_view path) const;
+
+        /**
+         * @brief Get the document root
+         *
+         * @return JsonValue The root object, invalid for an empty tree
+         */
+        JsonValue getRoot() const;
+
+        /**
+         * @brief Get a handle to a node
+         *
+         * @param node The node id (npos gives an invalid handle)
+         * @return JsonValue The handle
+         */
+        JsonValue getValue(uint32_t node) const;
+
+        /**
+         * @brief Copy a subtree of another tree into this one
+         *
+         * Slices are copied as they are, so the other tree's input must
+         * outlive this tree too.
+         *
+         * @param other The source tree (not this one)
+         * @param node The root of the subtree in other
+         * @return uint32_t Id of the copied root (not linked to a parent)
+         */
+        uint32_t graft(const JsonTree &other, uint32_t node);
+
+        /**
+         * @brief Add a child at the end of a container
+         *
+         * The child list moves to the end of the child table; the old range
+         * is left unused.
+         *
+         * @param node The container id
+         * @param child The child id
+         */
+        void appendChild(uint32_t node, uint32_t child);
+
+        /**
+         * @brief Re-point the slices into one input after it was copied elsewhere
+         *
+         * Slices outside [oldBase, oldBase + size) are left unchanged.
+         *
+         * @param oldBase Start of the original input
+         * @param size Size of the input
+         * @param newBase Start of the copy
+         */
+        void rebase(const char *oldBase, size_t size, const char *newBase);
+
+        /**
+         * @brief Get the number of nodes
+         *
+         * @return size_t Node count
+         */
+        size_t size() const;
+
+        /**
+         * @brief Check if the tree has no nodes
+         *
+         * @return true if empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Reserve room for a known number of nodes and child ids
+         *
+         * @param nodes Node count
+         * @param children Child table size
+         */
+        void reserve(size_t nodes, size_t children);
+
+        /**
+         * @brief Remove all nodes, keeping the allocated capacity
+         */
+        void clear();
+
+    private:
+        std::vector<Node> nodes_;
+        std::vector<uint32_t> children_;
+    };
+
+} // namespace json2doc
+
+#endif // JSON_VALUE_H
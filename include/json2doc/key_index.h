@@ -0,0 +1,156 @@
+#ifndef KEY_INDEX_H
+#define KEY_INDEX_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "arena.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief Open-addressing hash table mapping flattened JSON keys to values
+     *
+     * Entries are stored densely in insertion order together with their
+     * precomputed hash. The probe table only holds a 32-bit hash tag and the
+     * entry number per slot, so a lookup touches one or two cache lines before
+     * comparing a single key. Lookups take std::string_view and never allocate.
+     * Key bytes are copied into a caller-supplied Arena when a key is first
+     * inserted, so clearing the index and the arena releases them together.
+     */
+    class KeyIndex
+    {
+    public:
+        /**
+         * @brief One key/value pair of the index
+         */
+        struct Entry
+        {
+            uint64_t hash;          // KeyIndex::hash(key)
+            std::string_view key;   // Flattened dot-notation key (arena-owned)
+            std::string_view value; // Value slice owned by the caller
+        };
+
+        /**
+         * @brief Construct an empty KeyIndex object
+         */
+        KeyIndex();
+
+        /**
+         * @brief Hash a key
+         *
+         * @param key The key to hash
+         * @return uint64_t 64-bit hash used by the index
+         */
+        static uint64_t hash(std::string_view key);
+
+        /**
+         * @brief Insert a key, replacing the value if the key already exists
+         *
+         * @param key The key (copied into keyStorage if it is new)
+         * @param value The value (the referenced bytes must outlive the entry)
+         * @param keyStorage Arena that owns the key bytes
+         * @return size_t Position of the entry in entries()
+         */
+        size_t insert(std::string_view key, std::string_view value, Arena &keyStorage);
+
+        /**
+         * @brief Insert a key whose hash is already known
+         *
+         * @param key The key
+         * @param value The value
+         * @param keyHash KeyIndex::hash(key)
+         * @param keyStorage Arena that owns the key bytes
+         * @return size_t Position of the entry in entries()
+         */
+        size_t insert(std::string_view key, std::string_view value, uint64_t keyHash, Arena &keyStorage);
+
+        /**
+         * @brief Look up a key
+         *
+         * @param key The key to find
+         * @return const Entry* The entry, or nullptr if the key is absent
+         */
+        const Entry *find(std::string_view key) const;
+
+        /**
+         * @brief Look up a key whose hash is already known
+         *
+         * @param key The key to find
+         * @param keyHash KeyIndex::hash(key)
+         * @return const Entry* The entry, or nullptr if the key is absent
+         */
+        const Entry *find(std::string_view key, uint64_t keyHash) const;
+
+        /**
+         * @brief Replace the value of an entry
+         *
+         * @param entryIndex Position of the entry in entries()
+         * @param value The new value
+         */
+        void setValue(size_t entryIndex, std::string_view value);
+
+        /**
+         * @brief Remove entries, keeping the others in insertion order
+         *
+         * Positions in entries() change; the probe table is rebuilt.
+         *
+         * @param remove One flag per entry, true to remove it
+         * @return size_t Number of entries removed
+         */
+        size_t erase(const std::vector<bool> &remove);
+
+        /**
+         * @brief Get all entries in insertion order
+         *
+         * @return const std::vector<Entry>& The entries
+         */
+        const std::vector<Entry> &entries() const;
+
+        /**
+         * @brief Get the number of keys
+         *
+         * @return size_t Number of entries
+         */
+        size_t size() const;
+
+        /**
+         * @brief Check if the index has no keys
+         *
+         * @return true if empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Prepare the index for a number of keys
+         *
+         * @param count Expected number of keys
+         */
+        void reserve(size_t count);
+
+        /**
+         * @brief Remove all keys, keeping the allocated capacity
+         */
+        void clear();
+
+    private:
+        struct Slot
+        {
+            uint32_t tag;   // Upper 32 bits of the hash
+            uint32_t entry; // Entry number + 1, 0 for an empty slot
+        };
+
+        std::vector<Slot> slots_;
+        std::vector<Entry> entries_;
+        size_t mask_;
+
+        size_t findSlot(std::string_view key, uint64_t keyHash) const;
+        void grow();
+        void placeEntries();
+    };
+
+} // namespace json2doc
+
+#endif // KEY_INDEX_H
@@ -0,0 +1,95 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Read-only memory mapping of a file
+     *
+     * The file contents are accessed directly from the page cache, without
+     * copying them into a heap buffer. The mapping stays valid until close()
+     * is called or the object is destroyed; moving the object keeps the
+     * mapped address unchanged.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief Construct an empty (unmapped) MappedFile object
+         */
+        MappedFile();
+
+        /**
+         * @brief Destroy the MappedFile object and unmap the file
+         */
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        /**
+         * @brief Map a file into memory
+         *
+         * @param filePath Path to the file
+         * @return true if the file was mapped (empty files map to an empty view)
+         * @return false if the file could not be opened or mapped
+         */
+        bool open(const std::string &filePath);
+
+        /**
+         * @brief Unmap the file
+         */
+        void close();
+
+        /**
+         * @brief Check if a file is currently mapped
+         *
+         * @return true if open() succeeded and close() was not called since
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Get a pointer to the mapped bytes
+         *
+         * @return const char* Start of the mapping (nullptr for empty files)
+         */
+        const char *data() const;
+
+        /**
+         * @brief Get the size of the mapping
+         *
+         * @return size_t Size in bytes
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the mapped bytes as a string view
+         *
+         * @return std::string_view View over the whole file
+         */
+        std::string_view view() const;
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const;
+
+    private:
+        const char *data_;
+        size_t size_;
+        bool open_;
+        std::string lastError_;
+    };
+
+} // namespace json2doc
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,207 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdio>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Destination for serialized output, written in order
+     *
+     * Sinks collect small writes in a buffer and pass them on in large
+     * blocks; a write at least as large as the buffer skips it. After the
+     * first failed write the sink stays failed and drops further output, so
+     * callers can write everything and check the result once, at flush().
+     */
+    class OutputSink
+    {
+    public:
+        virtual ~OutputSink() = default;
+
+        OutputSink(const OutputSink &) = delete;
+        OutputSink &operator=(const OutputSink &) = delete;
+
+        /**
+         * @brief Append bytes to the output
+         *
+         * @param data Bytes to write
+         * @param size Number of bytes
+         * @return true if the sink has not failed
+         * @return false if this or an earlier write failed
+         */
+        bool write(const char *data, size_t size);
+        bool write(std::string_view data) { return write(data.data(), data.size()); }
+
+        /**
+         * @brief Append several byte ranges, in order
+         *
+         * Small ranges are copied into the buffer; larger ones are passed to
+         * the destination in place, together with the buffered bytes before
+         * them, in one gathered write (writev(2) for FdSink). Every range has
+         * been consumed when the call returns.
+         *
+         * @param parts The ranges
+         * @param count Number of ranges
+         * @return true if the sink has not failed
+         * @return false if this or an earlier write failed
+         */
+        bool writev(const std::string_view *parts, size_t count);
+
+        /**
+         * @brief Pass buffered bytes on to the destination
+         *
+         * @return true if everything written so far reached the destination
+         * @return false if a write failed
+         */
+        bool flush();
+
+        /**
+         * @brief Check if every write so far succeeded
+         *
+         * @return true if the sink has not failed
+         */
+        bool good() const { return !failed_; }
+
+        /**
+         * @brief Get the number of bytes written, including buffered ones
+         *
+         * @return size_t Bytes accepted by write()
+         */
+        size_t bytesWritten() const { return total_; }
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const { return lastError_; }
+
+    protected:
+        /**
+         * @brief Construct a sink
+         *
+         * @param bufferSize Bytes collected before writeOut() is called (0 for none)
+         */
+        explicit OutputSink(size_t bufferSize);
+
+        /**
+         * @brief Write a block to the destination
+         *
+         * @param data Bytes to write
+         * @param size Number of bytes (never 0)
+         * @return true if all bytes were written
+         * @return false on error, after calling fail()
+         */
+        virtual bool writeOut(const char *data, size_t size) = 0;
+
+        /**
+         * @brief Write several blocks to the destination, in order
+         *
+         * The default calls writeOut() for each block.
+         *
+         * @param parts The blocks (none empty)
+         * @param count Number of blocks
+         * @return true if all bytes were written
+         * @return false on error, after calling fail()
+         */
+        virtual bool writeOutv(const std::string_view *parts, size_t count);
+
+        /**
+         * @brief Fail the sink with an error message
+         *
+         * @param message The error message
+         * @return false
+         */
+        bool fail(const std::string &message);
+
+    private:
+        std::vector<char> buffer_;
+        std::vector<std::string_view> gather_; // Pending writev() blocks
+        size_t used_;
+        size_t total_;
+        bool failed_;
+        std::string lastError_;
+    };
+
+    /**
+     * @brief Sink writing to a file descriptor with write(2)
+     *
+     * The descriptor is not closed by the sink. Destroying the sink flushes
+     * it, but only an explicit flush() reports errors.
+     */
+    class FdSink : public OutputSink
+    {
+    public:
+        static constexpr size_t kDefaultBufferSize = 256 * 1024;
+
+        explicit FdSink(int fd, size_t bufferSize = kDefaultBufferSize);
+        ~FdSink() override;
+
+    protected:
+        bool writeOut(const char *data, size_t size) override;
+        bool writeOutv(const std::string_view *parts, size_t count) override;
+
+    private:
+        int fd_;
+    };
+
+    /**
+     * @brief Sink writing to a stdio stream
+     *
+     * Blocks are passed to fwrite() without flushing the stream itself; the
+     * stream is not closed by the sink. Destroying the sink flushes it.
+     */
+    class FileSink : public OutputSink
+    {
+    public:
+        static constexpr size_t kDefaultBufferSize = 256 * 1024;
+
+        explicit FileSink(FILE *file, size_t bufferSize = kDefaultBufferSize);
+        ~FileSink() override;
+
+    protected:
+        bool writeOut(const char *data, size_t size) override;
+
+    private:
+        FILE *file_;
+    };
+
+    /**
+     * @brief Sink appending to a string it owns
+     */
+    class MemorySink : public OutputSink
+    {
+    public:
+        MemorySink();
+
+        /**
+         * @brief Get the bytes written so far
+         *
+         * @return std::string_view View of the output (invalidated by later writes)
+         */
+        std::string_view view() const { return data_; }
+
+        /**
+         * @brief Move the output out of the sink, leaving it empty
+         *
+         * @return std::string The bytes written so far
+         */
+        std::string take();
+
+        void reserve(size_t size) { data_.reserve(size); }
+
+    protected:
+        bool writeOut(const char *data, size_t size) override;
+
+    private:
+        std::string data_;
+    };
+
+} // namespace json2doc
+
+#endif // OUTPUT_SINK_H
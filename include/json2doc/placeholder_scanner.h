@@ -0,0 +1,70 @@
+#ifndef PLACEHOLDER_SCANNER_H
+#define PLACEHOLDER_SCANNER_H
+
+#include <string_view>
+#include <cstddef>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Finds {{variable}} placeholders in text without std::regex
+     *
+     * Recognizes exactly what the pattern \{\{([^}]+)\}\} matches: two opening
+     * braces, at least one character other than '}', then two closing braces.
+     * Braces are located with memchr (vectorized in the C library) and a
+     * failed candidate resumes the search after the '}' that ended it, so
+     * every byte is examined a bounded number of times: scanning is linear in
+     * the text length and never allocates.
+     *
+     * @code
+     * PlaceholderScanner scanner(text);
+     * PlaceholderScanner::Match match;
+     * while (scanner.next(match)) { use(match.name); }
+     * @endcode
+     */
+    class PlaceholderScanner
+    {
+    public:
+        /**
+         * @brief One placeholder occurrence
+         */
+        struct Match
+        {
+            size_t offset;                // Position of the first '{' in the text
+            std::string_view placeholder; // The whole "{{ name }}"
+            std::string_view name;        // Variable name with surrounding whitespace trimmed
+        };
+
+        /**
+         * @brief Construct a scanner over a text
+         *
+         * @param text The text to scan (must outlive the scanner and its matches)
+         */
+        explicit PlaceholderScanner(std::string_view text);
+
+        /**
+         * @brief Find the next placeholder
+         *
+         * @param match Receives the placeholder
+         * @return true if a placeholder was found
+         * @return false if the end of the text was reached
+         */
+        bool next(Match &match);
+
+        /**
+         * @brief Check whether a text contains at least one placeholder
+         *
+         * @param text The text to check
+         * @return true if a placeholder exists
+         */
+        static bool contains(std::string_view text);
+
+    private:
+        std::string_view text_;
+        size_t pos_;
+    };
+
+} // namespace json2doc
+
+#endif // PLACEHOLDER_SCANNER_H
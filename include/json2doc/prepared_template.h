@@ -0,0 +1,102 @@
+#ifndef PREPARED_TEMPLATE_H
+#define PREPARED_TEMPLATE_H
+
+#include <string>
+#include <vector>
+#include "json2doc/xml_document.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief A template document parsed and indexed once, copied per render
+     *
+     * Loading parses the XML, joins placeholders Word split across runs
+     * (XmlDocument::mergeSplitPlaceholders()) and builds the placeholder
+     * index, all a single time.
+     * instantiate() then gives each render its own mutable XmlDocument by
+     * copying the parsed tree and the index (XmlDocument::copyFrom()), which
+     * skips tokenizing the text and scanning it for placeholders again.
+     *
+     * After loading, the object is only read, so any number of threads may
+     * call instantiate() at once.
+     *
+     * Usage:
+     * @code
+     * PreparedTemplate prepared;
+     * prepared.loadDocx("template.docx");
+     * XmlDocument doc;
+     * for (const auto &record : records)
+     * {
+     *     prepared.instantiate(doc);
+     *     merger.loadJsonString(record);
+     *     merger.mergeIntoXml(doc);
+     * }
+     * @endcode
+     */
+    class PreparedTemplate
+    {
+    public:
+        /**
+         * @brief Construct an empty PreparedTemplate object
+         */
+        PreparedTemplate();
+
+        /**
+         * @brief Prepare a template from XML text
+         *
+         * @param xmlContent The template XML
+         * @return true if the template is well-formed XML
+         * @return false otherwise (see getLastError())
+         */
+        bool load(const std::string &xmlContent);
+
+        /**
+         * @brief Prepare a template from the main document XML of a DOCX file
+         *
+         * @param docxPath Path to the .docx template
+         * @return true if the document XML was read and is well-formed
+         * @return false otherwise (see getLastError())
+         */
+        bool loadDocx(const std::string &docxPath);
+
+        /**
+         * @brief Check if a template is loaded
+         *
+         * @return true if load() or loadDocx() succeeded
+         */
+        bool isLoaded() const;
+
+        /**
+         * @brief Replace a document with a fresh copy of the template
+         *
+         * @param doc Receives the copy; its previous contents are discarded
+         * @return true if a template is loaded and was copied
+         * @return false if no template is loaded
+         */
+        bool instantiate(XmlDocument &doc) const;
+
+        /**
+         * @brief Get the template's variable names
+         *
+         * @return const std::vector<std::string>& Distinct names in document order
+         */
+        const std::vector<std::string> &getVariables() const;
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const;
+
+    private:
+        XmlDocument prototype_;
+        std::vector<std::string> variables_;
+        bool loaded_;
+        std::string lastError_;
+    };
+
+} // namespace json2doc
+
+#endif // PREPARED_TEMPLATE_H
@@ -0,0 +1,222 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Vector that keeps its first N elements inside the object
+     *
+     * Up to N elements need no heap allocation, which suits short result
+     * lists such as the matches of an XPath query; past N the elements move
+     * to a heap buffer that grows geometrically, like std::vector. Pointers
+     * and iterators are invalidated by growth and by moves of the container.
+     *
+     * @tparam T Element type
+     * @tparam N Number of inline elements
+     */
+    template <typename T, size_t N>
+    class SmallVector
+    {
+        static_assert(N > 0, "SmallVector needs at least one inline element");
+
+    public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        SmallVector()
+            : data_(inlineData()), size_(0), capacity_(N)
+        {
+        }
+
+        SmallVector(const SmallVector &other)
+            : SmallVector()
+        {
+            reserve(other.size_);
+            for (const T &value : other)
+            {
+                new (data_ + size_) T(value);
+                size_++;
+            }
+        }
+
+        SmallVector(SmallVector &&other) noexcept
+            : SmallVector()
+        {
+            takeFrom(other);
+        }
+
+        SmallVector &operator=(const SmallVector &other)
+        {
+            if (this != &other)
+            {
+                clear();
+                reserve(other.size_);
+                for (const T &value : other)
+                {
+                    new (data_ + size_) T(value);
+                    size_++;
+                }
+            }
+            return *this;
+        }
+
+        SmallVector &operator=(SmallVector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                releaseHeap();
+                takeFrom(other);
+            }
+            return *this;
+        }
+
+        ~SmallVector()
+        {
+            clear();
+            releaseHeap();
+        }
+
+        template <typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            if (size_ == capacity_)
+            {
+                // args may refer to an element, so build the value before moving them
+                T value(std::forward<Args>(args)...);
+                grow(size_ + 1);
+                new (data_ + size_) T(std::move(value));
+            }
+            else
+            {
+                new (data_ + size_) T(std::forward<Args>(args)...);
+            }
+            return data_[size_++];
+        }
+
+        void push_back(const T &value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T &&value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back()
+        {
+            data_[--size_].~T();
+        }
+
+        void reserve(size_t capacity)
+        {
+            if (capacity > capacity_)
+            {
+                grow(capacity);
+            }
+        }
+
+        /**
+         * @brief Destroy every element, keeping the capacity
+         */
+        void clear()
+        {
+            for (size_t i = 0; i < size_; i++)
+            {
+                data_[i].~T();
+            }
+            size_ = 0;
+        }
+
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+        bool empty() const { return size_ == 0; }
+
+        /**
+         * @brief Check if the elements are still stored inside the object
+         *
+         * @return true if no heap buffer is in use
+         */
+        bool isInline() const { return data_ == inlineData(); }
+
+        T &operator[](size_t index) { return data_[index]; }
+        const T &operator[](size_t index) const { return data_[index]; }
+        T &front() { return data_[0]; }
+        const T &front() const { return data_[0]; }
+        T &back() { return data_[size_ - 1]; }
+        const T &back() const { return data_[size_ - 1]; }
+        T *data() { return data_; }
+        const T *data() const { return data_; }
+
+        iterator begin() { return data_; }
+        iterator end() { return data_ + size_; }
+        const_iterator begin() const { return data_; }
+        const_iterator end() const { return data_ + size_; }
+
+    private:
+        alignas(T) unsigned char inline_[N * sizeof(T)];
+        T *data_;
+        size_t size_;
+        size_t capacity_;
+
+        T *inlineData() { return reinterpret_cast<T *>(inline_); }
+        const T *inlineData() const { return reinterpret_cast<const T *>(inline_); }
+
+        void grow(size_t minCapacity)
+        {
+            size_t capacity = std::max(minCapacity, capacity_ * 2);
+            T *heap = static_cast<T *>(::operator new(capacity * sizeof(T)));
+            for (size_t i = 0; i < size_; i++)
+            {
+                new (heap + i) T(std::move(data_[i]));
+                data_[i].~T();
+            }
+            releaseHeap();
+            data_ = heap;
+            capacity_ = capacity;
+        }
+
+        void releaseHeap()
+        {
+            if (!isInline())
+            {
+                ::operator delete(data_);
+                data_ = inlineData();
+                capacity_ = N;
+            }
+        }
+
+        // Expects this to be empty and inline
+        void takeFrom(SmallVector &other)
+        {
+            if (other.isInline())
+            {
+                for (size_t i = 0; i < other.size_; i++)
+                {
+                    new (data_ + i) T(std::move(other.data_[i]));
+                }
+                size_ = other.size_;
+                other.clear();
+                return;
+            }
+
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inlineData();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    };
+
+} // namespace json2doc
+
+#endif // SMALL_VECTOR_H
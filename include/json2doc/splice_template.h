@@ -0,0 +1,139 @@
+#ifndef SPLICE_TEMPLATE_H
+#define SPLICE_TEMPLATE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstddef>
+#include <cstdint>
+#include "json2doc/symbol_table.h"
+
+namespace json2doc
+{
+
+    class OutputSink;
+
+    /**
+     * @brief Renders a template by splicing values into its serialized bytes
+     *
+     * For plain substitution no DOM is needed per render. load() parses the
+     * template once with XmlDocument and keeps the text toString() writes
+     * for it, then checks that text with a single scan (balanced tags, one
+     * root element, terminated comments, CDATA sections and processing
+     * instructions) and records the byte range and symbol id of every
+     * {{placeholder}} in character data. render() then writes the unchanged
+     * ranges in between and the XML-escaped values, as gathered writes,
+     * without parsing or serializing anything.
+     *
+     * Placeholders are found in the same text runs XmlDocument indexes, and
+     * substituting text changes no node, so the output is byte for byte what
+     * XmlDocument::replaceVariables() followed by toString() produces,
+     * declaration, entities and indentation included.
+     *
+     * Templates whose placeholders contain a character that toString()
+     * escapes (&, < or >) or a carriage return are rejected at load, since
+     * their names differ from the bytes; render those with XmlDocument.
+     */
+    class SpliceTemplate
+    {
+    public:
+        /**
+         * @brief A placeholder in the template bytes
+         */
+        struct Placeholder
+        {
+            size_t offset;   // Position of the first '{' in the template
+            uint32_t length; // Length of "{{ name }}"
+            uint32_t symbol; // Id in getSymbols()
+            bool cdata;      // Inside a CDATA section (value written unescaped)
+        };
+
+        /**
+         * @brief Construct an empty SpliceTemplate object
+         */
+        SpliceTemplate();
+
+        SpliceTemplate(const SpliceTemplate &) = delete;
+        SpliceTemplate &operator=(const SpliceTemplate &) = delete;
+        SpliceTemplate(SpliceTemplate &&other) noexcept = default;
+        SpliceTemplate &operator=(SpliceTemplate &&other) noexcept = default;
+
+        /**
+         * @brief Check a template and index its placeholders
+         *
+         * @param xmlContent The template XML (kept as toString() writes it)
+         * @return true if the template can be spliced
+         * @return false if it is not well-formed or not supported (see getLastError())
+         */
+        bool load(std::string xmlContent);
+
+        /**
+         * @brief Check if a template is loaded
+         *
+         * @return true if load() succeeded
+         */
+        bool isLoaded() const;
+
+        /**
+         * @brief Get the template bytes
+         *
+         * @return std::string_view The template as toString() writes it
+         */
+        std::string_view getXml() const;
+
+        /**
+         * @brief Get the placeholder names, ids in order of first occurrence
+         *
+         * @return const SymbolTable& The symbols (see JsonMerge::bindSymbols())
+         */
+        const SymbolTable &getSymbols() const;
+
+        /**
+         * @brief Get the placeholders in template order
+         *
+         * @return const std::vector<Placeholder>& The offset table
+         */
+        const std::vector<Placeholder> &getPlaceholders() const;
+
+        /**
+         * @brief Write the template with values substituted
+         *
+         * Unbound symbols leave their placeholders as they are. The sink is
+         * flushed at the end. Safe to call from several threads at once.
+         *
+         * @param values Values by symbol id
+         * @param sink Destination of the XML
+         * @return int Number of placeholders replaced, -1 if the sink failed
+         */
+        int render(const SymbolValues &values, OutputSink &sink) const;
+
+        /**
+         * @brief Write the template with values substituted by name
+         *
+         * @param variables Values by variable name
+         * @param sink Destination of the XML
+         * @return int Number of placeholders replaced, -1 if the sink failed
+         */
+        int render(const std::map<std::string, std::string> &variables, OutputSink &sink) const;
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const;
+
+    private:
+        std::string xml_;
+        SymbolTable symbols_;
+        std::vector<Placeholder> placeholders_;
+        bool loaded_;
+        std::string lastError_;
+
+        bool scanText(size_t offset, size_t length, bool cdata);
+    };
+
+} // namespace json2doc
+
+#endif // SPLICE_TEMPLATE_H
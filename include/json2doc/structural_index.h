@@ -0,0 +1,108 @@
+#ifndef STRUCTURAL_INDEX_H
+#define STRUCTURAL_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Vectorized first stage of the JSON parser
+     *
+     * Classifies the input in 64-byte blocks and records the position of every
+     * structural character: quotes, backslashes, braces, brackets, colons and
+     * commas. JsonParser then walks these positions instead of the raw bytes.
+     *
+     * The input is indexed lazily, one window at a time, so memory stays
+     * bounded regardless of the input size. The classification kernel is
+     * chosen at runtime (AVX2, SSE4.2 or a portable scalar fallback).
+     */
+    class StructuralIndex
+    {
+    public:
+        /**
+         * @brief Classification kernel
+         */
+        enum class Backend
+        {
+            Scalar,
+            Sse42,
+            Avx2
+        };
+
+        /**
+         * @brief Construct an index over a buffer
+         *
+         * @param data Pointer to the JSON text (not copied, must outlive the index)
+         * @param size Size of the JSON text in bytes
+         * @param backend Kernel used to classify the input
+         */
+        StructuralIndex(const char *data, size_t size, Backend backend = bestBackend());
+
+        /**
+         * @brief Consume the next structural position
+         *
+         * @return size_t Position in the input, or the input size when exhausted
+         */
+        size_t next();
+
+        /**
+         * @brief Look at the next structural position without consuming it
+         *
+         * @return size_t Position in the input, or the input size when exhausted
+         */
+        size_t peek();
+
+        /**
+         * @brief Classify a buffer and append all structural positions
+         *
+         * @param data Pointer to the text
+         * @param size Size of the text in bytes
+         * @param backend Kernel to use (must be supported by the CPU)
+         * @param positions Output vector receiving positions relative to data
+         */
+        static void classify(const char *data, size_t size, Backend backend, std::vector<uint32_t> &positions);
+
+        /**
+         * @brief Get the fastest kernel supported by the running CPU
+         *
+         * @return Backend The selected kernel
+         */
+        static Backend bestBackend();
+
+        /**
+         * @brief Check whether the running CPU supports a kernel
+         *
+         * @param backend The kernel to check
+         * @return true if the kernel can be used
+         */
+        static bool isSupported(Backend backend);
+
+        /**
+         * @brief Get a printable name for a kernel
+         *
+         * @param backend The kernel
+         * @return std::string Kernel name ("scalar", "sse4.2" or "avx2")
+         */
+        static std::string backendName(Backend backend);
+
+    private:
+        const char *data_;
+        size_t size_;
+        Backend backend_;
+
+        // Positions of the current window, relative to windowStart_
+        std::vector<uint32_t> positions_;
+        size_t windowStart_;
+        size_t windowEnd_;
+        size_t cursor_;
+
+        bool refill();
+    };
+
+} // namespace json2doc
+
+#endif // STRUCTURAL_INDEX_H
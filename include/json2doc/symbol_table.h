@@ -0,0 +1,146 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "arena.h"
+#include "key_index.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief Interns variable names into dense integer ids
+     *
+     * The first name interned gets id 0, the next new name id 1, and so on, so
+     * ids can index plain arrays. A template interns each placeholder name once
+     * when it is indexed; binding data to it then resolves every distinct name
+     * once into a SymbolValues table, and each substitution is an array read.
+     */
+    class SymbolTable
+    {
+    public:
+        static const uint32_t npos = 0xffffffffu;
+
+        /**
+         * @brief Construct an empty SymbolTable object
+         */
+        SymbolTable();
+
+        SymbolTable(const SymbolTable &) = delete;
+        SymbolTable &operator=(const SymbolTable &) = delete;
+        SymbolTable(SymbolTable &&other) noexcept = default;
+        SymbolTable &operator=(SymbolTable &&other) noexcept = default;
+
+        /**
+         * @brief Get the id of a name, adding it if it is new
+         *
+         * @param name The variable name (copied on first use)
+         * @return uint32_t The id
+         */
+        uint32_t intern(std::string_view name);
+
+        /**
+         * @brief Get the id of a name without adding it
+         *
+         * @param name The variable name
+         * @return uint32_t The id, npos if the name was never interned
+         */
+        uint32_t find(std::string_view name) const;
+
+        /**
+         * @brief Get the name of an id
+         *
+         * @param id An id below size()
+         * @return std::string_view The name
+         */
+        std::string_view name(uint32_t id) const;
+
+        /**
+         * @brief Get the number of distinct names
+         *
+         * @return size_t Name count (ids are 0 .. size() - 1)
+         */
+        size_t size() const;
+
+        /**
+         * @brief Check if no name was interned
+         *
+         * @return true if empty
+         */
+        bool empty() const;
+
+        /**
+         * @brief Remove all names, keeping the allocated capacity
+         */
+        void clear();
+
+    private:
+        KeyIndex index_;
+        Arena names_;
+    };
+
+    /**
+     * @brief Values bound to the ids of a SymbolTable
+     *
+     * Values are views; the bytes they reference must outlive the table.
+     * An id without a value is unbound, which leaves its placeholders as they
+     * are, while an empty value removes them.
+     */
+    class SymbolValues
+    {
+    public:
+        /**
+         * @brief Construct an empty SymbolValues object
+         */
+        SymbolValues();
+
+        /**
+         * @brief Unbind every id and size the table for a symbol count
+         *
+         * @param count Number of ids (SymbolTable::size())
+         */
+        void reset(size_t count);
+
+        /**
+         * @brief Bind a value to an id
+         *
+         * @param id An id below size()
+         * @param value The value
+         */
+        void set(uint32_t id, std::string_view value);
+
+        /**
+         * @brief Get the value bound to an id
+         *
+         * @param id The id
+         * @param value Receives the value when bound
+         * @return true if the id is bound
+         */
+        bool get(uint32_t id, std::string_view &value) const;
+
+        /**
+         * @brief Get the number of ids
+         *
+         * @return size_t Table size
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the number of bound ids
+         *
+         * @return size_t Bound id count
+         */
+        size_t boundCount() const;
+
+    private:
+        std::vector<std::string_view> values_;
+        std::vector<uint8_t> bound_;
+        size_t boundCount_;
+    };
+
+} // namespace json2doc
+
+#endif // SYMBOL_TABLE_H
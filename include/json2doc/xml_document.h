@@ -2,19 +2,31 @@
 #define XML_DOCUMENT_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
+#include <functional>
+#include "json2doc/symbol_table.h"
+#include "json2doc/small_vector.h"
+
+namespace pugi
+{
+    struct xml_node_struct;
+}
 
 namespace json2doc
 {
 
+    class OutputSink;
+    class EditBatch;
+
     /**
      * @brief Wrapper class for XML document operations using pugixml
      *
      * This class provides:
      * - XML parsing and manipulation
-     * - XPath query support
+     * - XPath query support, with compiled expressions cached (see prepare())
      * - Node traversal and modification
      * - Integration with JsonMerge for template processing
      */
@@ -33,6 +45,153 @@ namespace json2doc
             std::map<std::string, std::string> attributes;
         };
 
+    private:
+        struct CompiledXPath;
+
+    public:
+        /**
+         * @brief An XPath expression compiled once (see prepare())
+         *
+         * Handles are cheap to copy and work with any XmlDocument. A
+         * default-constructed handle is invalid and matches nothing.
+         */
+        class XPathQuery
+        {
+        public:
+            XPathQuery();
+
+            /**
+             * @brief Check if the expression compiled
+             *
+             * @return true if the handle can be evaluated
+             */
+            bool isValid() const;
+
+            /**
+             * @brief Get the source expression
+             *
+             * @return std::string The XPath expression, empty for an invalid handle
+             */
+            std::string getExpression() const;
+
+        private:
+            friend class XmlDocument;
+            std::shared_ptr<const CompiledXPath> compiled_;
+        };
+
+        /**
+         * @brief Counters of the compiled XPath cache
+         */
+        struct XPathCacheStats
+        {
+            size_t hits = 0;     // Expressions found compiled
+            size_t misses = 0;   // Expressions compiled
+            size_t entries = 0;  // Expressions currently cached
+            size_t capacity = 0; // Most expressions kept (0: caching off)
+        };
+
+        /**
+         * @brief pugixml memory held by the document (see XmlMemoryAccount)
+         */
+        struct MemoryStats
+        {
+            size_t bytes = 0;     // Bytes of the pages held now
+            size_t peakBytes = 0; // Most bytes held since the last load, copy or clear()
+            size_t pages = 0;     // Pages held now
+            size_t limit = 0;     // Limit for loads and copies (0: none)
+        };
+
+        /**
+         * @brief Lightweight handle to a node of the document (see select())
+         *
+         * A handle is one pointer: the name and text are views of the DOM,
+         * and attributes and the serialized subtree are only built when asked
+         * for. Views and handles stay valid until the node is removed or the
+         * document is reloaded or cleared; text views until the text changes.
+         */
+        class NodeRef
+        {
+        public:
+            NodeRef();
+
+            /**
+             * @brief Check if the handle points to a node
+             *
+             * @return true if valid
+             */
+            bool isValid() const;
+
+            /**
+             * @brief Get the node name
+             *
+             * @return std::string_view The name, empty for text nodes
+             */
+            std::string_view name() const;
+
+            /**
+             * @brief Get the node text (first text child of an element)
+             *
+             * @return std::string_view The text, empty if none
+             */
+            std::string_view value() const;
+
+            /**
+             * @brief Get one attribute value
+             *
+             * @param attributeName Attribute name
+             * @return std::string_view The value, empty if absent
+             */
+            std::string_view attribute(std::string_view attributeName) const;
+
+            /**
+             * @brief Copy all attributes into a map
+             *
+             * @return std::map<std::string, std::string> Attributes by name
+             */
+            std::map<std::string, std::string> attributes() const;
+
+            /**
+             * @brief Serialize the node and its subtree without formatting
+             *
+             * @return std::string The XML of the subtree
+             */
+            std::string fullText() const;
+
+            /**
+             * @brief Materialize everything into an XmlNode
+             *
+             * @param path Value for XmlNode::path
+             * @return XmlNode The eager copy query() returns
+             */
+            XmlNode toXmlNode(const std::string &path = "") const;
+
+        private:
+            friend class XmlDocument;
+            explicit NodeRef(pugi::xml_node_struct *node);
+            pugi::xml_node_struct *node_;
+        };
+
+        /**
+         * @brief Matches of select(); the first eight need no allocation
+         */
+        using NodeList = SmallVector<NodeRef, 8>;
+
+        /**
+         * @brief Resolves a placeholder name to its value
+         *
+         * Receives the trimmed variable name and sets value when the variable
+         * exists. Returns false for unknown variables, which are left untouched.
+         * The value must stay valid until replaceVariables() returns.
+         */
+        using VariableLookup = std::function<bool(std::string_view name, std::string_view &value)>;
+
+        /**
+         * @brief Resolves a section name to the number of times its block repeats
+         *
+         * Returns 0 for unknown or empty sections, whose block is removed.
+         */
+        using SectionLookup = std::function<size_t(std::string_view name)>;
+
         /**
          * @brief Construct a new XmlDocument object
          */
@@ -61,36 +220,163 @@ namespace json2doc
          */
         bool loadFromFile(const std::string &filePath);
 
+        /**
+         * @brief Replace this document with a deep copy of another
+         *
+         * The other document is only read, so several threads may copy the
+         * same document at once. Its placeholder index is copied along with
+         * the nodes instead of being rebuilt by scanning the text, which
+         * makes this much cheaper than parsing the XML again (see
+         * PreparedTemplate).
+         *
+         * @param other The document to copy
+         * @return true if a document was copied
+         * @return false if other has no document loaded
+         */
+        bool copyFrom(const XmlDocument &other);
+
         /**
          * @brief Get XML content as string
          *
+         * Indents with two spaces; save() writes the document without
+         * building a string.
+         *
          * @return std::string The formatted XML content
          */
         std::string toString() const;
 
+        /**
+         * @brief Layout of saved XML
+         */
+        enum class SaveFormat
+        {
+            Raw,     // No whitespace added (the text Word itself writes)
+            Indented // Two-space indentation, as toString()
+        };
+
+        /**
+         * @brief Serialize the document to a sink
+         *
+         * pugixml's output is passed to the sink chunk by chunk, so the
+         * document never exists as one string. The sink is flushed at the end.
+         * To write into a package, pass the sink of ZipWriter::beginEntry().
+         * Only a failure sets getLastError(), so several threads may save one
+         * document at once.
+         *
+         * @param sink Destination of the XML bytes
+         * @param format Raw (default) or indented output
+         * @return true if the whole document was written
+         * @return false if no document is loaded or the sink failed
+         */
+        bool save(OutputSink &sink, SaveFormat format = SaveFormat::Raw) const;
+
+        /**
+         * @brief Serialize the document to a file
+         *
+         * @param filePath Path of the file to create or replace
+         * @param format Raw (default) or indented output
+         * @return true if the file was written
+         * @return false if no document is loaded or the file could not be written
+         */
+        bool saveToFile(const std::string &filePath, SaveFormat format = SaveFormat::Raw) const;
+
         /**
          * @brief Execute XPath query and return matching nodes
          *
+         * Every match is copied, including its attributes and serialized
+         * subtree; select() returns handles that do this on demand.
+         *
          * @param xpath The XPath expression
          * @return std::vector<XmlNode> List of matching nodes
          */
         std::vector<XmlNode> query(const std::string &xpath) const;
+        std::vector<XmlNode> query(const XPathQuery &xpath) const;
+
+        /**
+         * @brief Execute XPath query and return handles to the matching elements
+         *
+         * Unlike query(), nothing is copied or serialized up front; each
+         * NodeRef computes its text, attributes or subtree on access.
+         *
+         * @param xpath The XPath expression
+         * @return NodeList Handles in document order (attribute matches are skipped)
+         */
+        NodeList select(const std::string &xpath) const;
+        NodeList select(const XPathQuery &xpath) const;
+
+        /**
+         * @brief Get a handle to the first node matching XPath
+         *
+         * @param xpath The XPath expression
+         * @return NodeRef The node, invalid if nothing matches
+         */
+        NodeRef selectNode(const std::string &xpath) const;
+        NodeRef selectNode(const XPathQuery &xpath) const;
+
+        /**
+         * @brief Compile an XPath expression for repeated use
+         *
+         * Every method taking an XPath string looks the expression up in a
+         * small LRU cache of compiled queries first, so repeating a string
+         * costs one hash lookup instead of a recompilation. prepare() goes
+         * further and returns the compiled query itself, for the overloads
+         * taking an XPathQuery.
+         *
+         * @param xpath The XPath expression
+         * @return XPathQuery The handle, invalid if the expression does not
+         *         compile (see getLastError())
+         */
+        XPathQuery prepare(const std::string &xpath) const;
+
+        /**
+         * @brief Set how many compiled expressions the cache keeps
+         *
+         * The least recently used ones are dropped first; 0 turns caching
+         * off. The default is 64. Handles from prepare() stay valid.
+         *
+         * @param capacity Maximum number of cached expressions
+         */
+        void setXPathCacheCapacity(size_t capacity);
+
+        /**
+         * @brief Get the compiled XPath cache counters
+         *
+         * @return XPathCacheStats Hits, misses, size and capacity
+         */
+        XPathCacheStats getXPathCacheStats() const;
 
         /**
          * @brief Find all text nodes matching XPath
          *
+         * The default expression reads the text table built at load time
+         * instead of evaluating XPath.
+         *
          * @param xpath The XPath expression (default: all text nodes)
          * @return std::vector<std::string> List of text values
          */
         std::vector<std::string> findTextNodes(const std::string &xpath = "//text()") const;
+        std::vector<std::string> findTextNodes(const XPathQuery &xpath) const;
 
         /**
          * @brief Find all nodes containing {{variable}} placeholders
          *
-         * @return std::vector<XmlNode> Nodes with template variables
+         * Reads the placeholder index built at load time instead of walking
+         * the tree. Each path is positional (e.g. /w:document/w:body/w:p[3]/w:r/w:t),
+         * so getNode() or setNodeText() with it reaches the same element.
+         *
+         * @return std::vector<XmlNode> Nodes with template variables, in document order
          */
         std::vector<XmlNode> findTemplateNodes() const;
 
+        /**
+         * @brief Get handles to the elements whose text holds placeholders
+         *
+         * Same elements as findTemplateNodes(), without copying or building paths.
+         *
+         * @return NodeList Elements in document order
+         */
+        NodeList templateNodes() const;
+
         /**
          * @brief Replace text in nodes matching XPath
          *
@@ -100,6 +386,7 @@ namespace json2doc
          * @return int Number of replacements made
          */
         int replaceText(const std::string &xpath, const std::string &oldText, const std::string &newText);
+        int replaceText(const XPathQuery &xpath, const std::string &oldText, const std::string &newText);
 
         /**
          * @brief Replace all {{variable}} placeholders using a value map
@@ -109,13 +396,149 @@ namespace json2doc
          */
         int replaceVariables(const std::map<std::string, std::string> &variables);
 
+        /**
+         * @brief Replace all {{variable}} placeholders using a lookup function
+         *
+         * Lets callers resolve names against their own storage (e.g. JsonMerge's
+         * key index) without building a std::map first.
+         *
+         * Each distinct name is looked up once (see getSymbols()), not once
+         * per occurrence.
+         *
+         * @param lookup Function resolving a variable name to its value
+         * @return int Number of replacements made
+         */
+        int replaceVariables(const VariableLookup &lookup);
+
+        /**
+         * @brief Replace all {{variable}} placeholders using values bound to symbol ids
+         *
+         * Substitution reads values by array index; no name is hashed or
+         * compared. Unbound ids leave their placeholders untouched.
+         *
+         * @param values Values for the ids of getSymbols()
+         * @return int Number of replacements made
+         */
+        int replaceVariables(const SymbolValues &values);
+
+        /**
+         * @brief Replace placeholders and keep the template for updateVariables()
+         *
+         * Same result as replaceVariables(values), but every text node that
+         * held placeholders keeps its template text, and each symbol the list
+         * of nodes it feeds. Calling it again (or replaceVariables() while
+         * bound) re-renders every node from its template. The binding ends
+         * when the text is changed any other way, or on load and clear().
+         *
+         * @param values Values for the ids of getSymbols()
+         * @return int Number of replacements made
+         */
+        int bindVariables(const SymbolValues &values);
+
+        /**
+         * @brief Re-render only the text nodes fed by some symbols
+         *
+         * Each affected node is rebuilt from its template; the symbols it uses
+         * are resolved once through lookup. Nodes whose text comes out the same
+         * are not counted or reported.
+         *
+         * @param changed Ids (of getSymbols()) whose values changed
+         * @param lookup Resolves the names used by the affected nodes
+         * @param changedPaths Optional; receives the XPath of each rewritten element
+         * @return int Number of text nodes rewritten, -1 if the document is not bound
+         */
+        int updateVariables(const std::vector<uint32_t> &changed, const VariableLookup &lookup,
+                            std::vector<std::string> *changedPaths = nullptr);
+
+        /**
+         * @brief Check if the document is bound to its template (see bindVariables())
+         *
+         * @return true if updateVariables() can be used
+         */
+        bool isBound() const;
+
+        /**
+         * @brief Get the placeholder names of the document interned to dense ids
+         *
+         * The first call after a load scans the text nodes once and records
+         * every placeholder with its symbol id. The index is reused until the
+         * text changes (replacements, section expansion, setNodeText(), ...),
+         * and the returned table is valid until then. While the document is
+         * bound, these are the names of the bound template.
+         *
+         * @return const SymbolTable& The names, in order of first occurrence
+         */
+        const SymbolTable &getSymbols() const;
+
+        /**
+         * @brief Get the number of placeholders in the text nodes
+         *
+         * Counts every occurrence (getSymbols() holds the distinct names);
+         * uses the same index as getSymbols().
+         *
+         * @return size_t Placeholder count
+         */
+        size_t getPlaceholderCount() const;
+
+        /**
+         * @brief Expand {{#name}}...{{/name}} repeating sections
+         *
+         * The block between the markers is repeated once per element of the
+         * section. The block is the table rows (w:tr) holding both markers,
+         * else the paragraphs (w:p), else the smallest subtree holding both.
+         * The markers are removed from the block once, and every copy is
+         * cloned from that prototype in the DOM, so time and memory stay
+         * linear in the number of copies.
+         *
+         * Inside copy i, {{field}} becomes {{name.i.field}} when lookup()
+         * resolves that name, {{.}} becomes {{name.i}}, and other placeholders
+         * are left for the outer scope. Nested sections are expanded the same
+         * way. Call replaceVariables() afterwards to fill in the values.
+         *
+         * @param sections Returns how many times each section repeats
+         * @param lookup Resolves the element-scoped variable names
+         * @return int Number of sections expanded (nested ones included)
+         */
+        int expandSections(const SectionLookup &sections, const VariableLookup &lookup);
+
+        /**
+         * @brief Join placeholders that Word split across several runs
+         *
+         * Word and Google Docs often store {{customer.name}} as several
+         * w:r/w:t elements (after spell checking or formatting edits), which
+         * replaceVariables() cannot see. This pass joins the text of each w:p
+         * in one linear sweep and moves every placeholder spanning several
+         * w:t into the first of them, so it takes that run's formatting; runs
+         * left empty are removed. Tabs, breaks and other run content are never
+         * crossed. Run it once when preparing a template (PreparedTemplate
+         * does), not per render.
+         *
+         * @return int Number of placeholders merged
+         */
+        int mergeSplitPlaceholders();
+
         /**
          * @brief Get all text content from document
          *
+         * Visits every element in document order and appends its text()
+         * (first text child) followed by a space; text nodes are their own
+         * text(), so each text node also appears once more after its element.
+         * Reads the text table built at load time, and only the elements
+         * above its text nodes, instead of walking the whole tree. Use
+         * getParagraphTexts() for the joined runs of each paragraph.
+         *
          * @return std::string Concatenated text content
          */
         std::string getTextContent() const;
 
+        /**
+         * @brief Get the text of every paragraph (w:p)
+         *
+         * @return std::vector<std::string> The joined runs of each paragraph, in
+         *         document order (text of nested paragraphs is theirs only)
+         */
+        std::vector<std::string> getParagraphTexts() const;
+
         /**
          * @brief Get node by XPath (first match)
          *
@@ -123,6 +546,7 @@ namespace json2doc
          * @return XmlNode The first matching node (empty if not found)
          */
         XmlNode getNode(const std::string &xpath) const;
+        XmlNode getNode(const XPathQuery &xpath) const;
 
         /**
          * @brief Set node text content by XPath
@@ -133,6 +557,7 @@ namespace json2doc
          * @return false if node was not found
          */
         bool setNodeText(const std::string &xpath, const std::string &text);
+        bool setNodeText(const XPathQuery &xpath, const std::string &text);
 
         /**
          * @brief Get attribute value from node
@@ -142,6 +567,7 @@ namespace json2doc
          * @return std::string Attribute value or empty string
          */
         std::string getAttributeValue(const std::string &xpath, const std::string &attributeName) const;
+        std::string getAttributeValue(const XPathQuery &xpath, const std::string &attributeName) const;
 
         /**
          * @brief Set attribute value on node
@@ -153,6 +579,21 @@ namespace json2doc
          * @return false if node not found
          */
         bool setAttributeValue(const std::string &xpath, const std::string &attributeName, const std::string &value);
+        bool setAttributeValue(const XPathQuery &xpath, const std::string &attributeName, const std::string &value);
+
+        /**
+         * @brief Apply a batch of text and attribute edits (see EditBatch)
+         *
+         * Expressions the batch has not compiled yet are compiled once and
+         * kept in it. Every target is then resolved (plain child paths in one
+         * walk of the tree, other expressions with one evaluation each), and
+         * only then are the operations applied in order. Invalid expressions
+         * set getLastError() and update nothing.
+         *
+         * @param batch The edits
+         * @return std::vector<size_t> Nodes updated by each operation, in batch order
+         */
+        std::vector<size_t> applyEdits(EditBatch &batch);
 
         /**
          * @brief Check if document is valid (was successfully loaded)
@@ -174,10 +615,32 @@ namespace json2doc
          */
         void clear();
 
+        /**
+         * @brief Cap the pugixml memory a load or copy may take
+         *
+         * Every page pugixml allocates for the document is counted. A load
+         * (or copyFrom()) that would take more fails with a "Memory limit
+         * exceeded" error and leaves the document empty, instead of growing
+         * until the process is killed. Later edits are counted but never
+         * refused, so an edit cannot stop halfway.
+         *
+         * @param bytes The limit (0 = no limit, the default)
+         */
+        void setMemoryLimit(size_t bytes);
+
+        /**
+         * @brief Get the pugixml memory held by the document
+         *
+         * @return MemoryStats Bytes, peak bytes, pages and limit
+         */
+        MemoryStats getMemoryStats() const;
+
     private:
         class Impl; // Forward declaration for PIMPL pattern
         std::unique_ptr<Impl> pImpl_;
         std::string lastError_;
+
+        std::string memoryLimitError() const;
     };
 
 } // namespace json2doc
@@ -0,0 +1,145 @@
+#ifndef XML_MEMORY_H
+#define XML_MEMORY_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace json2doc
+{
+
+    /**
+     * @brief Counts the pugixml memory held by one document
+     *
+     * pugixml takes all its memory as pages (nodes, attributes and short
+     * strings share 32 KiB pages; the parse buffer and long strings get
+     * pages of their own) through process-wide hooks. This library installs
+     * hooks at start-up that serve pages from a per-thread arena, so
+     * concurrent renders reuse their own freed pages instead of contending
+     * in malloc, and charge every page to the account made current on the
+     * allocating thread by an XmlMemoryScope. A page keeps a reference to
+     * its account, so freeing it on any thread, even after the document is
+     * gone, credits the right account.
+     *
+     * Pages allocated with no scope active (compiled XPath queries, say)
+     * are not charged to anyone.
+     */
+    class XmlMemoryAccount
+    {
+    public:
+        /**
+         * @brief Construct an empty account without a limit
+         */
+        XmlMemoryAccount();
+
+        XmlMemoryAccount(const XmlMemoryAccount &) = delete;
+        XmlMemoryAccount &operator=(const XmlMemoryAccount &) = delete;
+
+        /**
+         * @brief Get the bytes of the pages held
+         *
+         * @return size_t Bytes requested by pugixml and not freed yet
+         */
+        size_t getBytes() const;
+
+        /**
+         * @brief Get the most bytes held at once since resetPeak()
+         *
+         * @return size_t Peak bytes
+         */
+        size_t getPeakBytes() const;
+
+        /**
+         * @brief Get the number of pages held
+         *
+         * @return size_t Pages allocated and not freed yet
+         */
+        size_t getPages() const;
+
+        /**
+         * @brief Restart the peak from the bytes held now
+         */
+        void resetPeak();
+
+        /**
+         * @brief Set the most bytes allocations under an enforcing scope may bring the account to
+         *
+         * @param bytes The limit (0 = no limit)
+         */
+        void setLimit(size_t bytes);
+
+        /**
+         * @brief Get the limit
+         *
+         * @return size_t The limit (0 = no limit)
+         */
+        size_t getLimit() const;
+
+        /**
+         * @brief Check if an allocation was refused since clearLimitExceeded()
+         *
+         * @return true if the limit refused a page
+         */
+        bool limitExceeded() const;
+
+        /**
+         * @brief Forget refused allocations
+         */
+        void clearLimitExceeded();
+
+        /**
+         * @brief The pugixml allocation hook
+         *
+         * @param size Bytes requested
+         * @return void* The page, nullptr if out of memory or over the limit
+         */
+        static void *allocate(size_t size);
+
+        /**
+         * @brief The pugixml deallocation hook
+         *
+         * @param page A page returned by allocate() (may be nullptr)
+         */
+        static void deallocate(void *page);
+
+    private:
+        std::atomic<size_t> bytes_;
+        std::atomic<size_t> peak_;
+        std::atomic<size_t> pages_;
+        std::atomic<size_t> limit_;
+        std::atomic<bool> exceeded_;
+
+        bool charge(size_t size, bool enforceLimit);
+        void credit(size_t size);
+    };
+
+    /**
+     * @brief Charges the pugixml pages allocated by this thread to an account
+     *
+     * Scopes nest; the previous account is current again when a scope ends.
+     * Under an enforcing scope, pages that would take the account past its
+     * limit are refused, which pugixml reports as out of memory.
+     */
+    class XmlMemoryScope
+    {
+    public:
+        /**
+         * @brief Make an account current on this thread
+         *
+         * @param account The account (must outlive the scope)
+         * @param enforceLimit true to refuse pages over the account limit
+         */
+        XmlMemoryScope(const std::shared_ptr<XmlMemoryAccount> &account, bool enforceLimit);
+        ~XmlMemoryScope();
+
+        XmlMemoryScope(const XmlMemoryScope &) = delete;
+        XmlMemoryScope &operator=(const XmlMemoryScope &) = delete;
+
+    private:
+        const std::shared_ptr<XmlMemoryAccount> *previous_;
+        bool previousEnforce_;
+    };
+
+} // namespace json2doc
+
+#endif // XML_MEMORY_H
@@ -0,0 +1,104 @@
+#ifndef ZIP_WRITER_H
+#define ZIP_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include "json2doc/output_sink.h"
+
+namespace json2doc
+{
+
+    /**
+     * @brief Writes a ZIP archive (such as a DOCX package) to a sink
+     *
+     * Entries are written one after another straight to the sink: an entry
+     * opened with beginEntry() is itself a sink, deflated as data arrives,
+     * with its sizes and CRC written in a data descriptor after the data, so
+     * no entry is ever held in memory whole. finish() writes the central
+     * directory. Archives are limited to 4 GiB and 65535 entries (no ZIP64).
+     */
+    class ZipWriter
+    {
+    public:
+        /**
+         * @brief Storage method of an entry
+         */
+        enum class Method
+        {
+            Store,  // Uncompressed (for data that is already compressed)
+            Deflate // zlib deflate
+        };
+
+        /**
+         * @brief Construct a writer for an archive
+         *
+         * @param out Destination of the archive bytes (must outlive the writer)
+         */
+        explicit ZipWriter(OutputSink &out);
+        ~ZipWriter();
+
+        ZipWriter(const ZipWriter &) = delete;
+        ZipWriter &operator=(const ZipWriter &) = delete;
+
+        /**
+         * @brief Start a new entry and get the sink its data goes to
+         *
+         * Ends the current entry first, if any. The sink stays valid until
+         * the next beginEntry(), addEntry(), endEntry() or finish().
+         *
+         * @param name Entry path inside the archive (e.g. "word/document.xml")
+         * @param method How the data is stored
+         * @return OutputSink* Sink for the entry data, nullptr on error
+         */
+        OutputSink *beginEntry(const std::string &name, Method method = Method::Deflate);
+
+        /**
+         * @brief End the current entry, writing its data descriptor
+         *
+         * @return true if the entry was written
+         * @return false on error
+         */
+        bool endEntry();
+
+        /**
+         * @brief Write a whole entry whose data is already in memory
+         *
+         * @param name Entry path inside the archive
+         * @param data Entry contents
+         * @param method How the data is stored
+         * @return true if the entry was written
+         * @return false on error
+         */
+        bool addEntry(const std::string &name, std::string_view data, Method method = Method::Deflate);
+
+        /**
+         * @brief End the current entry, write the central directory and flush
+         *
+         * @return true if the archive is complete
+         * @return false on error
+         */
+        bool finish();
+
+        /**
+         * @brief Set the deflate level of entries started later
+         *
+         * @param level 1 (fastest) to 9 (smallest); the default is 6
+         */
+        void setCompressionLevel(int level);
+
+        /**
+         * @brief Get the last error message
+         *
+         * @return std::string The error message
+         */
+        std::string getLastError() const;
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pImpl_;
+    };
+
+} // namespace json2doc
+
+#endif // ZIP_WRITER_H
@@ -1,8 +1,6 @@
 #include <iostream>
 #include <string>
 #include <cstring>
-#include <fstream>
-#include <sstream>
 #include "json2doc/json2doc.h"
 #include "json2doc/converter.h"
 #include "json2doc/help.h"
@@ -12,12 +10,9 @@ int main(int argc, char *argv[])
 {
     // Variable declarations (hoisting)
     json2doc::Json2Doc converter;
-    std::string jsonData;
     std::string templatePath;
     std::string jsonFilePath;
     std::string result;
-    std::ifstream jsonFile;
-    std::stringstream buffer;
 
     // Parse arguments
     json2doc::ArgsParser args(argc, argv);
@@ -74,22 +69,17 @@ int main(int argc, char *argv[])
     // Display version
     std::cout << "📦 Version: " << converter.getVersion() << "\n\n";
 
-    // Read JSON file
+    // Map JSON file (no copy of the raw text)
     std::cout << "📂 Reading JSON file: " << jsonFilePath << "\n";
-    jsonFile.open(jsonFilePath);
-    if (!jsonFile.is_open())
+    if (!converter.loadJsonFile(jsonFilePath))
     {
         std::cerr << "✗ Failed to open JSON file: " << jsonFilePath << "\n";
         return 1;
     }
-
-    buffer << jsonFile.rdbuf();
-    jsonData = buffer.str();
-    jsonFile.close();
     std::cout << "✓ JSON file loaded\n";
 
     // Validate JSON
-    if (json2doc::Converter::isValidJson(jsonData))
+    if (json2doc::Converter::isValidJson(converter.getJsonData()))
     {
         std::cout << "✓ JSON is valid\n";
     }
@@ -98,17 +88,7 @@ int main(int argc, char *argv[])
         std::cerr << "✗ JSON is invalid\n";
         return 1;
     }
-
-    // Load JSON data
-    if (converter.loadJson(jsonData))
-    {
-        std::cout << "✓ JSON loaded successfully\n\n";
-    }
-    else
-    {
-        std::cerr << "✗ Failed to load JSON\n";
-        return 1;
-    }
+    std::cout << "✓ JSON loaded successfully\n\n";
 
     // Convert to document
     std::cout << "📄 Template: " << templatePath << "\n";
@@ -0,0 +1,134 @@
+#include "json2doc/arena.h"
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Blocks stop growing geometrically at this size
+        const size_t kMaxGrowthBlock = 1 << 20;
+    } // namespace
+
+    Arena::Arena(size_t blockSize)
+        : current_(0), offset_(0), blockSize_(blockSize)
+    {
+    }
+
+    Arena::Arena(Arena &&other) noexcept
+        : blocks_(std::move(other.blocks_)), current_(other.current_), offset_(other.offset_),
+          blockSize_(other.blockSize_), stats_(other.stats_)
+    {
+        other.blocks_.clear();
+        other.current_ = 0;
+        other.offset_ = 0;
+        other.stats_ = Stats();
+    }
+
+    Arena &Arena::operator=(Arena &&other) noexcept
+    {
+        if (this != &other)
+        {
+            blocks_ = std::move(other.blocks_);
+            current_ = other.current_;
+            offset_ = other.offset_;
+            blockSize_ = other.blockSize_;
+            stats_ = other.stats_;
+            other.blocks_.clear();
+            other.current_ = 0;
+            other.offset_ = 0;
+            other.stats_ = Stats();
+        }
+        return *this;
+    }
+
+    char *Arena::allocate(size_t size, size_t alignment)
+    {
+        stats_.allocations++;
+
+        if (!blocks_.empty())
+        {
+            char *base = blocks_[current_].data.get();
+            size_t aligned = (reinterpret_cast<uintptr_t>(base) + offset_ + alignment - 1) & ~(alignment - 1);
+            size_t start = aligned - reinterpret_cast<uintptr_t>(base);
+            if (start + size <= blocks_[current_].size)
+            {
+                offset_ = start + size;
+                stats_.bytesUsed += size;
+                return base + start;
+            }
+        }
+
+        nextBlock(size + alignment - 1);
+
+        char *base = blocks_[current_].data.get();
+        size_t aligned = (reinterpret_cast<uintptr_t>(base) + alignment - 1) & ~(alignment - 1);
+        size_t start = aligned - reinterpret_cast<uintptr_t>(base);
+        offset_ = start + size;
+        stats_.bytesUsed += size;
+        return base + start;
+    }
+
+    std::string_view Arena::copy(std::string_view text)
+    {
+        char *dest = allocate(text.size());
+        if (!text.empty())
+        {
+            std::memcpy(dest, text.data(), text.size());
+        }
+        return std::string_view(dest, text.size());
+    }
+
+    void Arena::reset()
+    {
+        current_ = 0;
+        offset_ = 0;
+        stats_.bytesUsed = 0;
+        stats_.allocations = 0;
+        stats_.blockAllocations = 0;
+    }
+
+    void Arena::release()
+    {
+        blocks_.clear();
+        current_ = 0;
+        offset_ = 0;
+        stats_ = Stats();
+    }
+
+    Arena::Stats Arena::getStats() const
+    {
+        return stats_;
+    }
+
+    void Arena::nextBlock(size_t minSize)
+    {
+        // Reuse the block retained from a previous fill when it is large enough
+        if (!blocks_.empty() && current_ + 1 < blocks_.size() && blocks_[current_ + 1].size >= minSize)
+        {
+            current_++;
+            offset_ = 0;
+            return;
+        }
+
+        size_t size = blockSize_;
+        if (!blocks_.empty())
+        {
+            size = std::min(kMaxGrowthBlock, std::max(blockSize_, blocks_.back().size * 2));
+        }
+        size = std::max(size, minSize);
+
+        Block block{std::unique_ptr<char[]>(new char[size]), size};
+        size_t position = blocks_.empty() ? 0 : current_ + 1;
+        blocks_.insert(blocks_.begin() + position, std::move(block));
+        current_ = position;
+        offset_ = 0;
+
+        stats_.blocks = blocks_.size();
+        stats_.bytesReserved += size;
+        stats_.blockAllocations++;
+    }
+
+} // namespace json2doc
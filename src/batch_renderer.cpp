@@ -0,0 +1,233 @@
+#include "json2doc/batch_renderer.h"
+#include "json2doc/json_merge.h"
+#include "json2doc/xml_document.h"
+#include "json2doc/output_sink.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <map>
+#include <exception>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Records that may be rendered ahead of the oldest undelivered one, per thread
+        const size_t kRecordsInFlightPerThread = 4;
+    } // namespace
+
+    BatchRenderer::BatchRenderer(size_t threadCount)
+        : threadCount_(threadCount), memoryLimit_(0), loaded_(false), lastError_("")
+    {
+        if (threadCount_ == 0)
+        {
+            threadCount_ = std::thread::hardware_concurrency();
+        }
+        if (threadCount_ == 0)
+        {
+            threadCount_ = 1;
+        }
+    }
+
+    bool BatchRenderer::loadTemplate(const std::string &docxPath)
+    {
+        loaded_ = template_.loadDocx(docxPath) && storeTemplate();
+        lastError_ = template_.getLastError();
+        return loaded_;
+    }
+
+    bool BatchRenderer::loadTemplateString(const std::string &xmlContent)
+    {
+        loaded_ = template_.load(xmlContent) && storeTemplate();
+        lastError_ = template_.getLastError();
+        return loaded_;
+    }
+
+    bool BatchRenderer::storeTemplate()
+    {
+        // Each record parses this text: the template with split placeholders joined
+        XmlDocument doc;
+        MemorySink sink;
+        if (!template_.instantiate(doc) || !doc.save(sink))
+        {
+            templateXml_.clear();
+            return false;
+        }
+        templateXml_ = sink.take();
+        return true;
+    }
+
+    const std::vector<std::string> &BatchRenderer::getTemplateVariables() const
+    {
+        return template_.getVariables();
+    }
+
+    size_t BatchRenderer::render(const RecordSource &source, const ResultSink &sink)
+    {
+        if (!loaded_)
+        {
+            lastError_ = "No template loaded";
+            return 0;
+        }
+
+        const size_t window = threadCount_ * kRecordsInFlightPerThread;
+
+        // Source side: records are numbered in the order the source returns them
+        std::mutex sourceMutex;
+        bool exhausted = false;
+        size_t nextIndex = 0;
+
+        // Sink side: finished results wait here until every earlier one was delivered
+        std::mutex sinkMutex;
+        std::condition_variable deliveredChanged;
+        std::map<size_t, Result> pending;
+        size_t nextToDeliver = 0;
+
+        std::atomic<size_t> succeeded(0);
+
+        // First exception thrown by the source or the sink; it stops every worker
+        std::atomic<bool> stopped(false);
+        std::exception_ptr failure;
+
+        auto run = [&]()
+        {
+            XmlDocument doc;
+            JsonMerge merger;
+            std::string record;
+            doc.setMemoryLimit(memoryLimit_);
+
+            // Fields the template never references are skipped while parsing
+            merger.setRequiredVariables(template_.getVariables());
+
+            while (true)
+            {
+                size_t index;
+                {
+                    std::lock_guard<std::mutex> lock(sourceMutex);
+                    if (stopped || exhausted || !source(record))
+                    {
+                        exhausted = true;
+                        return;
+                    }
+                    index = nextIndex++;
+                }
+
+                {
+                    // Keep the number of undelivered results bounded
+                    std::unique_lock<std::mutex> lock(sinkMutex);
+                    deliveredChanged.wait(lock, [&]()
+                                          { return stopped || index < nextToDeliver + window; });
+                    if (stopped)
+                    {
+                        return;
+                    }
+                }
+
+                Result result;
+                result.index = index;
+                try
+                {
+                    if (!merger.loadJsonString(record))
+                    {
+                        result.error = merger.getLastError();
+                    }
+                    else if (!doc.loadFromString(templateXml_))
+                    {
+                        result.error = doc.getLastError();
+                    }
+                    else
+                    {
+                        result.replaced = merger.mergeIntoXml(doc);
+                        result.output = doc.toString();
+                        result.ok = true;
+                        succeeded++;
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    result.output.clear();
+                    result.error = e.what();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(sinkMutex);
+                    pending.emplace(index, std::move(result));
+                    while (!stopped && !pending.empty() && pending.begin()->first == nextToDeliver)
+                    {
+                        sink(std::move(pending.begin()->second));
+                        pending.erase(pending.begin());
+                        nextToDeliver++;
+                    }
+                }
+                deliveredChanged.notify_all();
+            }
+        };
+
+        auto worker = [&]()
+        {
+            try
+            {
+                run();
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(sinkMutex);
+                    if (!failure)
+                    {
+                        failure = std::current_exception();
+                    }
+                    stopped = true;
+                }
+                deliveredChanged.notify_all();
+            }
+        };
+
+        // The calling thread is one of the workers
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount_; i++)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        if (failure)
+        {
+            lastError_ = "Record source or result sink threw";
+            std::rethrow_exception(failure);
+        }
+        lastError_ = "";
+        return succeeded;
+    }
+
+    std::vector<BatchRenderer::Result> BatchRenderer::renderAll(const std::vector<std::string> &records)
+    {
+        std::vector<Result> results;
+        results.reserve(records.size());
+        render(records.begin(), records.end(), [&results](Result &&result)
+               { results.push_back(std::move(result)); });
+        return results;
+    }
+
+    size_t BatchRenderer::getThreadCount() const
+    {
+        return threadCount_;
+    }
+
+    void BatchRenderer::setMemoryLimit(size_t bytes)
+    {
+        memoryLimit_ = bytes;
+    }
+
+    std::string BatchRenderer::getLastError() const
+    {
+        return lastError_;
+    }
+
+} // namespace json2doc
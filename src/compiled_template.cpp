@@ -0,0 +1,70 @@
+#include "json2doc/compiled_template.h"
+#include "json2doc/key_index.h"
+#include "json2doc/placeholder_scanner.h"
+
+namespace json2doc
+{
+
+    CompiledTemplate::CompiledTemplate()
+        : variableCount_(0)
+    {
+    }
+
+    CompiledTemplate::CompiledTemplate(const std::string &text)
+        : variableCount_(0)
+    {
+        compile(text);
+    }
+
+    void CompiledTemplate::compile(const std::string &text)
+    {
+        text_ = text;
+        segments_.clear();
+        variableCount_ = 0;
+
+        PlaceholderScanner scanner(text_);
+        PlaceholderScanner::Match match;
+
+        size_t literalStart = 0;
+        while (scanner.next(match))
+        {
+            Segment segment;
+            segment.literalOffset = literalStart;
+            segment.literalLength = match.offset - literalStart;
+            segment.placeholderLength = match.placeholder.size();
+            segment.keyOffset = match.name.data() - text_.data();
+            segment.keyLength = match.name.size();
+            segment.keyHash = KeyIndex::hash(match.name);
+            segments_.push_back(segment);
+            variableCount_++;
+
+            literalStart = match.offset + segment.placeholderLength;
+        }
+
+        if (literalStart < text_.size() || segments_.empty())
+        {
+            segments_.push_back(Segment{literalStart, text_.size() - literalStart, 0, 0, 0, 0});
+        }
+    }
+
+    const std::string &CompiledTemplate::getText() const
+    {
+        return text_;
+    }
+
+    const std::vector<CompiledTemplate::Segment> &CompiledTemplate::getSegments() const
+    {
+        return segments_;
+    }
+
+    std::string_view CompiledTemplate::key(const Segment &segment) const
+    {
+        return std::string_view(text_.data() + segment.keyOffset, segment.keyLength);
+    }
+
+    size_t CompiledTemplate::getVariableCount() const
+    {
+        return variableCount_;
+    }
+
+} // namespace json2doc
@@ -7,15 +7,15 @@ std::string Converter::jsonToString(const std::string& json) {
     return "Formatted: " + json;
 }
 
-bool Converter::isValidJson(const std::string& json) {
+bool Converter::isValidJson(std::string_view json) {
     // Basic validation - to be expanded with proper JSON validation
     if (json.empty()) {
         return false;
     }
     
     // Simple check for basic JSON structure
-    return (json.find('{') != std::string::npos || 
-            json.find('[') != std::string::npos);
+    return (json.find('{') != std::string_view::npos || 
+            json.find('[') != std::string_view::npos);
 }
 
 } // namespace json2doc
@@ -0,0 +1,50 @@
+#include "json2doc/edit_batch.h"
+
+namespace json2doc
+{
+
+    EditBatch::EditBatch()
+    {
+    }
+
+    size_t EditBatch::setText(const std::string &xpath, const std::string &text, Match match)
+    {
+        operations_.push_back(Operation{expressions_.intern(xpath), match, false, "", text});
+        return operations_.size() - 1;
+    }
+
+    size_t EditBatch::setAttribute(const std::string &xpath, const std::string &attributeName, const std::string &value,
+                                   Match match)
+    {
+        operations_.push_back(Operation{expressions_.intern(xpath), match, true, attributeName, value});
+        return operations_.size() - 1;
+    }
+
+    const std::vector<EditBatch::Operation> &EditBatch::getOperations() const
+    {
+        return operations_;
+    }
+
+    const SymbolTable &EditBatch::getExpressions() const
+    {
+        return expressions_;
+    }
+
+    size_t EditBatch::size() const
+    {
+        return operations_.size();
+    }
+
+    bool EditBatch::empty() const
+    {
+        return operations_.empty();
+    }
+
+    void EditBatch::clear()
+    {
+        expressions_.clear();
+        operations_.clear();
+        plan_.reset();
+    }
+
+} // namespace json2doc
@@ -2,7 +2,7 @@
 
 namespace json2doc {
 
-Json2Doc::Json2Doc() : jsonData_("") {
+Json2Doc::Json2Doc() : jsonStorage_(""), jsonData_() {
 }
 
 Json2Doc::~Json2Doc() {
@@ -16,10 +16,27 @@ bool Json2Doc::loadJson(const std::string& jsonData) {
     if (jsonData.empty()) {
         return false;
     }
-    jsonData_ = jsonData;
+    jsonFile_.close();
+    jsonStorage_ = jsonData;
+    jsonData_ = jsonStorage_;
     return true;
 }
 
+bool Json2Doc::loadJsonFile(const std::string& jsonFilePath) {
+    jsonStorage_.clear();
+    jsonData_ = std::string_view();
+    if (!jsonFile_.open(jsonFilePath) || jsonFile_.size() == 0) {
+        jsonFile_.close();
+        return false;
+    }
+    jsonData_ = jsonFile_.view();
+    return true;
+}
+
+std::string_view Json2Doc::getJsonData() const {
+    return jsonData_;
+}
+
 std::string Json2Doc::convertToDocument(const std::string& templatePath) {
     // Basic implementation - to be expanded
     if (jsonData_.empty()) {
@@ -28,7 +45,7 @@ std::string Json2Doc::convertToDocument(const std::string& templatePath) {
     
     // Placeholder implementation
     return "Document generated from template: " + templatePath + 
-           " with JSON data: " + jsonData_;
+           " with JSON data: " + std::string(jsonData_);
 }
 
 } // namespace json2doc
@@ -1,16 +1,20 @@
 #include "json2doc/json_merge.h"
 #include "json2doc/xml_document.h"
+#include "json2doc/compiled_template.h"
+#include "json2doc/placeholder_scanner.h"
 #include <fstream>
-#include <sstream>
+#include <iterator>
 #include <algorithm>
-#include <regex>
+#include <utility>
 #include <cctype>
+#include <cstdio>
+#include <cstring>
 
 namespace json2doc
 {
 
     JsonMerge::JsonMerge()
-        : lastError_("")
+        : snapshotIndex_(false), lastError_("")
     {
         lastStats_["found"] = 0;
         lastStats_["replaced"] = 0;
@@ -22,40 +26,182 @@ namespace json2doc
         clear();
     }
 
-    bool JsonMerge::loadJson(const std::string &jsonFilePath)
+    JsonMerge::JsonMerge(const JsonMerge &other)
+        : snapshotIndex_(false), lastError_(other.lastError_)
     {
-        std::ifstream file(jsonFilePath);
-        if (!file.is_open())
+        copyFrom(other);
+        std::lock_guard<std::mutex> lock(other.statsMutex_);
+        lastStats_ = other.lastStats_;
+    }
+
+    JsonMerge &JsonMerge::operator=(const JsonMerge &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            copyFrom(other);
+            lastError_ = other.lastError_;
+            std::scoped_lock lock(statsMutex_, other.statsMutex_);
+            lastStats_ = other.lastStats_;
+        }
+        return *this;
+    }
+
+    JsonMerge::JsonMerge(JsonMerge &&other) noexcept
+        : mappedSource_(std::move(other.mappedSource_)), arena_(std::move(other.arena_)), source_(other.source_),
+          patches_(std::move(other.patches_)), snapshot_(std::move(other.snapshot_)),
+          snapshotIndex_(other.snapshotIndex_), jsonData_(std::move(other.jsonData_)), tree_(std::move(other.tree_)),
+          entryNodes_(std::move(other.entryNodes_)), parser_(std::move(other.parser_)),
+          requiredVariables_(std::move(other.requiredVariables_)), lastError_(std::move(other.lastError_)),
+          lastStats_(std::move(other.lastStats_))
+    {
+        // Mappings and arena blocks keep their addresses, so every slice stays valid.
+        // The moved parser keeps its selection flag, so drop it like the names
+        other.parser_.setRequiredKeys({});
+        other.clear();
+    }
+
+    JsonMerge &JsonMerge::operator=(JsonMerge &&other) noexcept
+    {
+        if (this != &other)
+        {
+            mappedSource_ = std::move(other.mappedSource_);
+            arena_ = std::move(other.arena_);
+            source_ = other.source_;
+            patches_ = std::move(other.patches_);
+            snapshot_ = std::move(other.snapshot_);
+            snapshotIndex_ = other.snapshotIndex_;
+            jsonData_ = std::move(other.jsonData_);
+            tree_ = std::move(other.tree_);
+            entryNodes_ = std::move(other.entryNodes_);
+            parser_ = std::move(other.parser_);
+            requiredVariables_ = std::move(other.requiredVariables_);
+            lastError_ = std::move(other.lastError_);
+            lastStats_ = std::move(other.lastStats_);
+            other.parser_.setRequiredKeys({});
+            other.clear();
+        }
+        return *this;
+    }
+
+    bool JsonMerge::loadJson(const std::string &jsonFilePath, LoadMode mode)
+    {
+        clear();
+
+        if (mode == LoadMode::Mapped)
+        {
+            if (mappedSource_.open(jsonFilePath))
+            {
+                source_ = mappedSource_.view();
+                return parseJson(source_.data(), source_.size());
+            }
+            // Pipes and other special files cannot be mapped: read them instead
+        }
+
+        if (!readSource(jsonFilePath))
         {
             lastError_ = "Cannot open file: " + jsonFilePath;
             return false;
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        file.close();
-
-        return loadJsonString(buffer.str());
+        return parseJson(source_.data(), source_.size());
     }
 
     bool JsonMerge::loadJsonString(const std::string &jsonString)
     {
         clear();
-        return parseJson(jsonString);
+        source_ = arena_.copy(jsonString);
+        return parseJson(source_.data(), source_.size());
+    }
+
+    bool JsonMerge::saveSnapshot(const std::string &snapshotPath)
+    {
+        if (snapshotIndex_)
+        {
+            // Still the loaded snapshot: copy it as is
+            std::string tempPath = snapshotPath + ".tmp";
+            std::string_view bytes = snapshot_.bytes();
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(bytes.data(), bytes.size());
+            file.close();
+            if (!file.good() || std::rename(tempPath.c_str(), snapshotPath.c_str()) != 0)
+            {
+                std::remove(tempPath.c_str());
+                lastError_ = "Cannot write snapshot: " + snapshotPath;
+                return false;
+            }
+            return true;
+        }
+
+        std::vector<std::string_view> regions{source_};
+        regions.insert(regions.end(), patches_.begin(), patches_.end());
+        if (snapshot_.isOpen())
+        {
+            regions.push_back(snapshot_.strings());
+        }
+
+        std::string error;
+        if (!JsonSnapshot::write(snapshotPath, jsonData_, entryNodes_, tree_, regions, error))
+        {
+            lastError_ = error;
+            return false;
+        }
+        return true;
+    }
+
+    bool JsonMerge::loadSnapshot(const std::string &snapshotPath)
+    {
+        clear();
+
+        if (!snapshot_.open(snapshotPath))
+        {
+            lastError_ = snapshot_.getLastError();
+            return false;
+        }
+        if (!snapshot_.loadTree(tree_))
+        {
+            clear();
+            lastError_ = "Corrupt snapshot: tree: " + snapshotPath;
+            return false;
+        }
+
+        snapshotIndex_ = true;
+        return true;
+    }
+
+    void JsonMerge::setRequiredVariables(const std::vector<std::string> &variables)
+    {
+        requiredVariables_.clear();
+        for (const auto &variable : variables)
+        {
+            std::string name = trim(variable);
+            if (!name.empty() && (name[0] == '#' || name[0] == '/'))
+            {
+                // A section needs its whole array
+                name = trim(name.substr(1));
+            }
+            if (!name.empty())
+            {
+                requiredVariables_.push_back(name);
+            }
+        }
+        parser_.setRequiredKeys(requiredVariables_);
+    }
+
+    std::vector<std::string> JsonMerge::getRequiredVariables() const
+    {
+        return requiredVariables_;
     }
 
     std::vector<std::string> JsonMerge::findVariables(const std::string &text) const
     {
         std::vector<std::string> variables;
-        std::regex varRegex(R"(\{\{([^}]+)\}\})");
-        std::smatch match;
+        PlaceholderScanner scanner(text);
+        PlaceholderScanner::Match match;
 
-        std::string::const_iterator searchStart(text.cbegin());
-        while (std::regex_search(searchStart, text.cend(), match, varRegex))
+        while (scanner.next(match))
         {
-            std::string varName = trim(match[1].str());
-            variables.push_back(varName);
-            searchStart = match.suffix().first;
+            variables.push_back(std::string(match.name));
         }
 
         return variables;
@@ -63,93 +209,292 @@ namespace json2doc
 
     std::string JsonMerge::replaceVariables(const std::string &text) const
     {
-        lastStats_["found"] = 0;
-        lastStats_["replaced"] = 0;
-        lastStats_["missing"] = 0;
+        MergeStats stats;
+        std::string result = replaceVariables(text, stats);
+        recordStats(stats);
+        return result;
+    }
 
-        std::string result = text;
-        std::regex varRegex(R"(\{\{([^}]+)\}\})");
-        std::smatch match;
+    std::string JsonMerge::replaceVariables(const std::string &text, MergeStats &stats) const
+    {
+        stats = MergeStats();
 
-        std::string::const_iterator searchStart(result.cbegin());
-        std::vector<std::pair<size_t, size_t>> replacements;
-        std::vector<std::string> values;
+        std::string result;
+        PlaceholderScanner scanner(text);
+        PlaceholderScanner::Match match;
+        size_t copied = 0;
 
-        // Find all matches first
-        while (std::regex_search(searchStart, result.cend(), match, varRegex))
+        while (scanner.next(match))
         {
-            lastStats_["found"]++;
+            stats.found++;
 
-            std::string varName = trim(match[1].str());
-            std::string value = getValue(varName);
-
-            size_t pos = std::distance(result.cbegin(), match[0].first);
-            size_t len = match[0].length();
+            std::string_view value;
+            lookup(match.name, value);
 
             if (!value.empty())
             {
-                lastStats_["replaced"]++;
-                replacements.push_back({pos, len});
-                values.push_back(value);
+                stats.replaced++;
+                result.append(text, copied, match.offset - copied);
+                result.append(value);
+                copied = match.offset + match.placeholder.size();
             }
             else
             {
-                lastStats_["missing"]++;
+                stats.missing++;
             }
+        }
+
+        result.append(text, copied, std::string::npos);
+        return result;
+    }
+
+    std::string JsonMerge::replaceVariables(const CompiledTemplate &tmpl) const
+    {
+        MergeStats stats;
+        std::string result = replaceVariables(tmpl, stats);
+        recordStats(stats);
+        return result;
+    }
 
-            searchStart = match.suffix().first;
+    std::string JsonMerge::replaceVariables(const CompiledTemplate &tmpl, MergeStats &stats) const
+    {
+        const std::string &text = tmpl.getText();
+        const auto &segments = tmpl.getSegments();
+
+        int found = 0;
+        int replaced = 0;
+        int missing = 0;
+
+        // Resolve every slot first so the output is allocated once at its final size
+        std::vector<std::string_view> values(segments.size());
+        size_t outputSize = 0;
+        for (size_t i = 0; i < segments.size(); i++)
+        {
+            const CompiledTemplate::Segment &segment = segments[i];
+            outputSize += segment.literalLength;
+            if (segment.placeholderLength == 0)
+            {
+                continue;
+            }
+
+            found++;
+            lookup(tmpl.key(segment), segment.keyHash, values[i]);
+            if (!values[i].empty())
+            {
+                replaced++;
+                outputSize += values[i].size();
+            }
+            else
+            {
+                missing++;
+                outputSize += segment.placeholderLength;
+            }
         }
 
-        // Replace from end to beginning to maintain positions
-        for (int i = replacements.size() - 1; i >= 0; i--)
+        std::string result;
+        result.reserve(outputSize);
+        for (size_t i = 0; i < segments.size(); i++)
         {
-            result.replace(replacements[i].first, replacements[i].second, values[i]);
+            const CompiledTemplate::Segment &segment = segments[i];
+            result.append(text, segment.literalOffset, segment.literalLength);
+            if (segment.placeholderLength == 0)
+            {
+                continue;
+            }
+
+            if (!values[i].empty())
+            {
+                result.append(values[i]);
+            }
+            else
+            {
+                result.append(text, segment.literalOffset + segment.literalLength, segment.placeholderLength);
+            }
         }
 
+        stats.found = found;
+        stats.replaced = replaced;
+        stats.missing = missing;
         return result;
     }
 
     std::string JsonMerge::getValue(const std::string &key) const
     {
-        std::string cleanKey = trim(key);
+        std::string_view value;
+        lookup(key, value);
+        return std::string(value);
+    }
 
-        // Direct lookup
-        auto it = jsonData_.find(cleanKey);
-        if (it != jsonData_.end())
+    JsonValue JsonMerge::getJsonValue(const std::string &key) const
+    {
+        std::string name = trim(key);
+        std::string_view value;
+        uint32_t node = JsonTree::npos;
+        if (findEntry(name, KeyIndex::hash(name), value, node))
         {
-            return it->second;
+            return tree_.getValue(node);
         }
 
-        // Try nested lookup with dot notation
-        size_t dotPos = cleanKey.find('.');
-        if (dotPos != std::string::npos)
+        node = findElement(name);
+        if (node != JsonTree::npos)
         {
-            std::string prefix = cleanKey.substr(0, dotPos);
-            std::string suffix = cleanKey.substr(dotPos + 1);
+            return tree_.getValue(node);
+        }
+        return tree_.getRoot().find(name);
+    }
 
-            // Look for the nested key
-            it = jsonData_.find(cleanKey);
-            if (it != jsonData_.end())
+    JsonValue JsonMerge::getRoot() const
+    {
+        return tree_.getRoot();
+    }
+
+    size_t JsonMerge::bindSymbols(const SymbolTable &symbols, SymbolValues &values) const
+    {
+        values.reset(symbols.size());
+        for (uint32_t id = 0; id < symbols.size(); id++)
+        {
+            std::string_view value;
+            if (lookup(symbols.name(id), value))
             {
-                return it->second;
+                values.set(id, value);
             }
         }
+        return values.boundCount();
+    }
 
-        return "";
+    std::vector<std::string> JsonMerge::applyPatch(const std::string &patchJson)
+    {
+        std::vector<std::string> changed;
+
+        struct Update
+        {
+            std::string key;
+            std::string_view value;
+        };
+
+        // Parse everything before touching the loaded data
+        std::string_view patch = arena_.copy(patchJson);
+        JsonTree patchTree;
+        std::vector<Update> updates;
+        bool ok = parser_.parse(patch.data(), patch.size(), patchTree,
+                                [&updates](const std::string &key, const char *value, size_t length, uint32_t)
+                                { updates.push_back(Update{key, std::string_view(value, length)}); });
+        if (!ok)
+        {
+            lastError_ = "JSON patch parse error: " + parser_.getLastError();
+            return changed;
+        }
+
+        if (snapshotIndex_)
+        {
+            materializeSnapshot();
+        }
+
+        // Keys left under a replaced value, unless the patch sets them again
+        std::vector<std::string> replaced = replacedPaths(patchTree);
+        if (!replaced.empty())
+        {
+            KeyIndex patched;
+            Arena patchedKeys;
+            for (const auto &update : updates)
+            {
+                patched.insert(update.key, std::string_view(), patchedKeys);
+            }
+
+            const auto &entries = jsonData_.entries();
+            std::vector<bool> stale(entries.size(), false);
+            for (size_t e = 0; e < entries.size(); e++)
+            {
+                std::string_view key = entries[e].key;
+                for (const auto &path : replaced)
+                {
+                    bool below = key.compare(0, path.size(), path) == 0 &&
+                                 (key.size() == path.size() || key[path.size()] == '.');
+                    if (below && patched.find(key) == nullptr)
+                    {
+                        stale[e] = true;
+                        changed.emplace_back(key);
+                        break;
+                    }
+                }
+            }
+
+            if (!changed.empty())
+            {
+                size_t kept = 0;
+                for (size_t e = 0; e < entryNodes_.size(); e++)
+                {
+                    if (!stale[e])
+                    {
+                        entryNodes_[kept++] = entryNodes_[e];
+                    }
+                }
+                entryNodes_.resize(kept);
+                jsonData_.erase(stale);
+            }
+        }
+
+        for (const auto &update : updates)
+        {
+            const KeyIndex::Entry *entry = jsonData_.find(update.key);
+            if (entry != nullptr && entry->value == update.value)
+            {
+                continue;
+            }
+
+            size_t index = jsonData_.insert(update.key, update.value, arena_);
+            if (index == entryNodes_.size())
+            {
+                entryNodes_.push_back(JsonTree::npos);
+            }
+            changed.push_back(update.key);
+        }
+
+        if (changed.empty())
+        {
+            return changed;
+        }
+
+        patches_.push_back(patch);
+        mergeTree(patchTree);
+        for (const auto &key : changed)
+        {
+            const KeyIndex::Entry *entry = jsonData_.find(key);
+            if (entry != nullptr) // Removed keys are reported too
+            {
+                entryNodes_[entry - jsonData_.entries().data()] = tree_.find(0, key);
+            }
+        }
+
+        return changed;
     }
 
     bool JsonMerge::hasKey(const std::string &key) const
     {
-        return !getValue(key).empty();
+        std::string_view value;
+        return lookup(key, value) && !value.empty();
     }
 
     std::vector<std::string> JsonMerge::getAllKeys() const
     {
         std::vector<std::string> keys;
-        for (const auto &pair : jsonData_)
+        if (snapshotIndex_)
         {
-            keys.push_back(pair.first);
+            keys.reserve(snapshot_.size());
+            for (size_t i = 0; i < snapshot_.size(); i++)
+            {
+                keys.push_back(std::string(snapshot_.key(i)));
+            }
         }
+        else
+        {
+            keys.reserve(jsonData_.size());
+            for (const auto &entry : jsonData_.entries())
+            {
+                keys.push_back(std::string(entry.key));
+            }
+        }
+        std::sort(keys.begin(), keys.end());
         return keys;
     }
 
@@ -160,181 +505,329 @@ namespace json2doc
 
     std::map<std::string, int> JsonMerge::getStats() const
     {
+        std::lock_guard<std::mutex> lock(statsMutex_);
         return lastStats_;
     }
 
+    void JsonMerge::recordStats(const MergeStats &stats) const
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        lastStats_["found"] = stats.found;
+        lastStats_["replaced"] = stats.replaced;
+        lastStats_["missing"] = stats.missing;
+    }
+
+    Arena::Stats JsonMerge::getLoadStats() const
+    {
+        return arena_.getStats();
+    }
+
     void JsonMerge::clear()
     {
         jsonData_.clear();
+        tree_.clear();
+        entryNodes_.clear();
+        snapshot_.close();
+        snapshotIndex_ = false;
+        mappedSource_.close();
+        arena_.reset();
+        source_ = std::string_view();
+        patches_.clear();
         lastError_ = "";
-        lastStats_["found"] = 0;
-        lastStats_["replaced"] = 0;
-        lastStats_["missing"] = 0;
+        recordStats(MergeStats());
     }
 
-    bool JsonMerge::parseJson(const std::string &jsonString)
+    bool JsonMerge::parseJson(const char *data, size_t size)
     {
-        try
+        bool ok = parser_.parse(data, size, tree_, [this](const std::string &key, const char *value, size_t length, uint32_t node)
+                                {
+                                    size_t entry = jsonData_.insert(key, std::string_view(value, length), arena_);
+                                    if (entry == entryNodes_.size())
+                                    {
+                                        entryNodes_.push_back(node);
+                                    }
+                                    else
+                                    {
+                                        entryNodes_[entry] = node;
+                                    } });
+
+        if (!ok)
         {
-            parseNestedJson(jsonString, "");
-            return true;
+            lastError_ = "JSON parse error: " + parser_.getLastError();
+            return false;
         }
-        catch (const std::exception &e)
+
+        return true;
+    }
+
+    bool JsonMerge::readSource(const std::string &jsonFilePath)
+    {
+        std::ifstream file(jsonFilePath, std::ios::binary);
+        if (!file.is_open())
         {
-            lastError_ = std::string("JSON parse error: ") + e.what();
             return false;
         }
+
+        // Read straight into the arena in one go when the size is known
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        if (size >= 0)
+        {
+            char *buffer = arena_.allocate(static_cast<size_t>(size));
+            file.seekg(0, std::ios::beg);
+            file.read(buffer, size);
+            source_ = std::string_view(buffer, static_cast<size_t>(file.gcount()));
+        }
+        else
+        {
+            file.clear();
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            source_ = arena_.copy(text);
+        }
+
+        return true;
     }
 
-    void JsonMerge::parseNestedJson(const std::string &jsonString, const std::string &prefix)
+    void JsonMerge::copyFrom(const JsonMerge &other)
     {
-        std::string cleaned = trim(jsonString);
-        if (cleaned.empty() || cleaned.front() != '{')
+        requiredVariables_ = other.requiredVariables_;
+        parser_.setRequiredKeys(requiredVariables_);
+
+        const char *otherBase = other.source_.data();
+        source_ = arena_.copy(other.source_);
+        for (std::string_view patch : other.patches_)
         {
-            return;
+            patches_.push_back(arena_.copy(patch));
+        }
+        if (other.snapshot_.isOpen())
+        {
+            // The copy outlives other's mapping, so it keeps its own image
+            std::string_view bytes = other.snapshot_.bytes();
+            char *image = arena_.allocate(bytes.size(), 8);
+            std::memcpy(image, bytes.data(), bytes.size());
+            snapshot_.attach(image, bytes.size());
         }
+        snapshotIndex_ = other.snapshotIndex_;
 
-        size_t pos = 1; // Skip opening {
-        while (pos < cleaned.length())
+        // Values are slices of the source, of one of the patches or of the snapshot
+        auto relocate = [&](std::string_view slice)
         {
-            // Skip whitespace
-            while (pos < cleaned.length() && std::isspace(cleaned[pos]))
-            {
-                pos++;
-            }
+            auto inside = [slice](std::string_view text)
+            { return slice.data() >= text.data() && slice.data() + slice.size() <= text.data() + text.size(); };
 
-            if (pos >= cleaned.length() || cleaned[pos] == '}')
+            if (inside(other.source_))
             {
-                break;
+                return std::string_view(source_.data() + (slice.data() - otherBase), slice.size());
             }
-
-            // Find key
-            if (cleaned[pos] != '"')
+            for (size_t i = 0; i < patches_.size(); i++)
             {
-                pos++;
-                continue;
+                if (inside(other.patches_[i]))
+                {
+                    return std::string_view(patches_[i].data() + (slice.data() - other.patches_[i].data()), slice.size());
+                }
             }
-
-            size_t keyStart = pos + 1;
-            size_t keyEnd = cleaned.find('"', keyStart);
-            if (keyEnd == std::string::npos)
+            if (inside(other.snapshot_.strings()))
             {
-                break;
+                return std::string_view(snapshot_.strings().data() + (slice.data() - other.snapshot_.strings().data()),
+                                        slice.size());
             }
+            return slice;
+        };
 
-            std::string key = cleaned.substr(keyStart, keyEnd - keyStart);
-            pos = keyEnd + 1;
+        jsonData_.reserve(other.jsonData_.size());
+        for (const auto &entry : other.jsonData_.entries())
+        {
+            jsonData_.insert(entry.key, relocate(entry.value), entry.hash, arena_);
+        }
 
-            // Skip to colon
-            while (pos < cleaned.length() && cleaned[pos] != ':')
-            {
-                pos++;
-            }
-            pos++; // Skip colon
+        tree_ = other.tree_;
+        tree_.rebase(otherBase, source_.size(), source_.data());
+        for (size_t i = 0; i < patches_.size(); i++)
+        {
+            tree_.rebase(other.patches_[i].data(), patches_[i].size(), patches_[i].data());
+        }
+        tree_.rebase(other.snapshot_.strings().data(), snapshot_.strings().size(), snapshot_.strings().data());
+        entryNodes_ = other.entryNodes_;
+    }
+
+    bool JsonMerge::lookup(std::string_view key, std::string_view &value) const
+    {
+        while (!key.empty() && std::isspace(static_cast<unsigned char>(key.front())))
+        {
+            key.remove_prefix(1);
+        }
+        while (!key.empty() && std::isspace(static_cast<unsigned char>(key.back())))
+        {
+            key.remove_suffix(1);
+        }
+
+        return lookup(key, KeyIndex::hash(key), value);
+    }
+
+    bool JsonMerge::lookup(std::string_view key, uint64_t keyHash, std::string_view &value) const
+    {
+        uint32_t node = JsonTree::npos;
+        if (findEntry(key, keyHash, value, node))
+        {
+            return true;
+        }
+
+        node = findElement(key);
+        value = node != JsonTree::npos ? tree_.getNode(node).text : std::string_view();
+        return node != JsonTree::npos;
+    }
 
-            // Skip whitespace
-            while (pos < cleaned.length() && std::isspace(cleaned[pos]))
+    bool JsonMerge::findEntry(std::string_view key, uint64_t keyHash, std::string_view &value, uint32_t &node) const
+    {
+        if (snapshotIndex_)
+        {
+            size_t entry = 0;
+            if (!snapshot_.find(key, keyHash, entry))
             {
-                pos++;
+                return false;
             }
+            value = snapshot_.value(entry);
+            node = snapshot_.node(entry);
+            return true;
+        }
+
+        const KeyIndex::Entry *entry = jsonData_.find(key, keyHash);
+        if (entry == nullptr)
+        {
+            return false;
+        }
+        value = entry->value;
+        node = entryNodes_[entry - jsonData_.entries().data()];
+        return true;
+    }
+
+    void JsonMerge::materializeSnapshot()
+    {
+        // Keys are copied, values and the tree keep pointing into the snapshot
+        jsonData_.reserve(snapshot_.size());
+        entryNodes_.reserve(snapshot_.size());
+        for (size_t i = 0; i < snapshot_.size(); i++)
+        {
+            jsonData_.insert(snapshot_.key(i), snapshot_.value(i), arena_);
+            entryNodes_.push_back(snapshot_.node(i));
+        }
+        snapshotIndex_ = false;
+    }
+
+    void JsonMerge::mergeTree(const JsonTree &patch)
+    {
+        if (patch.empty())
+        {
+            return;
+        }
+        if (tree_.empty())
+        {
+            tree_.graft(patch, 0);
+            return;
+        }
 
-            // Determine value type and extract
-            std::string fullKey = prefix.empty() ? key : prefix + "." + key;
+        // (node in tree_, node in patch) pairs of objects to merge
+        std::vector<std::pair<uint32_t, uint32_t>> pending{{0, 0}};
+        while (!pending.empty())
+        {
+            auto [target, source] = pending.back();
+            pending.pop_back();
 
-            if (cleaned[pos] == '"')
+            size_t count = patch.getNode(source).count;
+            for (size_t i = 0; i < count; i++)
             {
-                // String value
-                size_t valueStart = pos + 1;
-                size_t valueEnd = cleaned.find('"', valueStart);
-                if (valueEnd != std::string::npos)
+                uint32_t member = patch.child(source, i);
+                const JsonTree::Node &from = patch.getNode(member);
+                uint32_t existing = tree_.member(target, from.key);
+
+                if (existing != JsonTree::npos && from.type == JsonType::Object &&
+                    tree_.getNode(existing).type == JsonType::Object)
                 {
-                    std::string value = cleaned.substr(valueStart, valueEnd - valueStart);
-                    jsonData_[fullKey] = value;
-                    pos = valueEnd + 1;
+                    pending.emplace_back(existing, member);
+                    continue;
                 }
-            }
-            else if (cleaned[pos] == '{')
-            {
-                // Nested object
-                std::string obj = extractObject(cleaned, pos);
-                parseNestedJson(obj, fullKey);
-                pos += obj.length() + 1;
-            }
-            else if (cleaned[pos] == '[')
-            {
-                // Array
-                std::string arr = extractArray(cleaned, pos);
-                jsonData_[fullKey] = arr;
-                pos += arr.length() + 1;
-            }
-            else
-            {
-                // Number, boolean, or null
-                size_t valueStart = pos;
-                while (pos < cleaned.length() && cleaned[pos] != ',' && cleaned[pos] != '}' && cleaned[pos] != ']')
+
+                uint32_t copy = tree_.graft(patch, member);
+                if (existing != JsonTree::npos)
                 {
-                    pos++;
+                    // Overwrite in place so the parent keeps pointing at it
+                    tree_.getNode(existing) = tree_.getNode(copy);
+                }
+                else
+                {
+                    tree_.appendChild(target, copy);
                 }
-                std::string value = trim(cleaned.substr(valueStart, pos - valueStart));
-                jsonData_[fullKey] = value;
-            }
-
-            // Skip to next element
-            while (pos < cleaned.length() && (cleaned[pos] == ',' || std::isspace(cleaned[pos])))
-            {
-                pos++;
             }
         }
     }
 
-    std::string JsonMerge::extractObject(const std::string &jsonString, size_t startPos) const
+    std::vector<std::string> JsonMerge::replacedPaths(const JsonTree &patch) const
     {
-        int braceCount = 0;
-        size_t pos = startPos;
+        std::vector<std::string> paths;
+        if (patch.empty() || tree_.empty())
+        {
+            return paths;
+        }
 
-        while (pos < jsonString.length())
+        // Same walk as mergeTree(), with the dot path of each pair of objects
+        std::vector<std::pair<std::pair<uint32_t, uint32_t>, std::string>> pending;
+        pending.push_back({{0, 0}, std::string()});
+        while (!pending.empty())
         {
-            if (jsonString[pos] == '{')
-            {
-                braceCount++;
-            }
-            else if (jsonString[pos] == '}')
+            auto [nodes, prefix] = std::move(pending.back());
+            pending.pop_back();
+
+            size_t count = patch.getNode(nodes.second).count;
+            for (size_t i = 0; i < count; i++)
             {
-                braceCount--;
-                if (braceCount == 0)
+                uint32_t member = patch.child(nodes.second, i);
+                const JsonTree::Node &from = patch.getNode(member);
+                uint32_t existing = tree_.member(nodes.first, from.key);
+                if (existing == JsonTree::npos)
+                {
+                    continue;
+                }
+
+                std::string path = prefix.empty() ? std::string(from.key) : prefix + "." + std::string(from.key);
+                if (from.type == JsonType::Object && tree_.getNode(existing).type == JsonType::Object)
+                {
+                    pending.push_back({{existing, member}, std::move(path)});
+                }
+                else
                 {
-                    return jsonString.substr(startPos, pos - startPos + 1);
+                    paths.push_back(std::move(path));
                 }
             }
-            pos++;
         }
-
-        return "";
+        return paths;
     }
 
-    std::string JsonMerge::extractArray(const std::string &jsonString, size_t startPos) const
+    uint32_t JsonMerge::findElement(std::string_view key) const
     {
-        int bracketCount = 0;
-        size_t pos = startPos;
-
-        while (pos < jsonString.length())
+        // Array elements are not flattened: find an array among the prefixes
+        // that end before a numeric segment, then index into it
+        for (size_t dot = key.find('.'); dot != std::string_view::npos; dot = key.find('.', dot + 1))
         {
-            if (jsonString[pos] == '[')
+            if (dot + 1 >= key.size() || key[dot + 1] < '0' || key[dot + 1] > '9')
             {
-                bracketCount++;
+                continue;
             }
-            else if (jsonString[pos] == ']')
+
+            std::string_view prefix = key.substr(0, dot);
+            uint32_t array = JsonTree::npos;
+            std::string_view value;
+            if (!findEntry(prefix, KeyIndex::hash(prefix), value, array) && parser_.hasRequiredKeys())
             {
-                bracketCount--;
-                if (bracketCount == 0)
-                {
-                    return jsonString.substr(startPos, pos - startPos + 1);
-                }
+                // Arrays only reached through an index are not in jsonData_
+                array = tree_.getRoot().find(prefix).getNode();
             }
-            pos++;
-        }
 
-        return "";
+            if (array != JsonTree::npos && tree_.getNode(array).type == JsonType::Array)
+            {
+                return tree_.find(array, key.substr(dot + 1));
+            }
+        }
+        return JsonTree::npos;
     }
 
     std::string JsonMerge::trim(const std::string &str) const
@@ -374,13 +867,93 @@ namespace json2doc
     // ========== XML-based methods implementation ==========
 
     int JsonMerge::mergeIntoXml(XmlDocument &xmlDoc) const
+    {
+        MergeStats stats;
+        int replaced = mergeIntoXml(xmlDoc, stats);
+        recordStats(stats);
+        return replaced;
+    }
+
+    int JsonMerge::mergeIntoXml(XmlDocument &xmlDoc, MergeStats &stats) const
+    {
+        stats = MergeStats();
+        if (!xmlDoc.isValid())
+        {
+            return 0;
+        }
+
+        expandSectionsInXml(xmlDoc);
+
+        // One lookup per distinct placeholder name, then array reads
+        SymbolValues values;
+        bindSymbols(xmlDoc.getSymbols(), values);
+        stats.found = static_cast<int>(xmlDoc.getPlaceholderCount());
+        stats.replaced = xmlDoc.replaceVariables(values);
+        stats.missing = stats.found - stats.replaced;
+        return stats.replaced;
+    }
+
+    int JsonMerge::bindToXml(XmlDocument &xmlDoc) const
     {
         if (!xmlDoc.isValid())
         {
             return 0;
         }
 
-        return xmlDoc.replaceVariables(jsonData_);
+        expandSectionsInXml(xmlDoc);
+
+        SymbolValues values;
+        bindSymbols(xmlDoc.getSymbols(), values);
+        return xmlDoc.bindVariables(values);
+    }
+
+    int JsonMerge::updateXml(XmlDocument &xmlDoc, const std::vector<std::string> &changedKeys,
+                             std::vector<std::string> *changedPaths) const
+    {
+        if (!xmlDoc.isBound())
+        {
+            return -1;
+        }
+
+        // "a.b" and "a.b.c" affect each other, "a.b" and "a.bc" do not
+        auto related = [](std::string_view a, std::string_view b)
+        {
+            if (a.size() > b.size())
+            {
+                std::swap(a, b);
+            }
+            return b.compare(0, a.size(), a) == 0 && (b.size() == a.size() || b[a.size()] == '.');
+        };
+
+        const SymbolTable &symbols = xmlDoc.getSymbols();
+        std::vector<uint32_t> changed;
+        for (uint32_t id = 0; id < symbols.size(); id++)
+        {
+            std::string_view name = symbols.name(id);
+            for (const auto &key : changedKeys)
+            {
+                if (related(name, key))
+                {
+                    changed.push_back(id);
+                    break;
+                }
+            }
+        }
+
+        return xmlDoc.updateVariables(changed, [this](std::string_view name, std::string_view &value)
+                                      { return lookup(name, value); }, changedPaths);
+    }
+
+    void JsonMerge::expandSectionsInXml(XmlDocument &xmlDoc) const
+    {
+        // Repeat {{#array}}...{{/array}} blocks first; their copies refer to
+        // the elements by index ({{array.0.field}})
+        xmlDoc.expandSections([this](std::string_view name)
+                              {
+                                  JsonValue section = getJsonValue(std::string(name));
+                                  return section.isArray() ? section.size() : 0; },
+                              [this](std::string_view name, std::string_view &value)
+                              { return lookup(name, value); });
     }
 
     std::vector<std::string> JsonMerge::findTemplateNodesInXml(const XmlDocument &xmlDoc) const
@@ -409,12 +982,26 @@ namespace json2doc
         }
 
         // Use XmlDocument's built-in variable replacement
-        return xmlDoc.replaceVariables(jsonData_);
+        return xmlDoc.replaceVariables([this](std::string_view name, std::string_view &value)
+                                       { return lookup(name, value); });
     }
 
     std::map<std::string, std::string> JsonMerge::getVariableMap() const
     {
-        return jsonData_;
+        std::map<std::string, std::string> variables;
+        if (snapshotIndex_)
+        {
+            for (size_t i = 0; i < snapshot_.size(); i++)
+            {
+                variables[std::string(snapshot_.key(i))] = std::string(snapshot_.value(i));
+            }
+            return variables;
+        }
+        for (const auto &entry : jsonData_.entries())
+        {
+            variables[std::string(entry.key)] = std::string(entry.value);
+        }
+        return variables;
     }
 
 } // namespace json2doc
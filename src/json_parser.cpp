@@ -0,0 +1,413 @@
+#include "json2doc/json_parser.h"
+#include "json2doc/structural_index.h"
+
+namespace json2doc
+{
+
+    namespace
+    {
+        inline bool isJsonSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        // True when text[from, to) is only whitespace: the gap between two
+        // structural characters around a key, string or container
+        inline bool onlyJsonSpace(const char *text, size_t from, size_t to)
+        {
+            for (size_t i = from; i < to; i++)
+            {
+                if (!isJsonSpace(text[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Type of a bare literal; numbers are only classified, not converted
+        JsonType literalType(const char *text, size_t length)
+        {
+            std::string_view literal(text, length);
+            if (literal == "true" || literal == "false")
+            {
+                return JsonType::Bool;
+            }
+            if (literal == "null")
+            {
+                return JsonType::Null;
+            }
+            if (literal[0] != '-' && literal[0] != '+' && (literal[0] < '0' || literal[0] > '9'))
+            {
+                // Not valid JSON, but kept as text like before
+                return JsonType::String;
+            }
+            return literal.find_first_of(".eE") == std::string_view::npos ? JsonType::Int : JsonType::Double;
+        }
+    } // namespace
+
+    JsonParser::JsonParser()
+        : data_(nullptr), size_(0), pos_(0), lastError_(""), filtered_(false)
+    {
+    }
+
+    void JsonParser::setRequiredKeys(const std::vector<std::string> &keys)
+    {
+        requiredKeys_.clear();
+        requiredPrefixes_.clear();
+        requiredStorage_.reset();
+        filtered_ = !keys.empty();
+
+        for (const auto &key : keys)
+        {
+            requiredKeys_.insert(key, std::string_view(), requiredStorage_);
+            for (size_t dot = key.find('.'); dot != std::string::npos; dot = key.find('.', dot + 1))
+            {
+                requiredPrefixes_.insert(std::string_view(key.data(), dot), std::string_view(), requiredStorage_);
+            }
+        }
+    }
+
+    bool JsonParser::hasRequiredKeys() const
+    {
+        return filtered_;
+    }
+
+    bool JsonParser::parse(const std::string &json, const ValueHandler &handler)
+    {
+        return parse(json.data(), json.size(), scratch_, handler);
+    }
+
+    bool JsonParser::parse(const char *data, size_t size, const ValueHandler &handler)
+    {
+        return parse(data, size, scratch_, handler);
+    }
+
+    bool JsonParser::parse(const char *data, size_t size, JsonTree &tree, const ValueHandler &handler)
+    {
+        data_ = data;
+        size_ = size;
+        pos_ = 0;
+        lastError_ = "";
+        stack_.clear();
+        children_.clear();
+        path_.clear();
+        tree.clear();
+
+        while (pos_ < size_ && isJsonSpace(data_[pos_]))
+        {
+            pos_++;
+        }
+        if (pos_ >= size_ || data_[pos_] != '{')
+        {
+            // Nothing to flatten: only objects produce keys
+            return true;
+        }
+
+        StructuralIndex index(data_, size_);
+        index.next(); // the opening brace found above
+        uint32_t root = tree.addNode(JsonType::Object, std::string_view(), std::string_view());
+        stack_.push_back(Frame{root, pos_, 0, 0, false, true, false});
+
+        // Set when the next token must be a member or an element (right after
+        // an opening bracket or ',')
+        bool expectItem = true;
+
+        auto wanted = [this]()
+        {
+            return !filtered_ || requiredKeys_.find(path_) != nullptr;
+        };
+
+        while (!stack_.empty())
+        {
+            bool inArray = stack_.back().array;
+            bool flat = stack_.back().flat;
+
+            if (!expectItem)
+            {
+                // A literal leaves its delimiter unconsumed, so its gap is empty
+                size_t last = pos_;
+                pos_ = index.next();
+                if (pos_ >= size_)
+                {
+                    return fail("unexpected end of input");
+                }
+                if (!onlyJsonSpace(data_, last + 1, pos_))
+                {
+                    return fail("unexpected characters after value");
+                }
+
+                char c = data_[pos_];
+                if (c == ',')
+                {
+                    expectItem = true;
+                }
+                else if (c == (inArray ? ']' : '}'))
+                {
+                    closeContainer(tree, handler);
+                }
+                else
+                {
+                    return fail(inArray ? "expected ',' or ']'" : "expected ',' or '}'");
+                }
+                continue;
+            }
+
+            // The opening bracket, ',' or ':' that precedes the value
+            size_t delimiter = pos_;
+            std::string_view key;
+
+            if (!inArray)
+            {
+                pos_ = index.next();
+                if (pos_ >= size_)
+                {
+                    return fail("unexpected end of input");
+                }
+
+                char c = data_[pos_];
+                if (!onlyJsonSpace(data_, delimiter + 1, pos_))
+                {
+                    return fail("expected string key");
+                }
+                if (c == '}')
+                {
+                    if (data_[delimiter] == ',')
+                    {
+                        return fail("expected string key");
+                    }
+                    closeContainer(tree, handler);
+                    expectItem = false;
+                    continue;
+                }
+
+                // Member key
+                size_t keyStart = pos_ + 1;
+                size_t keyEnd = 0;
+                if (c != '"' || !closeString(index, keyEnd))
+                {
+                    return fail("expected string key");
+                }
+                key = std::string_view(data_ + keyStart, keyEnd - keyStart);
+
+                if (flat)
+                {
+                    path_.resize(stack_.back().pathLength);
+                    if (!path_.empty())
+                    {
+                        path_ += '.';
+                    }
+                    path_.append(key.data(), key.size());
+                }
+
+                pos_ = index.next();
+                if (pos_ >= size_ || data_[pos_] != ':')
+                {
+                    return fail("expected ':' after key");
+                }
+                delimiter = pos_;
+            }
+
+            pos_ = index.peek();
+            if (pos_ >= size_)
+            {
+                return fail("unexpected end of input");
+            }
+
+            expectItem = false;
+            char c = data_[pos_];
+            bool literal = c != '"' && c != '{' && c != '[';
+            if (!literal && !onlyJsonSpace(data_, delimiter + 1, pos_))
+            {
+                return fail("expected value");
+            }
+
+            if (c == '"')
+            {
+                index.next();
+                size_t valueStart = pos_ + 1;
+                size_t valueEnd = 0;
+                if (!closeString(index, valueEnd))
+                {
+                    return fail("unterminated string");
+                }
+
+                uint32_t node = tree.addNode(JsonType::String, std::string_view(data_ + valueStart, valueEnd - valueStart), key);
+                children_.push_back(node);
+                if (flat && wanted())
+                {
+                    handler(path_, data_ + valueStart, valueEnd - valueStart, node);
+                }
+            }
+            else if (c == '{' || c == '[')
+            {
+                index.next();
+                bool array = c == '[';
+                uint32_t node = tree.addNode(array ? JsonType::Array : JsonType::Object, std::string_view(), key);
+                children_.push_back(node);
+
+                // Outside arrays, containers that cannot hold a required key
+                // are skipped: jump to the closing bracket
+                bool expand = !flat || !filtered_ || requiredPrefixes_.find(path_) != nullptr ||
+                              (array && requiredKeys_.find(path_) != nullptr);
+                if (!expand)
+                {
+                    size_t start = pos_;
+                    size_t end = 0;
+                    if (!skipContainer(index, end))
+                    {
+                        return fail(array ? "unterminated array" : "unterminated object");
+                    }
+                    JsonTree::Node &skipped = tree.getNode(node);
+                    skipped.text = std::string_view(data_ + start, end - start);
+                    skipped.expanded = false;
+                    continue;
+                }
+
+                // Descend without copying: object members are reported with
+                // this prefix, arrays are reported whole when they close
+                stack_.push_back(Frame{node, pos_, children_.size(), path_.size(), array, flat && !array,
+                                       flat && array && wanted()});
+                expectItem = true;
+            }
+            else
+            {
+                // Number, boolean or null: the literal lies between the delimiter
+                // and the next structural character, which is left unconsumed.
+                // Only an opening bracket may be followed by nothing (empty array)
+                size_t valueStart = delimiter + 1;
+                size_t valueEnd = pos_;
+                while (valueStart < valueEnd && isJsonSpace(data_[valueStart]))
+                {
+                    valueStart++;
+                }
+                while (valueEnd > valueStart && isJsonSpace(data_[valueEnd - 1]))
+                {
+                    valueEnd--;
+                }
+                if (valueStart == valueEnd)
+                {
+                    if (inArray && c == ']' && data_[delimiter] == '[')
+                    {
+                        // Empty array
+                        pos_ = index.next();
+                        closeContainer(tree, handler);
+                        continue;
+                    }
+                    return fail("expected value");
+                }
+                for (size_t i = valueStart; i < valueEnd; i++)
+                {
+                    if (isJsonSpace(data_[i]))
+                    {
+                        // Two values with no ',' between them
+                        return fail("unexpected characters after value");
+                    }
+                }
+
+                uint32_t node = tree.addNode(literalType(data_ + valueStart, valueEnd - valueStart),
+                                             std::string_view(data_ + valueStart, valueEnd - valueStart), key);
+                children_.push_back(node);
+                if (flat && wanted())
+                {
+                    handler(path_, data_ + valueStart, valueEnd - valueStart, node);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    std::string JsonParser::getLastError() const
+    {
+        return lastError_;
+    }
+
+    bool JsonParser::closeString(StructuralIndex &index, size_t &end)
+    {
+        // The opening quote has been consumed; structural characters inside
+        // the string are skipped, and a backslash hides the character after it
+        while (true)
+        {
+            pos_ = index.next();
+            if (pos_ >= size_)
+            {
+                return false;
+            }
+
+            char c = data_[pos_];
+            if (c == '\\')
+            {
+                if (index.peek() == pos_ + 1)
+                {
+                    index.next();
+                }
+            }
+            else if (c == '"')
+            {
+                end = pos_;
+                return true;
+            }
+        }
+    }
+
+    bool JsonParser::skipContainer(StructuralIndex &index, size_t &end)
+    {
+        // The opening bracket or brace has been consumed
+        size_t depth = 1;
+        while (true)
+        {
+            pos_ = index.next();
+            if (pos_ >= size_)
+            {
+                return false;
+            }
+
+            char c = data_[pos_];
+            if (c == '"')
+            {
+                size_t stringEnd = 0;
+                if (!closeString(index, stringEnd))
+                {
+                    return false;
+                }
+            }
+            else if (c == '[' || c == '{')
+            {
+                depth++;
+            }
+            else if (c == ']' || c == '}')
+            {
+                if (--depth == 0)
+                {
+                    end = pos_ + 1;
+                    return true;
+                }
+            }
+        }
+    }
+
+    void JsonParser::closeContainer(JsonTree &tree, const ValueHandler &handler)
+    {
+        // pos_ is at the closing bracket
+        const Frame &frame = stack_.back();
+        std::string_view text(data_ + frame.start, pos_ + 1 - frame.start);
+        tree.getNode(frame.node).text = text;
+        tree.setChildren(frame.node, children_.data() + frame.childBase, children_.size() - frame.childBase);
+        children_.resize(frame.childBase);
+
+        if (frame.report)
+        {
+            path_.resize(frame.pathLength);
+            handler(path_, text.data(), text.size(), frame.node);
+        }
+        stack_.pop_back();
+    }
+
+    bool JsonParser::fail(const std::string &message)
+    {
+        lastError_ = message + " at offset " + std::to_string(pos_);
+        return false;
+    }
+
+} // namespace json2doc
@@ -0,0 +1,492 @@
+#include "json2doc/json_snapshot.h"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+namespace json2doc
+{
+
+    // File layout, every section padded to 8 bytes:
+    //   Header | Slot[slotCount] | EntryRecord[entryCount] | NodeRecord[nodeCount]
+    //   | uint32_t children[childCount] | strings[stringsSize]
+    // Offsets in the records are 32-bit and relative to the string section,
+    // which keeps the records small and limits a snapshot to 4 GiB of text.
+
+    struct JsonSnapshot::Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t slotCount;
+        uint64_t entryCount;
+        uint64_t nodeCount;
+        uint64_t childCount;
+        uint64_t stringsSize;
+        uint64_t reserved;
+    };
+
+    struct JsonSnapshot::Slot
+    {
+        uint32_t tag;   // Upper 32 bits of the hash
+        uint32_t entry; // Entry number + 1, 0 for an empty slot
+    };
+
+    struct JsonSnapshot::EntryRecord
+    {
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+        uint32_t node;
+    };
+
+    struct JsonSnapshot::NodeRecord
+    {
+        uint32_t textOffset;
+        uint32_t textLength;
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t first;
+        uint32_t count;
+        uint8_t type;
+        uint8_t expanded;
+        uint8_t reserved[2];
+    };
+
+    namespace
+    {
+        const char kMagic[8] = {'J', '2', 'D', 'S', 'N', 'A', 'P', '1'};
+        const uint32_t kVersion = 1;
+        const uint32_t kByteOrder = 0x01020304u;
+        const size_t kMinSlots = 16;
+
+        size_t padded(size_t size)
+        {
+            return (size + 7) & ~static_cast<size_t>(7);
+        }
+    } // namespace
+
+    JsonSnapshot::JsonSnapshot()
+        : data_(nullptr), size_(0), header_(nullptr), slots_(nullptr), entries_(nullptr), nodes_(nullptr),
+          children_(nullptr), lastError_("")
+    {
+    }
+
+    JsonSnapshot::JsonSnapshot(JsonSnapshot &&other) noexcept
+        : file_(std::move(other.file_)), data_(other.data_), size_(other.size_), header_(other.header_),
+          slots_(other.slots_), entries_(other.entries_), nodes_(other.nodes_), children_(other.children_),
+          strings_(other.strings_), lastError_(std::move(other.lastError_))
+    {
+        other.close();
+    }
+
+    JsonSnapshot &JsonSnapshot::operator=(JsonSnapshot &&other) noexcept
+    {
+        if (this != &other)
+        {
+            file_ = std::move(other.file_);
+            data_ = other.data_;
+            size_ = other.size_;
+            header_ = other.header_;
+            slots_ = other.slots_;
+            entries_ = other.entries_;
+            nodes_ = other.nodes_;
+            children_ = other.children_;
+            strings_ = other.strings_;
+            lastError_ = std::move(other.lastError_);
+            other.close();
+        }
+        return *this;
+    }
+
+    bool JsonSnapshot::write(const std::string &filePath, const KeyIndex &index, const std::vector<uint32_t> &entryNodes,
+                             const JsonTree &tree, const std::vector<std::string_view> &regions, std::string &error)
+    {
+        static_assert(sizeof(Header) == 64 && sizeof(EntryRecord) == 20 && sizeof(NodeRecord) == 28,
+                      "snapshot records must keep their on-disk layout");
+
+        // Regions go first in the string section, stray slices and keys after them
+        std::vector<uint64_t> regionOffsets;
+        uint64_t regionsSize = 0;
+        for (std::string_view region : regions)
+        {
+            regionOffsets.push_back(regionsSize);
+            regionsSize += region.size();
+        }
+
+        std::string extra;
+        auto place = [&](std::string_view text) -> uint64_t
+        {
+            if (text.empty())
+            {
+                return 0;
+            }
+            for (size_t r = 0; r < regions.size(); r++)
+            {
+                const char *begin = regions[r].data();
+                if (text.data() >= begin && text.data() + text.size() <= begin + regions[r].size())
+                {
+                    return regionOffsets[r] + static_cast<uint64_t>(text.data() - begin);
+                }
+            }
+            uint64_t offset = regionsSize + extra.size();
+            extra.append(text.data(), text.size());
+            return offset;
+        };
+
+        const auto &entries = index.entries();
+        std::vector<EntryRecord> entryRecords(entries.size());
+        for (size_t e = 0; e < entries.size(); e++)
+        {
+            EntryRecord &record = entryRecords[e];
+            record.valueOffset = static_cast<uint32_t>(place(entries[e].value));
+            record.valueLength = static_cast<uint32_t>(entries[e].value.size());
+            record.node = e < entryNodes.size() ? entryNodes[e] : JsonTree::npos;
+        }
+        for (size_t e = 0; e < entries.size(); e++)
+        {
+            // Keys live in the caller's arena, never in a region
+            entryRecords[e].keyOffset = static_cast<uint32_t>(regionsSize + extra.size());
+            entryRecords[e].keyLength = static_cast<uint32_t>(entries[e].key.size());
+            extra.append(entries[e].key.data(), entries[e].key.size());
+        }
+
+        // Child lists are stored compactly, dropping ones replaced by patches
+        std::vector<NodeRecord> nodeRecords(tree.size());
+        std::vector<uint32_t> children;
+        for (uint32_t n = 0; n < tree.size(); n++)
+        {
+            const JsonTree::Node &node = tree.getNode(n);
+            NodeRecord &record = nodeRecords[n];
+            std::memset(&record, 0, sizeof(record));
+            record.textOffset = static_cast<uint32_t>(place(node.text));
+            record.textLength = static_cast<uint32_t>(node.text.size());
+            record.keyOffset = static_cast<uint32_t>(place(node.key));
+            record.keyLength = static_cast<uint32_t>(node.key.size());
+            record.first = static_cast<uint32_t>(children.size());
+            record.count = node.count;
+            record.type = static_cast<uint8_t>(node.type);
+            record.expanded = node.expanded ? 1 : 0;
+            for (uint32_t i = 0; i < node.count; i++)
+            {
+                children.push_back(tree.child(n, i));
+            }
+        }
+
+        // Same open addressing as KeyIndex, at a load factor of at most one half
+        size_t slotCount = kMinSlots;
+        while (entries.size() * 2 > slotCount)
+        {
+            slotCount *= 2;
+        }
+        std::vector<Slot> slots(slotCount, Slot{0, 0});
+        for (size_t e = 0; e < entries.size(); e++)
+        {
+            size_t i = entries[e].hash & (slotCount - 1);
+            while (slots[i].entry != 0)
+            {
+                i = (i + 1) & (slotCount - 1);
+            }
+            slots[i].tag = static_cast<uint32_t>(entries[e].hash >> 32);
+            slots[i].entry = static_cast<uint32_t>(e + 1);
+        }
+
+        if (regionsSize + extra.size() > 0xffffffffu)
+        {
+            error = "Data too large for a snapshot (4 GiB of text at most)";
+            return false;
+        }
+
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.byteOrder = kByteOrder;
+        header.slotCount = slotCount;
+        header.entryCount = entries.size();
+        header.nodeCount = nodeRecords.size();
+        header.childCount = children.size();
+        header.stringsSize = regionsSize + extra.size();
+
+        // Write next to the target and rename, so readers never map a partial file
+        std::string tempPath = filePath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                error = "Cannot create file: " + tempPath;
+                return false;
+            }
+
+            const char zeros[8] = {};
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            auto section = [&file, &zeros](const void *data, size_t size)
+            {
+                file.write(static_cast<const char *>(data), size);
+                file.write(zeros, padded(size) - size);
+            };
+            section(slots.data(), slots.size() * sizeof(Slot));
+            section(entryRecords.data(), entryRecords.size() * sizeof(EntryRecord));
+            section(nodeRecords.data(), nodeRecords.size() * sizeof(NodeRecord));
+            section(children.data(), children.size() * sizeof(uint32_t));
+            for (std::string_view region : regions)
+            {
+                file.write(region.data(), region.size());
+            }
+            file.write(extra.data(), extra.size());
+
+            if (!file.good())
+            {
+                error = "Cannot write file: " + tempPath;
+                file.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+        if (std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+        {
+            error = "Cannot replace file: " + filePath;
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool JsonSnapshot::open(const std::string &filePath)
+    {
+        close();
+        if (!file_.open(filePath))
+        {
+            lastError_ = file_.getLastError();
+            return false;
+        }
+        if (!attach(file_.data(), file_.size()))
+        {
+            file_.close();
+            lastError_ += ": " + filePath;
+            return false;
+        }
+        return true;
+    }
+
+    bool JsonSnapshot::attach(const char *data, size_t size)
+    {
+        auto fail = [this](const char *message)
+        {
+            data_ = nullptr;
+            size_ = 0;
+            header_ = nullptr;
+            lastError_ = message;
+            return false;
+        };
+
+        if (data == nullptr || size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % 8 != 0)
+        {
+            return fail("Not a snapshot");
+        }
+
+        const Header *header = reinterpret_cast<const Header *>(data);
+        if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            return fail("Not a snapshot");
+        }
+        if (header->version != kVersion || header->byteOrder != kByteOrder)
+        {
+            return fail("Unsupported snapshot version or byte order");
+        }
+
+        // Check each section against the remaining bytes, so nothing overflows
+        size_t offset = sizeof(Header);
+        auto section = [&offset, size](uint64_t count, size_t recordSize)
+        {
+            if (count > (size - offset) / recordSize)
+            {
+                return false;
+            }
+            offset += padded(static_cast<size_t>(count) * recordSize);
+            return offset <= size;
+        };
+
+        size_t slotsOffset = offset;
+        if (header->slotCount < kMinSlots || (header->slotCount & (header->slotCount - 1)) != 0 || header->slotCount < header->entryCount * 2 ||
+            !section(header->slotCount, sizeof(Slot)))
+        {
+            return fail("Corrupt snapshot: hash table");
+        }
+        size_t entriesOffset = offset;
+        if (!section(header->entryCount, sizeof(EntryRecord)))
+        {
+            return fail("Corrupt snapshot: entries");
+        }
+        size_t nodesOffset = offset;
+        if (!section(header->nodeCount, sizeof(NodeRecord)))
+        {
+            return fail("Corrupt snapshot: nodes");
+        }
+        size_t childrenOffset = offset;
+        if (!section(header->childCount, sizeof(uint32_t)))
+        {
+            return fail("Corrupt snapshot: children");
+        }
+        if (header->stringsSize != size - offset)
+        {
+            return fail("Corrupt snapshot: truncated");
+        }
+
+        data_ = data;
+        size_ = size;
+        header_ = header;
+        slots_ = reinterpret_cast<const Slot *>(data + slotsOffset);
+        entries_ = reinterpret_cast<const EntryRecord *>(data + entriesOffset);
+        nodes_ = reinterpret_cast<const NodeRecord *>(data + nodesOffset);
+        children_ = reinterpret_cast<const uint32_t *>(data + childrenOffset);
+        strings_ = std::string_view(data + offset, size - offset);
+        return true;
+    }
+
+    void JsonSnapshot::close()
+    {
+        file_.close();
+        data_ = nullptr;
+        size_ = 0;
+        header_ = nullptr;
+        slots_ = nullptr;
+        entries_ = nullptr;
+        nodes_ = nullptr;
+        children_ = nullptr;
+        strings_ = std::string_view();
+    }
+
+    bool JsonSnapshot::isOpen() const
+    {
+        return header_ != nullptr;
+    }
+
+    std::string_view JsonSnapshot::bytes() const
+    {
+        return std::string_view(data_, size_);
+    }
+
+    std::string_view JsonSnapshot::strings() const
+    {
+        return strings_;
+    }
+
+    size_t JsonSnapshot::size() const
+    {
+        return header_ != nullptr ? static_cast<size_t>(header_->entryCount) : 0;
+    }
+
+    bool JsonSnapshot::find(std::string_view key, uint64_t keyHash, size_t &entry) const
+    {
+        if (header_ == nullptr)
+        {
+            return false;
+        }
+
+        // Probe in place; attach() guarantees at least one empty slot
+        const uint64_t mask = header_->slotCount - 1;
+        const uint32_t tag = static_cast<uint32_t>(keyHash >> 32);
+        for (uint64_t i = keyHash & mask, probes = 0; probes <= mask; i = (i + 1) & mask, probes++)
+        {
+            const Slot &slot = slots_[i];
+            if (slot.entry == 0)
+            {
+                return false;
+            }
+            if (slot.tag == tag && slot.entry <= header_->entryCount)
+            {
+                const EntryRecord &record = entries_[slot.entry - 1];
+                if (slice(record.keyOffset, record.keyLength) == key)
+                {
+                    entry = slot.entry - 1;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::string_view JsonSnapshot::key(size_t entry) const
+    {
+        return slice(entries_[entry].keyOffset, entries_[entry].keyLength);
+    }
+
+    std::string_view JsonSnapshot::value(size_t entry) const
+    {
+        return slice(entries_[entry].valueOffset, entries_[entry].valueLength);
+    }
+
+    uint32_t JsonSnapshot::node(size_t entry) const
+    {
+        uint32_t node = entries_[entry].node;
+        return node < header_->nodeCount ? node : JsonTree::npos;
+    }
+
+    bool JsonSnapshot::loadTree(JsonTree &tree) const
+    {
+        tree.clear();
+        if (header_ == nullptr)
+        {
+            return true;
+        }
+
+        const uint64_t nodeCount = header_->nodeCount;
+        const uint64_t childCount = header_->childCount;
+        tree.reserve(static_cast<size_t>(nodeCount), static_cast<size_t>(childCount));
+
+        for (uint64_t n = 0; n < nodeCount; n++)
+        {
+            const NodeRecord &record = nodes_[n];
+            if (record.type > static_cast<uint8_t>(JsonType::Object))
+            {
+                tree.clear();
+                return false;
+            }
+            uint32_t node = tree.addNode(static_cast<JsonType>(record.type), slice(record.textOffset, record.textLength),
+                                         slice(record.keyOffset, record.keyLength));
+            tree.getNode(node).expanded = record.expanded != 0;
+        }
+
+        for (uint64_t n = 0; n < nodeCount; n++)
+        {
+            const NodeRecord &record = nodes_[n];
+            if (record.count == 0)
+            {
+                continue;
+            }
+            if (record.first > childCount || record.count > childCount - record.first)
+            {
+                tree.clear();
+                return false;
+            }
+            for (uint32_t i = 0; i < record.count; i++)
+            {
+                if (children_[record.first + i] >= nodeCount)
+                {
+                    tree.clear();
+                    return false;
+                }
+            }
+            tree.setChildren(static_cast<uint32_t>(n), children_ + record.first, record.count);
+        }
+        return true;
+    }
+
+    std::string JsonSnapshot::getLastError() const
+    {
+        return lastError_;
+    }
+
+    std::string_view JsonSnapshot::slice(uint32_t offset, uint32_t length) const
+    {
+        // Out-of-range records read as empty instead of past the mapping
+        if (offset > strings_.size() || length > strings_.size() - offset)
+        {
+            return std::string_view();
+        }
+        return strings_.substr(offset, length);
+    }
+
+} // namespace json2doc
@@ -0,0 +1,475 @@
+#include "json2doc/json_value.h"
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Parse an array index segment; rejects signs, blanks and overflow
+        bool parseIndex(std::string_view segment, size_t &index)
+        {
+            if (segment.empty())
+            {
+                return false;
+            }
+            auto result = std::from_chars(segment.data(), segment.data() + segment.size(), index);
+            return result.ec == std::errc() && result.ptr == segment.data() + segment.size();
+        }
+
+        unsigned hexValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f')
+            {
+                return c - 'a' + 10;
+            }
+            if (c >= 'A' && c <= 'F')
+            {
+                return c - 'A' + 10;
+            }
+            return 16;
+        }
+
+        bool readHex4(std::string_view text, size_t pos, unsigned &value)
+        {
+            if (pos + 4 > text.size())
+            {
+                return false;
+            }
+            value = 0;
+            for (size_t i = pos; i < pos + 4; i++)
+            {
+                unsigned digit = hexValue(text[i]);
+                if (digit > 15)
+                {
+                    return false;
+                }
+                value = value * 16 + digit;
+            }
+            return true;
+        }
+
+        void appendUtf8(std::string &out, unsigned codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                out += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (codePoint >> 6));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (codePoint >> 12));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (codePoint >> 18));
+                out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        std::string unescape(std::string_view text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                char c = text[i];
+                if (c != '\\' || i + 1 == text.size())
+                {
+                    out += c;
+                    continue;
+                }
+
+                char e = text[++i];
+                switch (e)
+                {
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    unsigned codePoint = 0;
+                    if (!readHex4(text, i + 1, codePoint))
+                    {
+                        out += "\\u";
+                        break;
+                    }
+                    i += 4;
+
+                    // Combine a UTF-16 surrogate pair
+                    unsigned low = 0;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 2 < text.size() &&
+                        text[i + 1] == '\\' && text[i + 2] == 'u' && readHex4(text, i + 3, low) &&
+                        low >= 0xDC00 && low < 0xE000)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default:
+                    // \" \\ \/ and unknown escapes keep the escaped character
+                    out += e;
+                    break;
+                }
+            }
+            return out;
+        }
+    } // namespace
+
+    // ========== JsonValue ==========
+
+    JsonValue::JsonValue()
+        : tree_(nullptr), node_(JsonTree::npos)
+    {
+    }
+
+    JsonValue::JsonValue(const JsonTree *tree, uint32_t node)
+        : tree_(tree), node_(node)
+    {
+    }
+
+    bool JsonValue::isValid() const
+    {
+        return tree_ != nullptr && node_ != JsonTree::npos;
+    }
+
+    JsonType JsonValue::getType() const
+    {
+        return isValid() ? tree_->getNode(node_).type : JsonType::Null;
+    }
+
+    bool JsonValue::isNull() const
+    {
+        return isValid() && getType() == JsonType::Null;
+    }
+
+    bool JsonValue::isBool() const
+    {
+        return getType() == JsonType::Bool;
+    }
+
+    bool JsonValue::isNumber() const
+    {
+        JsonType type = getType();
+        return type == JsonType::Int || type == JsonType::Double;
+    }
+
+    bool JsonValue::isString() const
+    {
+        return getType() == JsonType::String;
+    }
+
+    bool JsonValue::isArray() const
+    {
+        return getType() == JsonType::Array;
+    }
+
+    bool JsonValue::isObject() const
+    {
+        return getType() == JsonType::Object;
+    }
+
+    bool JsonValue::asBool(bool defaultValue) const
+    {
+        switch (getType())
+        {
+        case JsonType::Bool:
+            return getText() == "true";
+        case JsonType::Int:
+        case JsonType::Double:
+            return asDouble() != 0.0;
+        default:
+            return defaultValue;
+        }
+    }
+
+    int64_t JsonValue::asInt(int64_t defaultValue) const
+    {
+        JsonType type = getType();
+        if (type == JsonType::Int)
+        {
+            std::string_view text = getText();
+            int64_t value = 0;
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc() ? value : defaultValue;
+        }
+        if (type == JsonType::Double)
+        {
+            double value = asDouble();
+            if (value >= -9.2e18 && value <= 9.2e18)
+            {
+                return static_cast<int64_t>(value);
+            }
+        }
+        return defaultValue;
+    }
+
+    double JsonValue::asDouble(double defaultValue) const
+    {
+        if (!isNumber())
+        {
+            return defaultValue;
+        }
+
+        std::string_view text = getText();
+        const char *begin = text.data();
+        // from_chars does not accept the leading '+' some writers emit
+        if (!text.empty() && text[0] == '+')
+        {
+            begin++;
+        }
+        double value = 0.0;
+        auto result = std::from_chars(begin, text.data() + text.size(), value);
+        return result.ec == std::errc() ? value : defaultValue;
+    }
+
+    std::string JsonValue::asString() const
+    {
+        if (!isValid())
+        {
+            return "";
+        }
+        if (getType() == JsonType::String)
+        {
+            std::string_view text = getText();
+            return text.find('\\') == std::string_view::npos ? std::string(text) : unescape(text);
+        }
+        return std::string(getText());
+    }
+
+    std::string_view JsonValue::getText() const
+    {
+        return isValid() ? tree_->getNode(node_).text : std::string_view();
+    }
+
+    std::string_view JsonValue::getKey() const
+    {
+        return isValid() ? tree_->getNode(node_).key : std::string_view();
+    }
+
+    size_t JsonValue::size() const
+    {
+        return isValid() ? tree_->getNode(node_).count : 0;
+    }
+
+    bool JsonValue::isExpanded() const
+    {
+        return isValid() && tree_->getNode(node_).expanded;
+    }
+
+    JsonValue JsonValue::operator[](size_t index) const
+    {
+        return isValid() ? tree_->getValue(tree_->child(node_, index)) : JsonValue();
+    }
+
+    JsonValue JsonValue::get(std::string_view key) const
+    {
+        return isValid() ? tree_->getValue(tree_->member(node_, key)) : JsonValue();
+    }
+
+    JsonValue JsonValue::find(std::string_view path) const
+    {
+        return isValid() ? tree_->getValue(tree_->find(node_, path)) : JsonValue();
+    }
+
+    uint32_t JsonValue::getNode() const
+    {
+        return node_;
+    }
+
+    // ========== JsonTree ==========
+
+    const uint32_t JsonTree::npos;
+
+    JsonTree::JsonTree()
+    {
+    }
+
+    uint32_t JsonTree::addNode(JsonType type, std::string_view text, std::string_view key)
+    {
+        nodes_.push_back(Node{text, key, 0, 0, type, true});
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void JsonTree::setChildren(uint32_t node, const uint32_t *children, size_t count)
+    {
+        nodes_[node].first = static_cast<uint32_t>(children_.size());
+        nodes_[node].count = static_cast<uint32_t>(count);
+        children_.insert(children_.end(), children, children + count);
+    }
+
+    JsonTree::Node &JsonTree::getNode(uint32_t node)
+    {
+        return nodes_[node];
+    }
+
+    const JsonTree::Node &JsonTree::getNode(uint32_t node) const
+    {
+        return nodes_[node];
+    }
+
+    uint32_t JsonTree::child(uint32_t node, size_t index) const
+    {
+        const Node &n = nodes_[node];
+        return index < n.count ? children_[n.first + index] : npos;
+    }
+
+    uint32_t JsonTree::member(uint32_t node, std::string_view key) const
+    {
+        const Node &n = nodes_[node];
+        if (n.type != JsonType::Object)
+        {
+            return npos;
+        }
+
+        // Later duplicates win, as in the flattened key index
+        for (uint32_t i = n.count; i > 0; i--)
+        {
+            uint32_t id = children_[n.first + i - 1];
+            if (nodes_[id].key == key)
+            {
+                return id;
+            }
+        }
+        return npos;
+    }
+
+    uint32_t JsonTree::find(uint32_t node, std::string_view path) const
+    {
+        while (node != npos && !path.empty())
+        {
+            size_t dot = path.find('.');
+            std::string_view segment = path.substr(0, dot);
+            path = dot == std::string_view::npos ? std::string_view() : path.substr(dot + 1);
+
+            const Node &n = nodes_[node];
+            size_t index = 0;
+            if (n.type == JsonType::Array && parseIndex(segment, index))
+            {
+                node = child(node, index);
+            }
+            else
+            {
+                node = member(node, segment);
+            }
+        }
+        return node;
+    }
+
+    JsonValue JsonTree::getRoot() const
+    {
+        return JsonValue(this, nodes_.empty() ? npos : 0);
+    }
+
+    JsonValue JsonTree::getValue(uint32_t node) const
+    {
+        return JsonValue(this, node);
+    }
+
+    uint32_t JsonTree::graft(const JsonTree &other, uint32_t node)
+    {
+        uint32_t root = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(other.nodes_[node]);
+
+        // Each child list is copied in one go so it stays contiguous
+        std::vector<std::pair<uint32_t, uint32_t>> pending{{node, root}};
+        while (!pending.empty())
+        {
+            auto [source, target] = pending.back();
+            pending.pop_back();
+
+            const Node &from = other.nodes_[source];
+            nodes_[target].first = static_cast<uint32_t>(children_.size());
+            for (uint32_t i = 0; i < from.count; i++)
+            {
+                uint32_t child = other.children_[from.first + i];
+                uint32_t copy = static_cast<uint32_t>(nodes_.size());
+                nodes_.push_back(other.nodes_[child]);
+                children_.push_back(copy);
+                pending.emplace_back(child, copy);
+            }
+        }
+        return root;
+    }
+
+    void JsonTree::appendChild(uint32_t node, uint32_t child)
+    {
+        Node &n = nodes_[node];
+        uint32_t first = static_cast<uint32_t>(children_.size());
+        for (uint32_t i = 0; i < n.count; i++)
+        {
+            children_.push_back(children_[n.first + i]);
+        }
+        children_.push_back(child);
+        n.first = first;
+        n.count++;
+    }
+
+    void JsonTree::rebase(const char *oldBase, size_t size, const char *newBase)
+    {
+        auto move = [oldBase, size, newBase](std::string_view &slice)
+        {
+            if (!slice.empty() && slice.data() >= oldBase && slice.data() + slice.size() <= oldBase + size)
+            {
+                slice = std::string_view(newBase + (slice.data() - oldBase), slice.size());
+            }
+        };
+
+        for (auto &node : nodes_)
+        {
+            move(node.text);
+            move(node.key);
+        }
+    }
+
+    size_t JsonTree::size() const
+    {
+        return nodes_.size();
+    }
+
+    bool JsonTree::empty() const
+    {
+        return nodes_.empty();
+    }
+
+    void JsonTree::reserve(size_t nodes, size_t children)
+    {
+        nodes_.reserve(nodes);
+        children_.reserve(children);
+    }
+
+    void JsonTree::clear()
+    {
+        nodes_.clear();
+        children_.clear();
+    }
+
+} // namespace json2doc
@@ -0,0 +1,201 @@
+#include "json2doc/key_index.h"
+#include <cstring>
+#include <algorithm>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        const size_t kMinSlots = 16;
+    } // namespace
+
+    KeyIndex::KeyIndex()
+        : mask_(0)
+    {
+    }
+
+    uint64_t KeyIndex::hash(std::string_view key)
+    {
+        // MurmurHash64A, reading 8 bytes at a time
+        const uint64_t m = 0xc6a4a7935bd1e995ULL;
+        const int r = 47;
+
+        const char *p = key.data();
+        size_t n = key.size();
+        uint64_t h = 0x9e3779b97f4a7c15ULL ^ (n * m);
+
+        while (n >= 8)
+        {
+            uint64_t k;
+            std::memcpy(&k, p, 8);
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+            h ^= k;
+            h *= m;
+            p += 8;
+            n -= 8;
+        }
+
+        if (n > 0)
+        {
+            uint64_t k = 0;
+            std::memcpy(&k, p, n);
+            h ^= k;
+            h *= m;
+        }
+
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return h;
+    }
+
+    size_t KeyIndex::insert(std::string_view key, std::string_view value, Arena &keyStorage)
+    {
+        return insert(key, value, hash(key), keyStorage);
+    }
+
+    size_t KeyIndex::insert(std::string_view key, std::string_view value, uint64_t keyHash, Arena &keyStorage)
+    {
+        // Keep the load factor at or below one half
+        if ((entries_.size() + 1) * 2 > slots_.size())
+        {
+            grow();
+        }
+
+        size_t slot = findSlot(key, keyHash);
+        if (slots_[slot].entry != 0)
+        {
+            entries_[slots_[slot].entry - 1].value = value;
+            return slots_[slot].entry - 1;
+        }
+
+        entries_.push_back(Entry{keyHash, keyStorage.copy(key), value});
+        slots_[slot].tag = static_cast<uint32_t>(keyHash >> 32);
+        slots_[slot].entry = static_cast<uint32_t>(entries_.size());
+        return entries_.size() - 1;
+    }
+
+    const KeyIndex::Entry *KeyIndex::find(std::string_view key) const
+    {
+        return find(key, hash(key));
+    }
+
+    const KeyIndex::Entry *KeyIndex::find(std::string_view key, uint64_t keyHash) const
+    {
+        if (entries_.empty())
+        {
+            return nullptr;
+        }
+
+        const Slot &slot = slots_[findSlot(key, keyHash)];
+        return slot.entry != 0 ? &entries_[slot.entry - 1] : nullptr;
+    }
+
+    void KeyIndex::setValue(size_t entryIndex, std::string_view value)
+    {
+        entries_[entryIndex].value = value;
+    }
+
+    size_t KeyIndex::erase(const std::vector<bool> &remove)
+    {
+        size_t kept = 0;
+        for (size_t e = 0; e < entries_.size(); e++)
+        {
+            if (!remove[e])
+            {
+                entries_[kept++] = entries_[e];
+            }
+        }
+
+        size_t removed = entries_.size() - kept;
+        if (removed > 0)
+        {
+            entries_.resize(kept);
+            std::fill(slots_.begin(), slots_.end(), Slot{0, 0});
+            placeEntries();
+        }
+        return removed;
+    }
+
+    const std::vector<KeyIndex::Entry> &KeyIndex::entries() const
+    {
+        return entries_;
+    }
+
+    size_t KeyIndex::size() const
+    {
+        return entries_.size();
+    }
+
+    bool KeyIndex::empty() const
+    {
+        return entries_.empty();
+    }
+
+    void KeyIndex::reserve(size_t count)
+    {
+        entries_.reserve(count);
+        while (count * 2 > slots_.size())
+        {
+            grow();
+        }
+    }
+
+    void KeyIndex::clear()
+    {
+        entries_.clear();
+        std::fill(slots_.begin(), slots_.end(), Slot{0, 0});
+    }
+
+    size_t KeyIndex::findSlot(std::string_view key, uint64_t keyHash) const
+    {
+        // Linear probing; the tag filters out almost every non-matching entry
+        // before its key is compared
+        const uint32_t tag = static_cast<uint32_t>(keyHash >> 32);
+        size_t i = keyHash & mask_;
+        while (true)
+        {
+            const Slot &slot = slots_[i];
+            if (slot.entry == 0)
+            {
+                return i;
+            }
+            if (slot.tag == tag)
+            {
+                const Entry &entry = entries_[slot.entry - 1];
+                if (entry.hash == keyHash && entry.key == key)
+                {
+                    return i;
+                }
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    void KeyIndex::grow()
+    {
+        size_t capacity = std::max(kMinSlots, slots_.size() * 2);
+        slots_.assign(capacity, Slot{0, 0});
+        mask_ = capacity - 1;
+        placeEntries();
+    }
+
+    void KeyIndex::placeEntries()
+    {
+        // Every slot is empty and no key repeats, so no key is compared
+        for (size_t e = 0; e < entries_.size(); e++)
+        {
+            size_t i = entries_[e].hash & mask_;
+            while (slots_[i].entry != 0)
+            {
+                i = (i + 1) & mask_;
+            }
+            slots_[i].tag = static_cast<uint32_t>(entries_[e].hash >> 32);
+            slots_[i].entry = static_cast<uint32_t>(e + 1);
+        }
+    }
+
+} // namespace json2doc
@@ -0,0 +1,126 @@
+#include "json2doc/mapped_file.h"
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace json2doc
+{
+
+    MappedFile::MappedFile()
+        : data_(nullptr), size_(0), open_(false), lastError_("")
+    {
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : data_(other.data_), size_(other.size_), open_(other.open_), lastError_(std::move(other.lastError_))
+    {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.open_ = false;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            data_ = other.data_;
+            size_ = other.size_;
+            open_ = other.open_;
+            lastError_ = std::move(other.lastError_);
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.open_ = false;
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::string &filePath)
+    {
+        close();
+
+        int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            lastError_ = "Cannot open file: " + filePath + " (" + std::strerror(errno) + ")";
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            lastError_ = "Not a regular file: " + filePath;
+            ::close(fd);
+            return false;
+        }
+
+        if (st.st_size > 0)
+        {
+            void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                lastError_ = "Cannot map file: " + filePath + " (" + std::strerror(errno) + ")";
+                ::close(fd);
+                return false;
+            }
+
+            // The parser reads the mapping front to back
+            madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+            data_ = static_cast<const char *>(addr);
+            size_ = static_cast<size_t>(st.st_size);
+        }
+
+        // The mapping keeps the file contents reachable after the descriptor is closed
+        ::close(fd);
+
+        open_ = true;
+        lastError_ = "";
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (data_ != nullptr)
+        {
+            munmap(const_cast<char *>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        open_ = false;
+    }
+
+    bool MappedFile::isOpen() const
+    {
+        return open_;
+    }
+
+    const char *MappedFile::data() const
+    {
+        return data_;
+    }
+
+    size_t MappedFile::size() const
+    {
+        return size_;
+    }
+
+    std::string_view MappedFile::view() const
+    {
+        return std::string_view(data_, size_);
+    }
+
+    std::string MappedFile::getLastError() const
+    {
+        return lastError_;
+    }
+
+} // namespace json2doc
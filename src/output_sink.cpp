@@ -0,0 +1,267 @@
+#include "json2doc/output_sink.h"
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Ranges below this size are copied into the buffer by writev()
+        const size_t kGatherCopyLimit = 4096;
+
+        // Blocks passed to one writeOutv() call
+        const size_t kGatherMaxBlocks = 64;
+    } // namespace
+
+    OutputSink::OutputSink(size_t bufferSize)
+        : buffer_(bufferSize), used_(0), total_(0), failed_(false), lastError_("")
+    {
+    }
+
+    bool OutputSink::write(const char *data, size_t size)
+    {
+        if (failed_)
+        {
+            return false;
+        }
+        total_ += size;
+
+        if (used_ + size <= buffer_.size())
+        {
+            std::memcpy(buffer_.data() + used_, data, size);
+            used_ += size;
+            return true;
+        }
+
+        // Too large for the remaining space: empty the buffer, then either
+        // start refilling it or pass a large block straight through
+        if (!flush())
+        {
+            return false;
+        }
+        if (size < buffer_.size())
+        {
+            std::memcpy(buffer_.data(), data, size);
+            used_ = size;
+            return true;
+        }
+        return writeOut(data, size);
+    }
+
+    bool OutputSink::writev(const std::string_view *parts, size_t count)
+    {
+        if (failed_)
+        {
+            return false;
+        }
+
+        // gather_ lists the blocks to write in order: slices of the buffer
+        // (which is not reused until they are written) and caller ranges
+        size_t copyLimit = std::min(kGatherCopyLimit, buffer_.size());
+        auto writeGathered = [this]()
+        {
+            bool ok = writeOutv(gather_.data(), gather_.size());
+            gather_.clear();
+            used_ = 0;
+            return ok;
+        };
+
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string_view part = parts[i];
+            if (part.empty())
+            {
+                continue;
+            }
+            total_ += part.size();
+
+            if (part.size() < copyLimit)
+            {
+                if (used_ + part.size() > buffer_.size())
+                {
+                    if (!(gather_.empty() ? flush() : writeGathered()))
+                    {
+                        return false;
+                    }
+                }
+                char *copy = buffer_.data() + used_;
+                std::memcpy(copy, part.data(), part.size());
+                used_ += part.size();
+
+                if (!gather_.empty())
+                {
+                    std::string_view &last = gather_.back();
+                    if (last.data() + last.size() == copy)
+                    {
+                        last = std::string_view(last.data(), last.size() + part.size());
+                    }
+                    else
+                    {
+                        gather_.push_back(std::string_view(copy, part.size()));
+                    }
+                }
+            }
+            else
+            {
+                if (gather_.empty() && used_ > 0)
+                {
+                    gather_.push_back(std::string_view(buffer_.data(), used_));
+                }
+                gather_.push_back(part);
+            }
+
+            if (gather_.size() >= kGatherMaxBlocks && !writeGathered())
+            {
+                return false;
+            }
+        }
+
+        // Caller ranges must be written before returning
+        return gather_.empty() || writeGathered();
+    }
+
+    bool OutputSink::writeOutv(const std::string_view *parts, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!writeOut(parts[i].data(), parts[i].size()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool OutputSink::flush()
+    {
+        if (failed_)
+        {
+            return false;
+        }
+        if (used_ > 0)
+        {
+            size_t used = used_;
+            used_ = 0;
+            return writeOut(buffer_.data(), used);
+        }
+        return true;
+    }
+
+    bool OutputSink::fail(const std::string &message)
+    {
+        failed_ = true;
+        used_ = 0;
+        gather_.clear();
+        lastError_ = message;
+        return false;
+    }
+
+    FdSink::FdSink(int fd, size_t bufferSize)
+        : OutputSink(bufferSize), fd_(fd)
+    {
+    }
+
+    FdSink::~FdSink()
+    {
+        flush();
+    }
+
+    bool FdSink::writeOut(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd_, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return fail(std::string("Write failed: ") + std::strerror(errno));
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool FdSink::writeOutv(const std::string_view *parts, size_t count)
+    {
+        struct iovec blocks[kGatherMaxBlocks];
+        size_t next = 0;
+        size_t offset = 0; // Bytes of parts[next] already written
+        while (next < count)
+        {
+            int used = 0;
+            for (size_t i = next; i < count && used < static_cast<int>(kGatherMaxBlocks); i++, used++)
+            {
+                size_t skip = i == next ? offset : 0;
+                blocks[used].iov_base = const_cast<char *>(parts[i].data() + skip);
+                blocks[used].iov_len = parts[i].size() - skip;
+            }
+
+            ssize_t written = ::writev(fd_, blocks, used);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return fail(std::string("Write failed: ") + std::strerror(errno));
+            }
+
+            // Skip what was written; a short write resumes mid-block
+            size_t remaining = static_cast<size_t>(written);
+            while (next < count && remaining >= parts[next].size() - offset)
+            {
+                remaining -= parts[next].size() - offset;
+                offset = 0;
+                next++;
+            }
+            offset += remaining;
+        }
+        return true;
+    }
+
+    FileSink::FileSink(FILE *file, size_t bufferSize)
+        : OutputSink(bufferSize), file_(file)
+    {
+    }
+
+    FileSink::~FileSink()
+    {
+        flush();
+    }
+
+    bool FileSink::writeOut(const char *data, size_t size)
+    {
+        if (std::fwrite(data, 1, size, file_) != size)
+        {
+            return fail(std::string("Write failed: ") + std::strerror(errno));
+        }
+        return true;
+    }
+
+    MemorySink::MemorySink()
+        : OutputSink(0), data_("")
+    {
+    }
+
+    std::string MemorySink::take()
+    {
+        std::string result = std::move(data_);
+        data_.clear();
+        return result;
+    }
+
+    bool MemorySink::writeOut(const char *data, size_t size)
+    {
+        data_.append(data, size);
+        return true;
+    }
+
+} // namespace json2doc
@@ -0,0 +1,88 @@
+#include "json2doc/placeholder_scanner.h"
+#include <cstring>
+#include <cctype>
+
+namespace json2doc
+{
+
+    PlaceholderScanner::PlaceholderScanner(std::string_view text)
+        : text_(text), pos_(0)
+    {
+    }
+
+    bool PlaceholderScanner::next(Match &match)
+    {
+        const char *data = text_.data();
+        const size_t size = text_.size();
+
+        // The shortest placeholder, "{{x}}", is five bytes long
+        while (size - pos_ >= 5)
+        {
+            // Candidate start: a '{' followed by another '{'
+            const char *open = static_cast<const char *>(std::memchr(data + pos_, '{', size - pos_));
+            if (open == nullptr)
+            {
+                pos_ = size;
+                return false;
+            }
+            size_t start = open - data;
+            if (start + 1 >= size)
+            {
+                pos_ = size;
+                return false;
+            }
+            if (data[start + 1] != '{')
+            {
+                pos_ = start + 1;
+                continue;
+            }
+
+            // The name runs to the first '}' after the opening braces. Every
+            // candidate before that '}' ends at the same brace, so when this
+            // one fails the search resumes after it.
+            size_t nameStart = start + 2;
+            const char *close = nameStart < size
+                                    ? static_cast<const char *>(std::memchr(data + nameStart, '}', size - nameStart))
+                                    : nullptr;
+            if (close == nullptr)
+            {
+                pos_ = size;
+                return false;
+            }
+            size_t end = close - data;
+            if (end == nameStart || end + 1 >= size || data[end + 1] != '}')
+            {
+                pos_ = end + 1;
+                continue;
+            }
+
+            size_t first = nameStart;
+            size_t last = end;
+            while (first < last && std::isspace(static_cast<unsigned char>(data[first])))
+            {
+                first++;
+            }
+            while (last > first && std::isspace(static_cast<unsigned char>(data[last - 1])))
+            {
+                last--;
+            }
+
+            match.offset = start;
+            match.placeholder = text_.substr(start, end + 2 - start);
+            match.name = text_.substr(first, last - first);
+            pos_ = end + 2;
+            return true;
+        }
+
+        pos_ = size;
+        return false;
+    }
+
+    bool PlaceholderScanner::contains(std::string_view text)
+    {
+        PlaceholderScanner scanner(text);
+        Match match;
+        return scanner.next(match);
+    }
+
+} // namespace json2doc
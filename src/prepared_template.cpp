@@ -0,0 +1,88 @@
+#include "json2doc/prepared_template.h"
+#include "json2doc/docx_reader.h"
+
+namespace json2doc
+{
+
+    PreparedTemplate::PreparedTemplate()
+        : loaded_(false), lastError_("")
+    {
+    }
+
+    bool PreparedTemplate::load(const std::string &xmlContent)
+    {
+        variables_.clear();
+        loaded_ = false;
+
+        if (!prototype_.loadFromString(xmlContent))
+        {
+            lastError_ = prototype_.getLastError();
+            return false;
+        }
+
+        // Paid once here instead of once per render
+        prototype_.mergeSplitPlaceholders();
+
+        // Symbol ids follow the first occurrence of each name in the document.
+        // The index is built by now, so later reads of the prototype (from
+        // any thread) never modify it
+        const SymbolTable &symbols = prototype_.getSymbols();
+        variables_.reserve(symbols.size());
+        for (uint32_t id = 0; id < symbols.size(); id++)
+        {
+            variables_.push_back(std::string(symbols.name(id)));
+        }
+
+        loaded_ = true;
+        lastError_ = "";
+        return true;
+    }
+
+    bool PreparedTemplate::loadDocx(const std::string &docxPath)
+    {
+        DocxReader reader;
+        if (!reader.open(docxPath) || !reader.decompress())
+        {
+            lastError_ = reader.getLastError();
+            loaded_ = false;
+            return false;
+        }
+
+        std::string xmlContent = reader.readDocumentXml();
+        reader.cleanup();
+        if (xmlContent.empty())
+        {
+            lastError_ = reader.getLastError();
+            loaded_ = false;
+            return false;
+        }
+
+        return load(xmlContent);
+    }
+
+    bool PreparedTemplate::isLoaded() const
+    {
+        return loaded_;
+    }
+
+    bool PreparedTemplate::instantiate(XmlDocument &doc) const
+    {
+        if (!loaded_)
+        {
+            doc.clear();
+            return false;
+        }
+        return doc.copyFrom(prototype_);
+    }
+
+    const std::vector<std::string> &PreparedTemplate::getVariables() const
+    {
+        return variables_;
+    }
+
+    std::string PreparedTemplate::getLastError() const
+    {
+        return lastError_;
+    }
+
+} // namespace json2doc
@@ -0,0 +1,433 @@
+#include "json2doc/splice_template.h"
+#include "json2doc/placeholder_scanner.h"
+#include "json2doc/output_sink.h"
+#include "json2doc/xml_document.h"
+#include <cstring>
+#include <algorithm>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Ranges handed to one OutputSink::writev() call
+        const size_t kGatherBatch = 256;
+
+        bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        // Characters pugixml escapes in character data
+        bool needsEscape(unsigned char c)
+        {
+            return c == '&' || c == '<' || c == '>' || (c < 32 && c != '\t' && c != '\n' && c != '\r');
+        }
+
+        // Escape a value the way pugixml writes character data
+        void appendEscaped(std::string &out, std::string_view value)
+        {
+            for (char ch : value)
+            {
+                unsigned char c = static_cast<unsigned char>(ch);
+                if (!needsEscape(c))
+                {
+                    out += ch;
+                }
+                else if (c == '&')
+                {
+                    out += "&amp;";
+                }
+                else if (c == '<')
+                {
+                    out += "&lt;";
+                }
+                else if (c == '>')
+                {
+                    out += "&gt;";
+                }
+                else
+                {
+                    out += "&#";
+                    out += static_cast<char>('0' + c / 10);
+                    out += static_cast<char>('0' + c % 10);
+                    out += ';';
+                }
+            }
+        }
+
+        // A CDATA section cannot contain "]]>", so pugixml splits it there
+        void appendCdata(std::string &out, std::string_view value)
+        {
+            size_t copied = 0;
+            size_t end;
+            while ((end = value.find("]]>", copied)) != std::string_view::npos)
+            {
+                out.append(value.data() + copied, end + 2 - copied);
+                out += "]]><![CDATA[";
+                copied = end + 2;
+            }
+            out.append(value.data() + copied, value.size() - copied);
+        }
+    } // namespace
+
+    SpliceTemplate::SpliceTemplate()
+        : xml_(""), loaded_(false), lastError_("")
+    {
+    }
+
+    bool SpliceTemplate::load(std::string xmlContent)
+    {
+        symbols_.clear();
+        placeholders_.clear();
+        loaded_ = false;
+
+        // Splice the bytes toString() writes, so a render is exactly what
+        // replaceVariables() and toString() produce (declaration, entities
+        // and indentation included). The DOM is only needed here
+        {
+            XmlDocument doc;
+            if (!doc.loadFromString(xmlContent))
+            {
+                xml_.clear();
+                lastError_ = doc.getLastError();
+                return false;
+            }
+            xml_ = doc.toString();
+        }
+
+        std::string_view xml = xml_;
+        const size_t size = xml.size();
+        std::vector<std::string_view> open;
+        bool rootSeen = false;
+        size_t pos = 0;
+
+        auto error = [this](const std::string &message, size_t at)
+        {
+            lastError_ = message + " (offset " + std::to_string(at) + ")";
+            placeholders_.clear();
+            symbols_.clear();
+            return false;
+        };
+
+        // UTF-8 byte order mark
+        if (xml.substr(0, 3) == "\xEF\xBB\xBF")
+        {
+            pos = 3;
+        }
+
+        while (pos < size)
+        {
+            if (xml[pos] != '<')
+            {
+                size_t end = xml.find('<', pos);
+                end = end == std::string_view::npos ? size : end;
+                if (open.empty())
+                {
+                    for (size_t i = pos; i < end; i++)
+                    {
+                        if (!isSpace(xml[i]))
+                        {
+                            return error("Text outside the root element", i);
+                        }
+                    }
+                }
+                else if (!scanText(pos, end - pos, false))
+                {
+                    return false;
+                }
+                pos = end;
+                continue;
+            }
+
+            std::string_view rest = xml.substr(pos);
+            if (rest.compare(0, 4, "<!--") == 0)
+            {
+                size_t end = xml.find("-->", pos + 4);
+                if (end == std::string_view::npos)
+                {
+                    return error("Unterminated comment", pos);
+                }
+                pos = end + 3;
+            }
+            else if (rest.compare(0, 9, "<![CDATA[") == 0)
+            {
+                size_t end = xml.find("]]>", pos + 9);
+                if (end == std::string_view::npos)
+                {
+                    return error("Unterminated CDATA section", pos);
+                }
+                if (open.empty())
+                {
+                    return error("CDATA outside the root element", pos);
+                }
+                if (!scanText(pos + 9, end - pos - 9, true))
+                {
+                    return false;
+                }
+                pos = end + 3;
+            }
+            else if (rest.compare(0, 2, "<?") == 0)
+            {
+                size_t end = xml.find("?>", pos + 2);
+                if (end == std::string_view::npos)
+                {
+                    return error("Unterminated processing instruction", pos);
+                }
+                pos = end + 2;
+            }
+            else if (rest.compare(0, 2, "<!") == 0)
+            {
+                // Document type declaration, possibly with an internal subset
+                if (!open.empty() || rootSeen)
+                {
+                    return error("Misplaced declaration", pos);
+                }
+                int depth = 0;
+                size_t end = pos + 2;
+                for (; end < size && (xml[end] != '>' || depth > 0); end++)
+                {
+                    depth += xml[end] == '[' ? 1 : (xml[end] == ']' ? -1 : 0);
+                }
+                if (end == size)
+                {
+                    return error("Unterminated declaration", pos);
+                }
+                pos = end + 1;
+            }
+            else if (rest.compare(0, 2, "</") == 0)
+            {
+                size_t end = xml.find('>', pos);
+                if (end == std::string_view::npos)
+                {
+                    return error("Unterminated end tag", pos);
+                }
+                std::string_view name = xml.substr(pos + 2, end - pos - 2);
+                while (!name.empty() && isSpace(name.back()))
+                {
+                    name.remove_suffix(1);
+                }
+                if (open.empty() || open.back() != name)
+                {
+                    return error("Mismatched end tag </" + std::string(name) + ">", pos);
+                }
+                open.pop_back();
+                pos = end + 1;
+            }
+            else
+            {
+                size_t nameEnd = pos + 1;
+                while (nameEnd < size && !isSpace(xml[nameEnd]) && xml[nameEnd] != '>' && xml[nameEnd] != '/')
+                {
+                    nameEnd++;
+                }
+                if (nameEnd == pos + 1)
+                {
+                    return error("Invalid start tag", pos);
+                }
+
+                // Find the end of the tag, skipping quoted attribute values
+                size_t end = nameEnd;
+                char quote = 0;
+                for (; end < size; end++)
+                {
+                    char c = xml[end];
+                    if (quote != 0)
+                    {
+                        quote = c == quote ? 0 : quote;
+                    }
+                    else if (c == '"' || c == '\'')
+                    {
+                        quote = c;
+                    }
+                    else if (c == '<')
+                    {
+                        return error("Invalid character in tag", end);
+                    }
+                    else if (c == '>')
+                    {
+                        break;
+                    }
+                }
+                if (end == size)
+                {
+                    return error("Unterminated start tag", pos);
+                }
+
+                if (open.empty())
+                {
+                    if (rootSeen)
+                    {
+                        return error("More than one root element", pos);
+                    }
+                    rootSeen = true;
+                }
+                if (xml[end - 1] != '/')
+                {
+                    open.push_back(xml.substr(pos + 1, nameEnd - pos - 1));
+                }
+                pos = end + 1;
+            }
+        }
+
+        if (!open.empty())
+        {
+            return error("Unclosed element <" + std::string(open.back()) + ">", size);
+        }
+        if (!rootSeen)
+        {
+            return error("No root element", size);
+        }
+
+        loaded_ = true;
+        lastError_ = "";
+        return true;
+    }
+
+    bool SpliceTemplate::scanText(size_t offset, size_t length, bool cdata)
+    {
+        std::string_view text = std::string_view(xml_).substr(offset, length);
+
+        PlaceholderScanner scanner(text);
+        PlaceholderScanner::Match match;
+        while (scanner.next(match))
+        {
+            if ((!cdata && match.placeholder.find('&') != std::string_view::npos) ||
+                match.placeholder.find('\r') != std::string_view::npos)
+            {
+                lastError_ = "Placeholder " + std::string(match.placeholder) +
+                             " is not the same once parsed (offset " + std::to_string(offset + match.offset) + ")";
+                return false;
+            }
+            placeholders_.push_back(Placeholder{offset + match.offset, static_cast<uint32_t>(match.placeholder.size()),
+                                                symbols_.intern(match.name), cdata});
+        }
+        return true;
+    }
+
+    bool SpliceTemplate::isLoaded() const
+    {
+        return loaded_;
+    }
+
+    std::string_view SpliceTemplate::getXml() const
+    {
+        return xml_;
+    }
+
+    const SymbolTable &SpliceTemplate::getSymbols() const
+    {
+        return symbols_;
+    }
+
+    const std::vector<SpliceTemplate::Placeholder> &SpliceTemplate::getPlaceholders() const
+    {
+        return placeholders_;
+    }
+
+    int SpliceTemplate::render(const SymbolValues &values, OutputSink &sink) const
+    {
+        // Escape each bound value once, however often it occurs. Escaped
+        // copies go to one buffer, so the views are taken once it is complete
+        const size_t symbolCount = symbols_.size();
+        std::string escaped;
+        std::vector<size_t> escapedAt(2 * symbolCount, std::string::npos);
+        for (uint32_t id = 0; id < symbolCount; id++)
+        {
+            std::string_view value;
+            if (!values.get(id, value))
+            {
+                continue;
+            }
+            if (std::any_of(value.begin(), value.end(), [](char c)
+                            { return needsEscape(static_cast<unsigned char>(c)); }))
+            {
+                escapedAt[2 * id] = escaped.size();
+                appendEscaped(escaped, value);
+                escapedAt[2 * id + 1] = escaped.size();
+            }
+        }
+
+        std::vector<std::string_view> parts;
+        parts.reserve(2 * kGatherBatch + 1);
+        std::string cdata; // Split CDATA values, built per occurrence
+        std::string_view xml = xml_;
+        size_t copied = 0;
+        int replaced = 0;
+
+        for (const Placeholder &placeholder : placeholders_)
+        {
+            std::string_view value;
+            if (!values.get(placeholder.symbol, value))
+            {
+                continue;
+            }
+            if (placeholder.cdata)
+            {
+                if (value.find("]]>") != std::string_view::npos)
+                {
+                    // Written right away, since the next one reuses the buffer
+                    parts.push_back(xml.substr(copied, placeholder.offset - copied));
+                    cdata.clear();
+                    appendCdata(cdata, value);
+                    parts.push_back(cdata);
+                    if (!sink.writev(parts.data(), parts.size()))
+                    {
+                        return -1;
+                    }
+                    parts.clear();
+                    copied = placeholder.offset + placeholder.length;
+                    replaced++;
+                    continue;
+                }
+            }
+            else if (escapedAt[2 * placeholder.symbol] != std::string::npos)
+            {
+                size_t begin = escapedAt[2 * placeholder.symbol];
+                value = std::string_view(escaped).substr(begin, escapedAt[2 * placeholder.symbol + 1] - begin);
+            }
+
+            parts.push_back(xml.substr(copied, placeholder.offset - copied));
+            parts.push_back(value);
+            copied = placeholder.offset + placeholder.length;
+            replaced++;
+
+            if (parts.size() >= 2 * kGatherBatch)
+            {
+                if (!sink.writev(parts.data(), parts.size()))
+                {
+                    return -1;
+                }
+                parts.clear();
+            }
+        }
+
+        parts.push_back(xml.substr(copied));
+        if (!sink.writev(parts.data(), parts.size()) || !sink.flush())
+        {
+            return -1;
+        }
+        return replaced;
+    }
+
+    int SpliceTemplate::render(const std::map<std::string, std::string> &variables, OutputSink &sink) const
+    {
+        SymbolValues values;
+        values.reset(symbols_.size());
+        for (uint32_t id = 0; id < symbols_.size(); id++)
+        {
+            auto it = variables.find(std::string(symbols_.name(id)));
+            if (it != variables.end())
+            {
+                values.set(id, it->second);
+            }
+        }
+        return render(values, sink);
+    }
+
+    std::string SpliceTemplate::getLastError() const
+    {
+        return lastError_;
+    }
+
+} // namespace json2doc
@@ -0,0 +1,233 @@
+#include "json2doc/structural_index.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define JSON2DOC_X86 1
+#include <immintrin.h>
+#endif
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Bytes indexed per refill; a multiple of the 64-byte block size
+        const size_t kWindowSize = 64 * 1024;
+
+        struct ScalarTable
+        {
+            bool structural[256];
+
+            ScalarTable()
+            {
+                std::memset(structural, 0, sizeof(structural));
+                for (unsigned char c : std::string("\"\\{}[]:,"))
+                {
+                    structural[c] = true;
+                }
+            }
+        };
+
+        const ScalarTable &scalarTable()
+        {
+            static const ScalarTable table;
+            return table;
+        }
+
+        uint64_t blockMaskScalar(const char *block)
+        {
+            const ScalarTable &table = scalarTable();
+            uint64_t mask = 0;
+            for (int i = 0; i < 64; i++)
+            {
+                if (table.structural[static_cast<unsigned char>(block[i])])
+                {
+                    mask |= uint64_t(1) << i;
+                }
+            }
+            return mask;
+        }
+
+#ifdef JSON2DOC_X86
+        // Nibble lookup: a byte is structural when the bit sets selected by its
+        // low and high nibbles intersect.
+        //   bit0 '"' 0x22   bit1 ',' 0x2C   bit2 ':' 0x3A
+        //   bit3 '[' '\' ']' 0x5B-0x5D      bit4 '{' '}' 0x7B 0x7D
+        __attribute__((target("avx2"))) uint64_t blockMaskAvx2(const char *block)
+        {
+            const __m256i loTable = _mm256_setr_epi8(
+                0, 0, 0x01, 0, 0, 0, 0, 0, 0, 0, 0x04, 0x18, 0x0A, 0x18, 0, 0,
+                0, 0, 0x01, 0, 0, 0, 0, 0, 0, 0, 0x04, 0x18, 0x0A, 0x18, 0, 0);
+            const __m256i hiTable = _mm256_setr_epi8(
+                0, 0, 0x03, 0x04, 0, 0x08, 0, 0x10, 0, 0, 0, 0, 0, 0, 0, 0,
+                0, 0, 0x03, 0x04, 0, 0x08, 0, 0x10, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            const __m256i zero = _mm256_setzero_si256();
+
+            uint64_t mask = 0;
+            for (int half = 0; half < 2; half++)
+            {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + half * 32));
+                __m256i lo = _mm256_shuffle_epi8(loTable, _mm256_and_si256(in, nibble));
+                __m256i hi = _mm256_shuffle_epi8(hiTable, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+                __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), zero);
+                uint32_t bits = ~static_cast<uint32_t>(_mm256_movemask_epi8(miss));
+                mask |= static_cast<uint64_t>(bits) << (half * 32);
+            }
+            return mask;
+        }
+
+        __attribute__((target("sse4.2"))) uint64_t blockMaskSse42(const char *block)
+        {
+            const __m128i set = _mm_setr_epi8('"', '\\', '{', '}', '[', ']', ':', ',',
+                                              0, 0, 0, 0, 0, 0, 0, 0);
+
+            uint64_t mask = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+                __m128i hits = _mm_cmpestrm(set, 8, in, 16,
+                                            _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+                uint64_t bits = static_cast<uint32_t>(_mm_cvtsi128_si32(hits)) & 0xFFFF;
+                mask |= bits << (i * 16);
+            }
+            return mask;
+        }
+#endif
+
+        typedef uint64_t (*BlockMaskFn)(const char *);
+
+        BlockMaskFn kernelFor(StructuralIndex::Backend backend)
+        {
+#ifdef JSON2DOC_X86
+            switch (backend)
+            {
+            case StructuralIndex::Backend::Avx2:
+                return blockMaskAvx2;
+            case StructuralIndex::Backend::Sse42:
+                return blockMaskSse42;
+            default:
+                break;
+            }
+#endif
+            (void)backend;
+            return blockMaskScalar;
+        }
+
+        void appendPositions(uint64_t mask, uint32_t base, std::vector<uint32_t> &positions)
+        {
+            while (mask != 0)
+            {
+                positions.push_back(base + static_cast<uint32_t>(__builtin_ctzll(mask)));
+                mask &= mask - 1;
+            }
+        }
+    } // namespace
+
+    StructuralIndex::StructuralIndex(const char *data, size_t size, Backend backend)
+        : data_(data), size_(size), backend_(backend), windowStart_(0), windowEnd_(0), cursor_(0)
+    {
+        positions_.reserve(kWindowSize / 8);
+    }
+
+    size_t StructuralIndex::next()
+    {
+        while (cursor_ >= positions_.size())
+        {
+            if (!refill())
+            {
+                return size_;
+            }
+        }
+        return windowStart_ + positions_[cursor_++];
+    }
+
+    size_t StructuralIndex::peek()
+    {
+        while (cursor_ >= positions_.size())
+        {
+            if (!refill())
+            {
+                return size_;
+            }
+        }
+        return windowStart_ + positions_[cursor_];
+    }
+
+    bool StructuralIndex::refill()
+    {
+        if (windowEnd_ >= size_)
+        {
+            return false;
+        }
+
+        windowStart_ = windowEnd_;
+        windowEnd_ = std::min(size_, windowStart_ + kWindowSize);
+        positions_.clear();
+        cursor_ = 0;
+        classify(data_ + windowStart_, windowEnd_ - windowStart_, backend_, positions_);
+        return true;
+    }
+
+    void StructuralIndex::classify(const char *data, size_t size, Backend backend, std::vector<uint32_t> &positions)
+    {
+        BlockMaskFn blockMask = kernelFor(backend);
+
+        size_t offset = 0;
+        for (; offset + 64 <= size; offset += 64)
+        {
+            appendPositions(blockMask(data + offset), static_cast<uint32_t>(offset), positions);
+        }
+
+        if (offset < size)
+        {
+            // Pad the last partial block with non-structural bytes
+            char tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, data + offset, size - offset);
+            appendPositions(blockMask(tail), static_cast<uint32_t>(offset), positions);
+        }
+    }
+
+    StructuralIndex::Backend StructuralIndex::bestBackend()
+    {
+        static const Backend best = isSupported(Backend::Avx2)    ? Backend::Avx2
+                                    : isSupported(Backend::Sse42) ? Backend::Sse42
+                                                                  : Backend::Scalar;
+        return best;
+    }
+
+    bool StructuralIndex::isSupported(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Scalar:
+            return true;
+#ifdef JSON2DOC_X86
+        case Backend::Sse42:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.2");
+        case Backend::Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+        }
+    }
+
+    std::string StructuralIndex::backendName(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Avx2:
+            return "avx2";
+        case Backend::Sse42:
+            return "sse4.2";
+        default:
+            return "scalar";
+        }
+    }
+
+} // namespace json2doc
@@ -0,0 +1,98 @@
+#include "json2doc/symbol_table.h"
+
+namespace json2doc
+{
+
+    // ========== SymbolTable ==========
+
+    const uint32_t SymbolTable::npos;
+
+    SymbolTable::SymbolTable()
+        : names_(1024)
+    {
+    }
+
+    uint32_t SymbolTable::intern(std::string_view name)
+    {
+        // Entries are dense and never removed, so the entry position is the id
+        uint64_t keyHash = KeyIndex::hash(name);
+        const KeyIndex::Entry *entry = index_.find(name, keyHash);
+        if (entry != nullptr)
+        {
+            return static_cast<uint32_t>(entry - index_.entries().data());
+        }
+        return static_cast<uint32_t>(index_.insert(name, std::string_view(), keyHash, names_));
+    }
+
+    uint32_t SymbolTable::find(std::string_view name) const
+    {
+        const KeyIndex::Entry *entry = index_.find(name);
+        return entry != nullptr ? static_cast<uint32_t>(entry - index_.entries().data()) : npos;
+    }
+
+    std::string_view SymbolTable::name(uint32_t id) const
+    {
+        return index_.entries()[id].key;
+    }
+
+    size_t SymbolTable::size() const
+    {
+        return index_.size();
+    }
+
+    bool SymbolTable::empty() const
+    {
+        return index_.empty();
+    }
+
+    void SymbolTable::clear()
+    {
+        index_.clear();
+        names_.reset();
+    }
+
+    // ========== SymbolValues ==========
+
+    SymbolValues::SymbolValues()
+        : boundCount_(0)
+    {
+    }
+
+    void SymbolValues::reset(size_t count)
+    {
+        values_.assign(count, std::string_view());
+        bound_.assign(count, 0);
+        boundCount_ = 0;
+    }
+
+    void SymbolValues::set(uint32_t id, std::string_view value)
+    {
+        values_[id] = value;
+        if (!bound_[id])
+        {
+            bound_[id] = 1;
+            boundCount_++;
+        }
+    }
+
+    bool SymbolValues::get(uint32_t id, std::string_view &value) const
+    {
+        if (id >= bound_.size() || !bound_[id])
+        {
+            return false;
+        }
+        value = values_[id];
+        return true;
+    }
+
+    size_t SymbolValues::size() const
+    {
+        return values_.size();
+    }
+
+    size_t SymbolValues::boundCount() const
+    {
+        return boundCount_;
+    }
+
+} // namespace json2doc
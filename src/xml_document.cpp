@@ -1,13 +1,40 @@
 #include "json2doc/xml_document.h"
+#include "json2doc/placeholder_scanner.h"
+#include "json2doc/symbol_table.h"
+#include "json2doc/output_sink.h"
+#include "json2doc/xml_memory.h"
+#include "json2doc/edit_batch.h"
 #include <pugixml.hpp>
 #include <fstream>
 #include <sstream>
-#include <regex>
 #include <functional>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace json2doc
 {
 
+    // A compiled pugixml query and the expression it was compiled from
+    struct XmlDocument::CompiledXPath
+    {
+        std::string expression;
+        pugi::xpath_query query;
+
+        explicit CompiledXPath(const std::string &xpath)
+            : expression(xpath), query(expression.c_str())
+        {
+        }
+    };
+
     // PIMPL implementation to hide pugixml details from header
     class XmlDocument::Impl
     {
@@ -15,321 +42,1973 @@ namespace json2doc
         pugi::xml_document doc;
         bool valid = false;
 
+        // pugixml pages of doc (see XmlMemoryAccount); the limit applies to
+        // loads and copies
+        std::shared_ptr<XmlMemoryAccount> memory = std::make_shared<XmlMemoryAccount>();
+
+        // A text node holding placeholders: occurrences[first, first + count)
+        struct TextSlot
+        {
+            pugi::xml_node node;
+            uint32_t first;
+            uint32_t count;
+            size_t source; // Template text in templateText (bound documents only)
+            size_t length;
+        };
+
+        // One placeholder: its byte range in the node text and its symbol id
+        struct Occurrence
+        {
+            uint32_t offset;
+            uint32_t length;
+            uint32_t symbol;
+        };
+
+        // A text node (pcdata or CDATA) and the paragraph (w:p) holding it
+        struct TextRun
+        {
+            pugi::xml_node node;
+            uint32_t paragraph; // Index in paragraphs, noParagraph outside any
+        };
+        static constexpr uint32_t noParagraph = UINT32_MAX;
+
+        // Text table: every text node in document order, built with the
+        // placeholder index so text operations never walk the formatting
+        // elements (w:rPr, w:pPr, ...) between them. Dropped with the index,
+        // since whatever may change text may also add or remove text nodes
+        std::atomic<bool> runsBuilt{false};
+        std::vector<TextRun> runs;
+        std::vector<pugi::xml_node> paragraphs;
+
+        // Placeholder index, built by the first scan after a load and dropped
+        // whenever text may have changed
+        std::atomic<bool> indexed{false};
+
+        // Const methods may build the tables lazily after an edit, from
+        // several threads at once
+        std::mutex buildMutex;
+        SymbolTable symbols;
+        std::vector<TextSlot> texts;
+        std::vector<Occurrence> occurrences;
+
+        // Binding (bindVariables): the template text of every slot and, for
+        // each symbol, the slots using it (symbolSlots[symbolFirst[id] ..
+        // symbolFirst[id + 1]))
+        bool bound = false;
+        std::string templateText;
+        std::vector<uint32_t> symbolFirst;
+        std::vector<uint32_t> symbolSlots;
+
+        // Compiled XPath cache: most recently used first, indexed by expression
+        // (the keys view CompiledXPath::expression). Const queries use it, so
+        // every access holds xpathMutex
+        using CompiledPtr = std::shared_ptr<const CompiledXPath>;
+        std::list<CompiledPtr> xpathLru;
+        std::unordered_map<std::string_view, std::list<CompiledPtr>::iterator> xpathCache;
+        size_t xpathCapacity = 64;
+        size_t xpathHits = 0;
+        size_t xpathMisses = 0;
+        std::mutex xpathMutex;
+
         Impl() = default;
         ~Impl() = default;
+
+        CompiledPtr compile(const std::string &xpath);
+        void buildRuns();
+        void scanRuns();
+        void buildIndex();
+        void copyIndex(const Impl &proto);
+        void indexText(pugi::xml_node node);
+        void reindexTexts();
+        void dropIndex();
+        void bind();
+        int render(const TextSlot &slot, std::string_view text, const SymbolValues &values, std::string &result) const;
     };
 
-    XmlDocument::XmlDocument()
-        : pImpl_(std::make_unique<Impl>()),
-          lastError_("")
+    XmlDocument::Impl::CompiledPtr XmlDocument::Impl::compile(const std::string &xpath)
     {
-    }
+        std::lock_guard<std::mutex> lock(xpathMutex);
+        auto cached = xpathCache.find(xpath);
+        if (cached != xpathCache.end())
+        {
+            xpathLru.splice(xpathLru.begin(), xpathLru, cached->second);
+            xpathHits++;
+            return *cached->second;
+        }
 
-    XmlDocument::~XmlDocument()
-    {
-        clear();
+        // Throws pugi::xpath_exception for invalid expressions, which are not cached
+        xpathMisses++;
+        CompiledPtr compiled = std::make_shared<const CompiledXPath>(xpath);
+        if (xpathCapacity == 0)
+        {
+            return compiled;
+        }
+        if (xpathLru.size() >= xpathCapacity)
+        {
+            xpathCache.erase(xpathLru.back()->expression);
+            xpathLru.pop_back();
+        }
+        xpathLru.push_front(compiled);
+        xpathCache.emplace(compiled->expression, xpathLru.begin());
+        return compiled;
     }
 
-    bool XmlDocument::loadFromString(const std::string &xmlContent)
+    namespace
     {
-        clear();
+        // Collects pugixml output into a string without an ostringstream
+        struct StringWriter : pugi::xml_writer
+        {
+            std::string result;
 
-        pugi::xml_parse_result result = pImpl_->doc.load_string(xmlContent.c_str());
+            void write(const void *data, size_t size) override
+            {
+                result.append(static_cast<const char *>(data), size);
+            }
+        };
 
-        if (result)
+        // Passes pugixml output on to an OutputSink
+        struct SinkWriter : pugi::xml_writer
         {
-            pImpl_->valid = true;
-            lastError_ = "";
-            return true;
+            OutputSink &sink;
+
+            explicit SinkWriter(OutputSink &output)
+                : sink(output)
+            {
+            }
+
+            void write(const void *data, size_t size) override
+            {
+                sink.write(static_cast<const char *>(data), size);
+            }
+        };
+
+        // A {{#name}} or {{/name}} marker in the text of an element
+        struct SectionMarker
+        {
+            pugi::xml_node element;
+            std::string name;
+            bool open;
+        };
+
+        // An outermost pair of matching markers and the sibling range it repeats
+        struct Section
+        {
+            SectionMarker open;
+            SectionMarker close;
+            pugi::xml_node first;
+            pugi::xml_node last;
+        };
+
+        // Absolute XPaths of elements; same-named siblings get a position.
+        // Paths of ancestors and the positions of each parent's children are
+        // computed once, so the paths of many nodes cost linear time overall
+        class ElementPaths
+        {
+        public:
+            const std::string &get(pugi::xml_node node)
+            {
+                // Walk up to the nearest ancestor with a known path, then back down
+                std::vector<pugi::xml_node> chain;
+                const std::string *base = &empty_;
+                for (; node && node.type() == pugi::node_element; node = node.parent())
+                {
+                    auto found = paths_.find(node.internal_object());
+                    if (found != paths_.end())
+                    {
+                        base = &found->second;
+                        break;
+                    }
+                    chain.push_back(node);
+                }
+
+                for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+                {
+                    std::string path = *base + "/" + step(*it);
+                    base = &(paths_[it->internal_object()] = std::move(path));
+                }
+                return *base;
+            }
+
+        private:
+            struct Position
+            {
+                uint32_t index;
+                bool shared; // Another sibling has the same name
+            };
+
+            std::string empty_;
+            std::unordered_map<pugi::xml_node_struct *, std::string> paths_;
+            std::unordered_map<pugi::xml_node_struct *, Position> positions_;
+
+            std::string step(pugi::xml_node node)
+            {
+                auto found = positions_.find(node.internal_object());
+                if (found == positions_.end())
+                {
+                    numberChildren(node.parent());
+                    found = positions_.find(node.internal_object());
+                }
+
+                std::string step = node.name();
+                if (found->second.shared)
+                {
+                    step += "[" + std::to_string(found->second.index) + "]";
+                }
+                return step;
+            }
+
+            void numberChildren(pugi::xml_node parent)
+            {
+                std::unordered_map<std::string_view, uint32_t> counts;
+                for (pugi::xml_node child = parent.first_child(); child; child = child.next_sibling())
+                {
+                    if (child.type() == pugi::node_element)
+                    {
+                        positions_[child.internal_object()] = Position{++counts[child.name()], false};
+                    }
+                }
+                for (pugi::xml_node child = parent.first_child(); child; child = child.next_sibling())
+                {
+                    if (child.type() == pugi::node_element)
+                    {
+                        positions_[child.internal_object()].shared = counts[child.name()] > 1;
+                    }
+                }
+            }
+        };
+
+        bool isSectionMarker(std::string_view name)
+        {
+            return !name.empty() && (name[0] == '#' || name[0] == '/');
         }
-        else
+
+        std::string_view sectionName(std::string_view marker)
         {
-            pImpl_->valid = false;
-            lastError_ = std::string("XML parsing error: ") + result.description() +
-                         " at offset " + std::to_string(result.offset);
-            return false;
+            marker.remove_prefix(1);
+            while (!marker.empty() && std::isspace(static_cast<unsigned char>(marker.front())))
+            {
+                marker.remove_prefix(1);
+            }
+            return marker;
         }
-    }
 
-    bool XmlDocument::loadFromFile(const std::string &filePath)
-    {
-        clear();
+        void collectMarkers(pugi::xml_node node, std::vector<SectionMarker> &markers)
+        {
+            // Only elements: text() of a pcdata child would report the same text again
+            if (node.type() == pugi::node_element)
+            {
+                PlaceholderScanner scanner(node.text().as_string());
+                PlaceholderScanner::Match match;
+                while (scanner.next(match))
+                {
+                    if (isSectionMarker(match.name))
+                    {
+                        markers.push_back(SectionMarker{node, std::string(sectionName(match.name)), match.name[0] == '#'});
+                    }
+                }
+            }
 
-        pugi::xml_parse_result result = pImpl_->doc.load_file(filePath.c_str());
+            for (pugi::xml_node child : node.children())
+            {
+                collectMarkers(child, markers);
+            }
+        }
 
-        if (result)
+        // Keep the outermost matching pairs; stray and unclosed markers are ignored
+        void pairMarkers(const std::vector<SectionMarker> &markers, std::vector<Section> &sections)
         {
-            pImpl_->valid = true;
-            lastError_ = "";
-            return true;
+            std::vector<size_t> open;
+            for (size_t i = 0; i < markers.size(); i++)
+            {
+                if (markers[i].open)
+                {
+                    open.push_back(i);
+                    continue;
+                }
+
+                size_t depth = open.size();
+                while (depth > 0 && markers[open[depth - 1]].name != markers[i].name)
+                {
+                    depth--;
+                }
+                if (depth == 0)
+                {
+                    continue;
+                }
+
+                size_t match = open[depth - 1];
+                open.resize(depth - 1);
+                if (open.empty())
+                {
+                    sections.push_back(Section{markers[match], markers[i], pugi::xml_node(), pugi::xml_node()});
+                }
+            }
         }
-        else
+
+        // Nearest ancestor-or-self with the given name, stopping below scope
+        pugi::xml_node ancestorNamed(pugi::xml_node node, const char *name, pugi::xml_node scope)
         {
-            pImpl_->valid = false;
-            lastError_ = std::string("XML file error: ") + result.description() +
-                         " (file: " + filePath + ")";
+            for (; node && node != scope; node = node.parent())
+            {
+                if (std::strcmp(node.name(), name) == 0)
+                {
+                    return node;
+                }
+            }
+            return pugi::xml_node();
+        }
+
+        // Child of parent on the way up from node, null if node is not below parent
+        pugi::xml_node childOf(pugi::xml_node parent, pugi::xml_node node)
+        {
+            while (node && node.parent() != parent)
+            {
+                node = node.parent();
+            }
+            return node;
+        }
+
+        pugi::xml_node commonAncestor(pugi::xml_node a, pugi::xml_node b)
+        {
+            std::vector<pugi::xml_node> path;
+            for (; a; a = a.parent())
+            {
+                path.push_back(a);
+            }
+            for (; b; b = b.parent())
+            {
+                for (const auto &node : path)
+                {
+                    if (node == b)
+                    {
+                        return b;
+                    }
+                }
+            }
+            return pugi::xml_node();
+        }
+
+        // Choose the sibling range a section repeats. The range must lie below
+        // scope, must not be the document element and must not reach the
+        // markers of the neighbouring sections.
+        bool sectionRange(Section &section, pugi::xml_node scope, pugi::xml_node previous, pugi::xml_node next)
+        {
+            auto usable = [&](pugi::xml_node first, pugi::xml_node last)
+            {
+                if (!first || !last || first.parent() != last.parent() ||
+                    first.parent().type() == pugi::node_document)
+                {
+                    return false;
+                }
+                pugi::xml_node parent = first.parent();
+                return (!previous || childOf(parent, previous) != first) && (!next || childOf(parent, next) != last);
+            };
+
+            for (const char *unit : {"w:tr", "w:p"})
+            {
+                pugi::xml_node first = ancestorNamed(section.open.element, unit, scope);
+                pugi::xml_node last = ancestorNamed(section.close.element, unit, scope);
+                if (usable(first, last))
+                {
+                    section.first = first;
+                    section.last = last;
+                    return true;
+                }
+            }
+
+            pugi::xml_node first = section.open.element;
+            pugi::xml_node last = section.close.element;
+            if (first != last)
+            {
+                pugi::xml_node ancestor = commonAncestor(first, last);
+                first = childOf(ancestor, first);
+                last = childOf(ancestor, last);
+            }
+            if (usable(first, last))
+            {
+                section.first = first;
+                section.last = last;
+                return true;
+            }
             return false;
         }
+
+        // Remove the first {{#name}} or {{/name}} marker from the text of an element
+        void removeMarker(pugi::xml_node element, const SectionMarker &marker)
+        {
+            pugi::xml_text text = element.text();
+            std::string_view value = text.as_string();
+            PlaceholderScanner scanner(value);
+            PlaceholderScanner::Match match;
+            while (scanner.next(match))
+            {
+                if (isSectionMarker(match.name) && (match.name[0] == '#') == marker.open &&
+                    sectionName(match.name) == marker.name)
+                {
+                    std::string result(value.substr(0, match.offset));
+                    result.append(value.substr(match.offset + match.placeholder.size()));
+                    text.set(result.c_str());
+                    return;
+                }
+            }
+        }
+
+        // Scope the placeholders of one copy to element prefix ("items.3").
+        // Markers of nested sections are scoped too and collected; placeholders
+        // inside nested sections are left for the nested expansion.
+        void scopeCopy(pugi::xml_node node, const std::string &prefix, const XmlDocument::VariableLookup &lookup,
+                       size_t &depth, std::vector<SectionMarker> &markers)
+        {
+            if (node.type() == pugi::node_element)
+            {
+                pugi::xml_text text = node.text();
+                std::string_view value = text.as_string();
+                PlaceholderScanner scanner(value);
+                PlaceholderScanner::Match match;
+                std::string result;
+                std::string scoped;
+                std::string_view resolved;
+                size_t copied = 0;
+
+                while (scanner.next(match))
+                {
+                    bool marker = isSectionMarker(match.name);
+                    bool open = marker && match.name[0] == '#';
+                    if (marker && !open && depth > 0)
+                    {
+                        depth--;
+                    }
+
+                    scoped.clear();
+                    if (depth == 0)
+                    {
+                        if (marker)
+                        {
+                            std::string name = prefix + "." + std::string(sectionName(match.name));
+                            markers.push_back(SectionMarker{node, name, open});
+                            scoped = match.name[0] + name;
+                        }
+                        else if (match.name == ".")
+                        {
+                            scoped = prefix;
+                        }
+                        else
+                        {
+                            std::string name = prefix + "." + std::string(match.name);
+                            if (lookup(name, resolved))
+                            {
+                                scoped = name;
+                            }
+                        }
+                    }
+
+                    if (open)
+                    {
+                        depth++;
+                    }
+
+                    if (!scoped.empty())
+                    {
+                        result.append(value.data() + copied, match.offset - copied);
+                        result += "{{";
+                        result += scoped;
+                        result += "}}";
+                        copied = match.offset + match.placeholder.size();
+                    }
+                }
+
+                if (copied > 0)
+                {
+                    result.append(value.data() + copied, value.size() - copied);
+                    text.set(result.c_str());
+                }
+            }
+
+            for (pugi::xml_node child : node.children())
+            {
+                scopeCopy(child, prefix, lookup, depth, markers);
+            }
+        }
+
+        int expandAll(std::vector<Section> &sections, pugi::xml_node scope, const XmlDocument::SectionLookup &count,
+                      const XmlDocument::VariableLookup &lookup);
+
+        int expandSection(const Section &section, const XmlDocument::SectionLookup &count,
+                          const XmlDocument::VariableLookup &lookup)
+        {
+            // The block itself becomes the prototype of every copy
+            removeMarker(section.open.element, section.open);
+            removeMarker(section.close.element, section.close);
+
+            pugi::xml_node parent = section.first.parent();
+            size_t copies = count(section.open.name);
+            int expanded = 1;
+
+            std::vector<SectionMarker> markers;
+            std::vector<Section> nested;
+            for (size_t i = 0; i < copies; i++)
+            {
+                std::string prefix = section.open.name + "." + std::to_string(i);
+                size_t depth = 0;
+                markers.clear();
+                for (pugi::xml_node node = section.first;; node = node.next_sibling())
+                {
+                    pugi::xml_node copy = parent.insert_copy_before(node, section.first);
+                    scopeCopy(copy, prefix, lookup, depth, markers);
+                    if (node == section.last)
+                    {
+                        break;
+                    }
+                }
+
+                // Nested sections only ever repeat nodes of this copy
+                nested.clear();
+                pairMarkers(markers, nested);
+                expanded += expandAll(nested, parent, count, lookup);
+            }
+
+            pugi::xml_node node = section.first;
+            while (node)
+            {
+                pugi::xml_node next = node.next_sibling();
+                bool done = node == section.last;
+                parent.remove_child(node);
+                if (done)
+                {
+                    break;
+                }
+                node = next;
+            }
+
+            return expanded;
+        }
+
+        int expandAll(std::vector<Section> &sections, pugi::xml_node scope, const XmlDocument::SectionLookup &count,
+                      const XmlDocument::VariableLookup &lookup)
+        {
+            // Ranges are chosen before anything is cloned or removed
+            std::vector<bool> usable(sections.size());
+            for (size_t i = 0; i < sections.size(); i++)
+            {
+                pugi::xml_node previous = i > 0 ? sections[i - 1].close.element : pugi::xml_node();
+                pugi::xml_node next = i + 1 < sections.size() ? sections[i + 1].open.element : pugi::xml_node();
+                usable[i] = sectionRange(sections[i], scope, previous, next);
+            }
+
+            int expanded = 0;
+            for (size_t i = 0; i < sections.size(); i++)
+            {
+                if (usable[i])
+                {
+                    expanded += expandSection(sections[i], count, lookup);
+                }
+            }
+            return expanded;
+        }
+
+        // A w:t element and where its text starts in the joined text of its group
+        struct RunText
+        {
+            pugi::xml_node element;
+            size_t offset;
+        };
+
+        // Move every placeholder that spans several w:t of a group into the
+        // first of them: a piece starting inside a placeholder starts after
+        // it instead. Pieces left empty are removed, with their run when it
+        // holds nothing else. Returns the number of placeholders merged.
+        int mergeGroup(const std::vector<RunText> &pieces, const std::string &joined)
+        {
+            const size_t count = pieces.size();
+            if (count < 2 || joined.find("{{") == std::string::npos)
+            {
+                return 0;
+            }
+
+            std::vector<size_t> starts(count + 1);
+            for (size_t i = 0; i < count; i++)
+            {
+                starts[i] = pieces[i].offset;
+            }
+            starts[count] = joined.size();
+
+            int merged = 0;
+            size_t piece = 1;
+            PlaceholderScanner scanner(joined);
+            PlaceholderScanner::Match match;
+            while (scanner.next(match))
+            {
+                size_t end = match.offset + match.placeholder.size();
+                while (piece < count && starts[piece] <= match.offset)
+                {
+                    piece++;
+                }
+                bool split = false;
+                for (; piece < count && starts[piece] < end; piece++)
+                {
+                    starts[piece] = end;
+                    split = true;
+                }
+                merged += split ? 1 : 0;
+            }
+            if (merged == 0)
+            {
+                return 0;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t oldEnd = i + 1 < count ? pieces[i + 1].offset : joined.size();
+                if (starts[i] == pieces[i].offset && starts[i + 1] == oldEnd)
+                {
+                    continue;
+                }
+
+                pugi::xml_node element = pieces[i].element;
+                std::string text = joined.substr(starts[i], starts[i + 1] - starts[i]);
+                if (text.empty())
+                {
+                    pugi::xml_node run = element.parent();
+                    run.remove_child(element);
+                    bool formattingOnly = std::string_view(run.name()) == "w:r";
+                    for (pugi::xml_node child = run.first_child(); child && formattingOnly; child = child.next_sibling())
+                    {
+                        formattingOnly = std::string_view(child.name()) == "w:rPr";
+                    }
+                    if (formattingOnly)
+                    {
+                        run.parent().remove_child(run);
+                    }
+                    continue;
+                }
+
+                element.text().set(text.c_str());
+                if ((isspace(static_cast<unsigned char>(text.front())) || isspace(static_cast<unsigned char>(text.back()))) &&
+                    !element.attribute("xml:space"))
+                {
+                    element.append_attribute("xml:space").set_value("preserve");
+                }
+            }
+            return merged;
+        }
+
+        // Split the w:t of a paragraph into groups of text that reads as one
+        // piece (runs separated only by run boundaries, proofing marks,
+        // bookmarks and the like) and merge each group. Other run content
+        // (tabs, breaks, drawings) ends a group; nested paragraphs (text
+        // boxes) are merged on their own.
+        int mergeParagraph(pugi::xml_node paragraph, std::vector<RunText> &pieces, std::string &joined)
+        {
+            int merged = 0;
+            pieces.clear();
+            joined.clear();
+            auto endGroup = [&]()
+            {
+                merged += mergeGroup(pieces, joined);
+                pieces.clear();
+                joined.clear();
+            };
+
+            pugi::xml_node node = paragraph.first_child();
+            while (node)
+            {
+                bool descend = node.type() == pugi::node_element;
+                if (descend)
+                {
+                    std::string_view name = node.name();
+                    if (name == "w:t")
+                    {
+                        pieces.push_back(RunText{node, joined.size()});
+                        joined += node.text().get();
+                        descend = false;
+                    }
+                    else if (name == "w:p" ||
+                             (std::string_view(node.parent().name()) == "w:r" && name != "w:rPr" &&
+                              name != "w:lastRenderedPageBreak"))
+                    {
+                        endGroup();
+                        descend = false;
+                    }
+                }
+
+                if (descend && node.first_child())
+                {
+                    node = node.first_child();
+                    continue;
+                }
+                while (node != paragraph && !node.next_sibling())
+                {
+                    node = node.parent();
+                }
+                node = node == paragraph ? pugi::xml_node() : node.next_sibling();
+            }
+            endGroup();
+            return merged;
+        }
+    } // namespace
+
+    void XmlDocument::Impl::buildRuns()
+    {
+        if (runsBuilt)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(buildMutex);
+        if (!runsBuilt)
+        {
+            scanRuns();
+        }
+    }
+
+    void XmlDocument::Impl::scanRuns()
+    {
+        runs.clear();
+        paragraphs.clear();
+
+        // Visit every node in document order without recursion, keeping the
+        // paragraphs (nested in text boxes, say) that enclose the current one
+        std::vector<uint32_t> open;
+        pugi::xml_node root = doc.document_element();
+        pugi::xml_node node = root;
+        while (node)
+        {
+            pugi::xml_node_type type = node.type();
+            if (type == pugi::node_pcdata || type == pugi::node_cdata)
+            {
+                runs.push_back(TextRun{node, open.empty() ? noParagraph : open.back()});
+            }
+            else if (type == pugi::node_element && std::strcmp(node.name(), "w:p") == 0)
+            {
+                open.push_back(static_cast<uint32_t>(paragraphs.size()));
+                paragraphs.push_back(node);
+            }
+
+            if (node.first_child())
+            {
+                node = node.first_child();
+                continue;
+            }
+
+            // Leave the node and every ancestor without a next sibling
+            while (true)
+            {
+                if (!open.empty() && paragraphs[open.back()] == node)
+                {
+                    open.pop_back();
+                }
+                if (node == root)
+                {
+                    node = pugi::xml_node();
+                    break;
+                }
+                if (node.next_sibling())
+                {
+                    node = node.next_sibling();
+                    break;
+                }
+                node = node.parent();
+            }
+        }
+
+        runsBuilt = true;
+    }
+
+    void XmlDocument::Impl::buildIndex()
+    {
+        if (indexed)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(buildMutex);
+        if (indexed)
+        {
+            return;
+        }
+
+        symbols.clear();
+        texts.clear();
+        occurrences.clear();
+
+        if (!runsBuilt)
+        {
+            scanRuns();
+        }
+        for (const TextRun &run : runs)
+        {
+            indexText(run.node);
+        }
+
+        indexed = true;
+    }
+
+    void XmlDocument::Impl::copyIndex(const Impl &proto)
+    {
+        dropIndex();
+        if (!proto.indexed || !proto.runsBuilt)
+        {
+            buildIndex();
+            return;
+        }
+
+        // Same names in the same order get the same ids
+        for (uint32_t id = 0; id < proto.symbols.size(); id++)
+        {
+            symbols.intern(proto.symbols.name(id));
+        }
+        occurrences = proto.occurrences;
+
+        // doc is a copy of proto.doc, so walking both in step pairs every
+        // node with its copy; runs, paragraphs and slots are in document order
+        runs.reserve(proto.runs.size());
+        paragraphs.reserve(proto.paragraphs.size());
+        texts.reserve(proto.texts.size());
+        pugi::xml_node from = proto.doc;
+        pugi::xml_node to = doc;
+        size_t nextRun = 0;
+        size_t nextParagraph = 0;
+        size_t next = 0;
+        while (from && (nextRun < proto.runs.size() || nextParagraph < proto.paragraphs.size()))
+        {
+            if (nextParagraph < proto.paragraphs.size() && from == proto.paragraphs[nextParagraph])
+            {
+                paragraphs.push_back(to);
+                nextParagraph++;
+            }
+            else if (nextRun < proto.runs.size() && from == proto.runs[nextRun].node)
+            {
+                runs.push_back(TextRun{to, proto.runs[nextRun].paragraph});
+                nextRun++;
+                if (next < proto.texts.size() && from == proto.texts[next].node)
+                {
+                    texts.push_back(TextSlot{to, proto.texts[next].first, proto.texts[next].count, 0, 0});
+                    next++;
+                }
+            }
+
+            if (from.first_child())
+            {
+                from = from.first_child();
+                to = to.first_child();
+                continue;
+            }
+            while (from && !from.next_sibling())
+            {
+                from = from.parent();
+                to = to.parent();
+            }
+            if (from)
+            {
+                from = from.next_sibling();
+                to = to.next_sibling();
+            }
+        }
+
+        if (nextRun != proto.runs.size() || nextParagraph != proto.paragraphs.size() || next != proto.texts.size())
+        {
+            // Tables not in document order: scan the copy instead
+            dropIndex();
+            buildIndex();
+            return;
+        }
+        runsBuilt = true;
+        indexed = true;
+    }
+
+    void XmlDocument::Impl::indexText(pugi::xml_node node)
+    {
+        PlaceholderScanner scanner(node.value());
+        PlaceholderScanner::Match match;
+        size_t first = occurrences.size();
+        while (scanner.next(match))
+        {
+            occurrences.push_back(Occurrence{static_cast<uint32_t>(match.offset),
+                                             static_cast<uint32_t>(match.placeholder.size()),
+                                             symbols.intern(match.name)});
+        }
+        if (occurrences.size() > first)
+        {
+            texts.push_back(TextSlot{node, static_cast<uint32_t>(first),
+                                     static_cast<uint32_t>(occurrences.size() - first), 0, 0});
+        }
+    }
+
+    void XmlDocument::Impl::reindexTexts()
+    {
+        // Only indexed nodes can have changed, so rescan just those: nodes
+        // whose placeholders were all replaced drop out, and placeholders
+        // brought in by values are picked up
+        std::vector<pugi::xml_node> nodes;
+        nodes.reserve(texts.size());
+        for (const auto &slot : texts)
+        {
+            nodes.push_back(slot.node);
+        }
+
+        symbols.clear();
+        texts.clear();
+        occurrences.clear();
+        for (pugi::xml_node node : nodes)
+        {
+            indexText(node);
+        }
+    }
+
+    void XmlDocument::Impl::dropIndex()
+    {
+        runsBuilt = false;
+        runs.clear();
+        paragraphs.clear();
+
+        indexed = false;
+        symbols.clear();
+        texts.clear();
+        occurrences.clear();
+
+        bound = false;
+        templateText.clear();
+        symbolFirst.clear();
+        symbolSlots.clear();
+    }
+
+    void XmlDocument::Impl::bind()
+    {
+        buildIndex();
+        if (bound)
+        {
+            return;
+        }
+
+        templateText.clear();
+        for (auto &slot : texts)
+        {
+            std::string_view text = slot.node.value();
+            slot.source = templateText.size();
+            slot.length = text.size();
+            templateText.append(text);
+        }
+
+        // Count the slots of every symbol, then fill them in document order
+        symbolFirst.assign(symbols.size() + 1, 0);
+        std::vector<uint32_t> last(symbols.size(), 0xffffffffu);
+        for (uint32_t s = 0; s < texts.size(); s++)
+        {
+            for (uint32_t i = texts[s].first; i < texts[s].first + texts[s].count; i++)
+            {
+                uint32_t symbol = occurrences[i].symbol;
+                if (last[symbol] != s)
+                {
+                    last[symbol] = s;
+                    symbolFirst[symbol + 1]++;
+                }
+            }
+        }
+        for (size_t id = 0; id < symbols.size(); id++)
+        {
+            symbolFirst[id + 1] += symbolFirst[id];
+        }
+
+        symbolSlots.assign(symbolFirst.back(), 0);
+        std::vector<uint32_t> fill(symbolFirst.begin(), symbolFirst.end() - 1);
+        std::fill(last.begin(), last.end(), 0xffffffffu);
+        for (uint32_t s = 0; s < texts.size(); s++)
+        {
+            for (uint32_t i = texts[s].first; i < texts[s].first + texts[s].count; i++)
+            {
+                uint32_t symbol = occurrences[i].symbol;
+                if (last[symbol] != s)
+                {
+                    last[symbol] = s;
+                    symbolSlots[fill[symbol]++] = s;
+                }
+            }
+        }
+
+        bound = true;
+    }
+
+    int XmlDocument::Impl::render(const TextSlot &slot, std::string_view text, const SymbolValues &values,
+                                  std::string &result) const
+    {
+        int replacements = 0;
+        size_t copied = 0;
+        result.clear();
+
+        for (uint32_t i = slot.first; i < slot.first + slot.count; i++)
+        {
+            const Occurrence &occurrence = occurrences[i];
+            std::string_view value;
+            if (values.get(occurrence.symbol, value))
+            {
+                result.append(text.data() + copied, occurrence.offset - copied);
+                result.append(value);
+                copied = occurrence.offset + occurrence.length;
+                replacements++;
+            }
+        }
+
+        result.append(text.data() + copied, text.size() - copied);
+        return replacements;
+    }
+
+    namespace
+    {
+        // The steps of plain child paths, as a trie
+        struct PathTrie
+        {
+            static constexpr uint32_t noStep = UINT32_MAX;
+
+            // The child steps of a trie node testing the same element name
+            struct Group
+            {
+                std::string name;
+                uint32_t every = noStep;                              // Step without a position
+                std::vector<std::pair<uint32_t, uint32_t>> positions; // (position, step), by position
+                uint32_t count = 0;                                   // Scratch of resolvePaths()
+                size_t cursor = 0;
+            };
+
+            struct Step
+            {
+                std::vector<uint32_t> expressions; // Ids of the paths ending here
+                std::vector<Group> groups;
+            };
+
+            std::vector<Step> steps = std::vector<Step>(1); // steps[0] stands for the document
+        };
+
+        // Split a plain child path (/a/b[2]/c: element names and positions
+        // only) into its steps; false for any other expression
+        bool splitPlainPath(std::string_view xpath, std::vector<std::pair<std::string_view, uint32_t>> &steps)
+        {
+            steps.clear();
+            size_t pos = 0;
+            while (pos < xpath.size())
+            {
+                if (xpath[pos] != '/')
+                {
+                    return false;
+                }
+                size_t begin = ++pos;
+                while (pos < xpath.size() && (std::isalnum(static_cast<unsigned char>(xpath[pos])) || xpath[pos] == '_' ||
+                                              xpath[pos] == '-' || xpath[pos] == '.' || xpath[pos] == ':'))
+                {
+                    pos++;
+                }
+                std::string_view name = xpath.substr(begin, pos - begin);
+                size_t colon = name.find(':');
+                if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_') ||
+                    (colon != std::string_view::npos && (colon + 1 == name.size() || name.find(':', colon + 1) != std::string_view::npos ||
+                                                         !std::isalpha(static_cast<unsigned char>(name[colon + 1])))))
+                {
+                    return false;
+                }
+
+                uint32_t position = 0;
+                if (pos < xpath.size() && xpath[pos] == '[')
+                {
+                    size_t digits = ++pos;
+                    while (pos < xpath.size() && std::isdigit(static_cast<unsigned char>(xpath[pos])) && pos - digits < 9)
+                    {
+                        position = position * 10 + static_cast<uint32_t>(xpath[pos] - '0');
+                        pos++;
+                    }
+                    if (pos == digits || pos == xpath.size() || xpath[pos] != ']' || position == 0)
+                    {
+                        return false;
+                    }
+                    pos++;
+                }
+                steps.emplace_back(name, position);
+            }
+            return !steps.empty();
+        }
+
+        // Get the trie node for a step below parent, adding it if it is new
+        uint32_t addPathStep(PathTrie &trie, uint32_t parent, std::string_view name, uint32_t position)
+        {
+            auto &groups = trie.steps[parent].groups;
+            auto group = std::find_if(groups.begin(), groups.end(), [name](const PathTrie::Group &candidate)
+                                      { return candidate.name == name; });
+            if (group == groups.end())
+            {
+                groups.push_back(PathTrie::Group());
+                group = groups.end() - 1;
+                group->name = std::string(name);
+            }
+
+            // Adding the step moves trie.steps, so the group is updated first
+            uint32_t next = static_cast<uint32_t>(trie.steps.size());
+            if (position == 0)
+            {
+                if (group->every != PathTrie::noStep)
+                {
+                    return group->every;
+                }
+                group->every = next;
+            }
+            else
+            {
+                auto at = std::lower_bound(group->positions.begin(), group->positions.end(), std::make_pair(position, 0u));
+                if (at != group->positions.end() && at->first == position)
+                {
+                    return at->second;
+                }
+                group->positions.insert(at, std::make_pair(position, next));
+            }
+            trie.steps.emplace_back();
+            return next;
+        }
+
+        void resolvePaths(pugi::xml_node context, uint32_t step, PathTrie &trie,
+                          std::vector<std::vector<pugi::xml_node>> &targets);
+
+        // A node selected by a step: the target of the paths ending there and
+        // the context of the steps below
+        void visitPath(pugi::xml_node node, uint32_t step, PathTrie &trie,
+                       std::vector<std::vector<pugi::xml_node>> &targets)
+        {
+            for (uint32_t id : trie.steps[step].expressions)
+            {
+                targets[id].push_back(node);
+            }
+            resolvePaths(node, step, trie, targets);
+        }
+
+        // Match the children of context against the steps below a trie node
+        // in one pass over them; every path collects its nodes in document order
+        void resolvePaths(pugi::xml_node context, uint32_t step, PathTrie &trie,
+                          std::vector<std::vector<pugi::xml_node>> &targets)
+        {
+            // The walk only goes down the trie, so each node's scratch
+            // counters are free while its children are matched
+            auto &groups = trie.steps[step].groups;
+            if (groups.empty())
+            {
+                return;
+            }
+            for (auto &group : groups)
+            {
+                group.count = 0;
+                group.cursor = 0;
+            }
+
+            for (pugi::xml_node child = context.first_child(); child; child = child.next_sibling())
+            {
+                if (child.type() != pugi::node_element)
+                {
+                    continue;
+                }
+                for (auto &group : groups)
+                {
+                    if (std::strcmp(child.name(), group.name.c_str()) != 0)
+                    {
+                        continue;
+                    }
+                    group.count++;
+                    if (group.every != PathTrie::noStep)
+                    {
+                        visitPath(child, group.every, trie, targets);
+                    }
+                    if (group.cursor < group.positions.size() && group.positions[group.cursor].first == group.count)
+                    {
+                        visitPath(child, group.positions[group.cursor].second, trie, targets);
+                        group.cursor++;
+                    }
+                    break;
+                }
+            }
+        }
+    } // namespace
+
+    // Compiled form of an EditBatch
+    struct EditBatch::Plan
+    {
+        std::vector<XmlDocument::XPathQuery> queries; // By id; invalid for plain paths
+        std::vector<bool> plain;                      // By id: resolved through paths
+        PathTrie paths;
+    };
+
+    XmlDocument::XmlDocument()
+        : pImpl_(std::make_unique<Impl>()),
+          lastError_("")
+    {
+    }
+
+    XmlDocument::~XmlDocument()
+    {
+        clear();
+    }
+
+    bool XmlDocument::loadFromString(const std::string &xmlContent)
+    {
+        clear();
+
+        pugi::xml_parse_result result;
+        {
+            XmlMemoryScope scope(pImpl_->memory, true);
+            result = pImpl_->doc.load_string(xmlContent.c_str());
+        }
+
+        if (result)
+        {
+            pImpl_->valid = true;
+            pImpl_->buildIndex();
+            lastError_ = "";
+            return true;
+        }
+        else if (pImpl_->memory->limitExceeded())
+        {
+            pImpl_->doc.reset();
+            pImpl_->valid = false;
+            lastError_ = memoryLimitError();
+            return false;
+        }
+        else
+        {
+            pImpl_->valid = false;
+            lastError_ = std::string("XML parsing error: ") + result.description() +
+                         " at offset " + std::to_string(result.offset);
+            return false;
+        }
+    }
+
+    bool XmlDocument::copyFrom(const XmlDocument &other)
+    {
+        if (this == &other)
+        {
+            return pImpl_->valid;
+        }
+
+        clear();
+        if (!other.pImpl_->valid)
+        {
+            lastError_ = "No document loaded";
+            return false;
+        }
+
+        {
+            XmlMemoryScope scope(pImpl_->memory, true);
+            pImpl_->doc.reset(other.pImpl_->doc);
+        }
+
+        // pugixml stops copying silently when a page is refused
+        if (pImpl_->memory->limitExceeded())
+        {
+            pImpl_->doc.reset();
+            lastError_ = memoryLimitError();
+            return false;
+        }
+
+        pImpl_->valid = true;
+        pImpl_->copyIndex(*other.pImpl_);
+        return true;
+    }
+
+    bool XmlDocument::loadFromFile(const std::string &filePath)
+    {
+        clear();
+
+        pugi::xml_parse_result result;
+        {
+            XmlMemoryScope scope(pImpl_->memory, true);
+            result = pImpl_->doc.load_file(filePath.c_str());
+        }
+
+        if (result)
+        {
+            pImpl_->valid = true;
+            pImpl_->buildIndex();
+            lastError_ = "";
+            return true;
+        }
+        else if (pImpl_->memory->limitExceeded())
+        {
+            pImpl_->doc.reset();
+            pImpl_->valid = false;
+            lastError_ = memoryLimitError();
+            return false;
+        }
+        else
+        {
+            pImpl_->valid = false;
+            lastError_ = std::string("XML file error: ") + result.description() +
+                         " (file: " + filePath + ")";
+            return false;
+        }
+    }
+
+    std::string XmlDocument::toString() const
+    {
+        if (!pImpl_->valid)
+        {
+            return "";
+        }
+
+        StringWriter writer;
+        pImpl_->doc.save(writer, "  ");
+        return std::move(writer.result);
+    }
+
+    bool XmlDocument::save(OutputSink &sink, SaveFormat format) const
+    {
+        if (!pImpl_->valid)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = "No document loaded";
+            return false;
+        }
+
+        SinkWriter writer(sink);
+        if (format == SaveFormat::Raw)
+        {
+            pImpl_->doc.save(writer, "", pugi::format_raw);
+        }
+        else
+        {
+            pImpl_->doc.save(writer, "  ");
+        }
+        if (!sink.flush())
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = "Save failed: " + sink.getLastError();
+            return false;
+        }
+        return true;
+    }
+
+    bool XmlDocument::saveToFile(const std::string &filePath, SaveFormat format) const
+    {
+        if (!pImpl_->valid)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = "No document loaded";
+            return false;
+        }
+
+        int fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = "Cannot create file: " + filePath + " (" + std::strerror(errno) + ")";
+            return false;
+        }
+        bool saved;
+        {
+            FdSink sink(fd);
+            saved = save(sink, format);
+        }
+        if (::close(fd) != 0 && saved)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = "Cannot write file: " + filePath + " (" + std::strerror(errno) + ")";
+            return false;
+        }
+        return saved;
+    }
+
+    std::vector<XmlDocument::XmlNode> XmlDocument::query(const std::string &xpath) const
+    {
+        return query(prepare(xpath));
+    }
+
+    std::vector<XmlDocument::XmlNode> XmlDocument::query(const XPathQuery &xpath) const
+    {
+        std::vector<XmlNode> results;
+        NodeList nodes = select(xpath);
+        results.reserve(nodes.size());
+        for (const NodeRef &node : nodes)
+        {
+            results.push_back(node.toXmlNode(xpath.getExpression()));
+        }
+        return results;
+    }
+
+    XmlDocument::NodeList XmlDocument::select(const std::string &xpath) const
+    {
+        return select(prepare(xpath));
+    }
+
+    XmlDocument::NodeList XmlDocument::select(const XPathQuery &xpath) const
+    {
+        NodeList results;
+
+        if (!pImpl_->valid || !xpath.isValid())
+        {
+            return results;
+        }
+
+        try
+        {
+            pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(xpath.compiled_->query);
+            results.reserve(nodes.size());
+            for (const auto &xpathNode : nodes)
+            {
+                if (xpathNode.node())
+                {
+                    results.push_back(NodeRef(xpathNode.node().internal_object()));
+                }
+            }
+        }
+        catch (const pugi::xpath_exception &e)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = std::string("XPath error: ") + e.what();
+        }
+
+        return results;
+    }
+
+    XmlDocument::NodeRef XmlDocument::selectNode(const std::string &xpath) const
+    {
+        return selectNode(prepare(xpath));
+    }
+
+    XmlDocument::NodeRef XmlDocument::selectNode(const XPathQuery &xpath) const
+    {
+        if (!pImpl_->valid || !xpath.isValid())
+        {
+            return NodeRef();
+        }
+
+        try
+        {
+            return NodeRef(pImpl_->doc.select_node(xpath.compiled_->query).node().internal_object());
+        }
+        catch (const pugi::xpath_exception &e)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = std::string("XPath error: ") + e.what();
+        }
+        return NodeRef();
+    }
+
+    XmlDocument::NodeRef::NodeRef()
+        : node_(nullptr)
+    {
+    }
+
+    XmlDocument::NodeRef::NodeRef(pugi::xml_node_struct *node)
+        : node_(node)
+    {
+    }
+
+    bool XmlDocument::NodeRef::isValid() const
+    {
+        return node_ != nullptr;
+    }
+
+    std::string_view XmlDocument::NodeRef::name() const
+    {
+        return pugi::xml_node(node_).name();
+    }
+
+    std::string_view XmlDocument::NodeRef::value() const
+    {
+        return pugi::xml_node(node_).text().get();
+    }
+
+    std::string_view XmlDocument::NodeRef::attribute(std::string_view attributeName) const
+    {
+        for (pugi::xml_attribute attr = pugi::xml_node(node_).first_attribute(); attr; attr = attr.next_attribute())
+        {
+            if (attributeName == attr.name())
+            {
+                return attr.value();
+            }
+        }
+        return std::string_view();
+    }
+
+    std::map<std::string, std::string> XmlDocument::NodeRef::attributes() const
+    {
+        std::map<std::string, std::string> result;
+        for (const auto &attr : pugi::xml_node(node_).attributes())
+        {
+            result[attr.name()] = attr.value();
+        }
+        return result;
+    }
+
+    std::string XmlDocument::NodeRef::fullText() const
+    {
+        StringWriter writer;
+        if (node_ != nullptr)
+        {
+            pugi::xml_node(node_).print(writer, "", pugi::format_raw);
+        }
+        return std::move(writer.result);
+    }
+
+    XmlDocument::XmlNode XmlDocument::NodeRef::toXmlNode(const std::string &path) const
+    {
+        XmlNode result;
+        if (node_ == nullptr)
+        {
+            return result;
+        }
+        result.name = std::string(name());
+        result.value = std::string(value());
+        result.path = path;
+        result.fullText = fullText();
+        result.attributes = attributes();
+        return result;
+    }
+
+    XmlDocument::XPathQuery::XPathQuery()
+    {
+    }
+
+    bool XmlDocument::XPathQuery::isValid() const
+    {
+        return compiled_ != nullptr;
+    }
+
+    std::string XmlDocument::XPathQuery::getExpression() const
+    {
+        return compiled_ ? compiled_->expression : std::string();
+    }
+
+    XmlDocument::XPathQuery XmlDocument::prepare(const std::string &xpath) const
+    {
+        XPathQuery handle;
+        try
+        {
+            handle.compiled_ = pImpl_->compile(xpath);
+        }
+        catch (const pugi::xpath_exception &e)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = std::string("XPath error: ") + e.what();
+        }
+        return handle;
+    }
+
+    void XmlDocument::setXPathCacheCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(pImpl_->xpathMutex);
+        pImpl_->xpathCapacity = capacity;
+        while (pImpl_->xpathLru.size() > capacity)
+        {
+            pImpl_->xpathCache.erase(pImpl_->xpathLru.back()->expression);
+            pImpl_->xpathLru.pop_back();
+        }
+    }
+
+    XmlDocument::XPathCacheStats XmlDocument::getXPathCacheStats() const
+    {
+        XPathCacheStats stats;
+        std::lock_guard<std::mutex> lock(pImpl_->xpathMutex);
+        stats.hits = pImpl_->xpathHits;
+        stats.misses = pImpl_->xpathMisses;
+        stats.entries = pImpl_->xpathLru.size();
+        stats.capacity = pImpl_->xpathCapacity;
+        return stats;
+    }
+
+    std::vector<std::string> XmlDocument::findTextNodes(const std::string &xpath) const
+    {
+        return findTextNodes(prepare(xpath));
+    }
+
+    std::vector<std::string> XmlDocument::findTextNodes(const XPathQuery &xpath) const
+    {
+        std::vector<std::string> results;
+
+        if (!pImpl_->valid || !xpath.isValid())
+        {
+            return results;
+        }
+
+        // All text nodes: the text table already lists them in document order
+        if (xpath.compiled_->expression == "//text()")
+        {
+            pImpl_->buildRuns();
+            for (const auto &run : pImpl_->runs)
+            {
+                if (*run.node.value())
+                {
+                    results.push_back(run.node.value());
+                }
+            }
+            return results;
+        }
+
+        try
+        {
+            pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(xpath.compiled_->query);
+
+            for (const auto &xpathNode : nodes)
+            {
+                if (xpathNode.node())
+                {
+                    std::string text = xpathNode.node().text().as_string();
+                    if (!text.empty())
+                    {
+                        results.push_back(text);
+                    }
+                }
+                else if (xpathNode.attribute())
+                {
+                    results.push_back(xpathNode.attribute().value());
+                }
+            }
+        }
+        catch (const pugi::xpath_exception &e)
+        {
+            const_cast<XmlDocument *>(this)->lastError_ = std::string("XPath error: ") + e.what();
+        }
+
+        return results;
+    }
+
+    std::vector<XmlDocument::XmlNode> XmlDocument::findTemplateNodes() const
+    {
+        std::vector<XmlNode> results;
+        ElementPaths paths;
+        for (const NodeRef &element : templateNodes())
+        {
+            pugi::xml_node node(element.node_);
+            XmlNode xmlNode;
+            xmlNode.name = node.name();
+            xmlNode.value = node.text().as_string();
+            xmlNode.path = paths.get(node);
+            results.push_back(xmlNode);
+        }
+        return results;
+    }
+
+    XmlDocument::NodeList XmlDocument::templateNodes() const
+    {
+        NodeList results;
+        if (!pImpl_->valid)
+        {
+            return results;
+        }
+
+        // The elements owning the indexed text nodes, once each
+        pImpl_->buildIndex();
+        pugi::xml_node last;
+        for (const auto &slot : pImpl_->texts)
+        {
+            pugi::xml_node element = slot.node.parent();
+            if (element != last)
+            {
+                results.push_back(NodeRef(element.internal_object()));
+                last = element;
+            }
+        }
+        return results;
+    }
+
+    int XmlDocument::replaceText(const std::string &xpath, const std::string &oldText, const std::string &newText)
+    {
+        return replaceText(prepare(xpath), oldText, newText);
+    }
+
+    int XmlDocument::replaceText(const XPathQuery &xpath, const std::string &oldText, const std::string &newText)
+    {
+        if (!pImpl_->valid || !xpath.isValid())
+        {
+            return 0;
+        }
+
+        XmlMemoryScope scope(pImpl_->memory, false);
+
+        int count = 0;
+
+        try
+        {
+            pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(xpath.compiled_->query);
+
+            for (auto &xpathNode : nodes)
+            {
+                pugi::xml_node node = xpathNode.node();
+                if (node)
+                {
+                    std::string text = node.text().as_string();
+                    size_t pos = text.find(oldText);
+                    if (pos != std::string::npos)
+                    {
+                        text.replace(pos, oldText.length(), newText);
+                        node.text().set(text.c_str());
+                        pImpl_->dropIndex();
+                        count++;
+                    }
+                }
+            }
+        }
+        catch (const pugi::xpath_exception &e)
+        {
+            lastError_ = std::string("XPath error: ") + e.what();
+        }
+
+        return count;
+    }
+
+    int XmlDocument::replaceVariables(const std::map<std::string, std::string> &variables)
+    {
+        auto lookup = [&variables](std::string_view name, std::string_view &value)
+        {
+            auto it = variables.find(std::string(name));
+            if (it == variables.end())
+            {
+                return false;
+            }
+            value = it->second;
+            return true;
+        };
+
+        return replaceVariables(lookup);
     }
 
-    std::string XmlDocument::toString() const
+    int XmlDocument::replaceVariables(const VariableLookup &lookup)
     {
         if (!pImpl_->valid)
         {
-            return "";
+            return 0;
+        }
+
+        // Resolve each distinct name once, however often it occurs
+        const SymbolTable &symbols = getSymbols();
+        SymbolValues values;
+        values.reset(symbols.size());
+        for (uint32_t id = 0; id < symbols.size(); id++)
+        {
+            std::string_view value;
+            if (lookup(symbols.name(id), value))
+            {
+                values.set(id, value);
+            }
         }
 
-        std::ostringstream oss;
-        pImpl_->doc.save(oss, "  ");
-        return oss.str();
+        return replaceVariables(values);
     }
 
-    std::vector<XmlDocument::XmlNode> XmlDocument::query(const std::string &xpath) const
+    int XmlDocument::replaceVariables(const SymbolValues &values)
     {
-        std::vector<XmlNode> results;
-
         if (!pImpl_->valid)
         {
-            return results;
+            return 0;
         }
 
-        try
+        XmlMemoryScope scope(pImpl_->memory, false);
+
+        if (pImpl_->bound)
         {
-            pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(xpath.c_str());
+            return bindVariables(values);
+        }
 
-            for (const auto &xpathNode : nodes)
-            {
-                pugi::xml_node node = xpathNode.node();
-                if (node)
-                {
-                    XmlNode xmlNode;
-                    xmlNode.name = node.name();
-                    xmlNode.value = node.text().as_string();
-                    xmlNode.path = xpath;
+        pImpl_->buildIndex();
 
-                    // Get full text including children
-                    std::ostringstream oss;
-                    node.print(oss, "", pugi::format_raw);
-                    xmlNode.fullText = oss.str();
+        int totalReplacements = 0;
+        std::string result;
 
-                    // Get attributes
-                    for (const auto &attr : node.attributes())
-                    {
-                        xmlNode.attributes[attr.name()] = attr.value();
-                    }
+        for (const auto &slot : pImpl_->texts)
+        {
+            pugi::xml_node node = slot.node;
+            std::string_view text = node.value();
 
-                    results.push_back(xmlNode);
-                }
+            // Update the node text only when something was replaced
+            int replaced = pImpl_->render(slot, text, values, result);
+            if (replaced > 0 && result != text)
+            {
+                node.set_value(result.c_str());
             }
+            totalReplacements += replaced;
         }
-        catch (const pugi::xpath_exception &e)
+
+        // Offsets of the rewritten nodes are stale now
+        if (totalReplacements > 0)
         {
-            const_cast<XmlDocument *>(this)->lastError_ = std::string("XPath error: ") + e.what();
+            pImpl_->reindexTexts();
         }
 
-        return results;
+        return totalReplacements;
     }
 
-    std::vector<std::string> XmlDocument::findTextNodes(const std::string &xpath) const
+    int XmlDocument::bindVariables(const SymbolValues &values)
     {
-        std::vector<std::string> results;
-
         if (!pImpl_->valid)
         {
-            return results;
+            return 0;
         }
 
-        try
-        {
-            pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(xpath.c_str());
+        XmlMemoryScope scope(pImpl_->memory, false);
 
-            for (const auto &xpathNode : nodes)
+        pImpl_->bind();
+
+        int totalReplacements = 0;
+        std::string result;
+
+        for (const auto &slot : pImpl_->texts)
+        {
+            pugi::xml_node node = slot.node;
+            std::string_view source(pImpl_->templateText.data() + slot.source, slot.length);
+            totalReplacements += pImpl_->render(slot, source, values, result);
+            if (result != node.value())
             {
-                if (xpathNode.node())
-                {
-                    std::string text = xpathNode.node().text().as_string();
-                    if (!text.empty())
-                    {
-                        results.push_back(text);
-                    }
-                }
-                else if (xpathNode.attribute())
-                {
-                    results.push_back(xpathNode.attribute().value());
-                }
+                node.set_value(result.c_str());
             }
         }
-        catch (const pugi::xpath_exception &e)
-        {
-            const_cast<XmlDocument *>(this)->lastError_ = std::string("XPath error: ") + e.what();
-        }
 
-        return results;
+        return totalReplacements;
     }
 
-    std::vector<XmlDocument::XmlNode> XmlDocument::findTemplateNodes() const
+    int XmlDocument::updateVariables(const std::vector<uint32_t> &changed, const VariableLookup &lookup,
+                                     std::vector<std::string> *changedPaths)
     {
-        std::vector<XmlNode> results;
-
-        if (!pImpl_->valid)
+        if (!pImpl_->valid || !pImpl_->bound)
         {
-            return results;
+            return -1;
         }
 
-        // Regex to find {{variable}} patterns
-        std::regex varRegex(R"(\{\{[^}]+\}\})");
+        XmlMemoryScope scope(pImpl_->memory, false);
 
-        // Recursive function to traverse nodes
-        std::function<void(pugi::xml_node)> traverse = [&](pugi::xml_node node)
+        const Impl &impl = *pImpl_;
+
+        // Slots fed by the changed symbols, each once, in document order
+        std::vector<uint32_t> slots;
+        for (uint32_t id : changed)
         {
-            std::string text = node.text().as_string();
-            if (std::regex_search(text, varRegex))
+            if (id < impl.symbols.size())
             {
-                XmlNode xmlNode;
-                xmlNode.name = node.name();
-                xmlNode.value = text;
+                slots.insert(slots.end(), impl.symbolSlots.begin() + impl.symbolFirst[id],
+                             impl.symbolSlots.begin() + impl.symbolFirst[id + 1]);
+            }
+        }
+        std::sort(slots.begin(), slots.end());
+        slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
 
-                // Build simple path
-                std::string path = "/";
-                pugi::xml_node current = node;
-                std::vector<std::string> pathParts;
-                while (current && current != pImpl_->doc)
-                {
-                    pathParts.insert(pathParts.begin(), current.name());
-                    current = current.parent();
-                }
-                for (const auto &part : pathParts)
-                {
-                    if (!part.empty())
-                    {
-                        path += part + "/";
-                    }
-                }
-                xmlNode.path = path;
+        // Resolve only the symbols those slots use
+        std::vector<uint32_t> needed;
+        for (uint32_t s : slots)
+        {
+            const Impl::TextSlot &slot = impl.texts[s];
+            for (uint32_t i = slot.first; i < slot.first + slot.count; i++)
+            {
+                needed.push_back(impl.occurrences[i].symbol);
+            }
+        }
+        std::sort(needed.begin(), needed.end());
+        needed.erase(std::unique(needed.begin(), needed.end()), needed.end());
 
-                results.push_back(xmlNode);
+        SymbolValues values;
+        values.reset(impl.symbols.size());
+        for (uint32_t id : needed)
+        {
+            std::string_view value;
+            if (lookup(impl.symbols.name(id), value))
+            {
+                values.set(id, value);
             }
+        }
 
-            // Recurse into children
-            for (pugi::xml_node child : node.children())
+        int rewritten = 0;
+        std::string result;
+        ElementPaths paths;
+        for (uint32_t s : slots)
+        {
+            const Impl::TextSlot &slot = impl.texts[s];
+            pugi::xml_node node = slot.node;
+            impl.render(slot, std::string_view(impl.templateText.data() + slot.source, slot.length), values, result);
+            if (result == node.value())
             {
-                traverse(child);
+                continue;
             }
-        };
 
-        // Start traversal from root
-        traverse(pImpl_->doc.document_element());
+            node.set_value(result.c_str());
+            rewritten++;
+            if (changedPaths != nullptr)
+            {
+                changedPaths->push_back(paths.get(node.parent()));
+            }
+        }
+
+        return rewritten;
+    }
 
-        return results;
+    bool XmlDocument::isBound() const
+    {
+        return pImpl_->bound;
     }
 
-    int XmlDocument::replaceText(const std::string &xpath, const std::string &oldText, const std::string &newText)
+    const SymbolTable &XmlDocument::getSymbols() const
+    {
+        if (pImpl_->valid)
+        {
+            pImpl_->buildIndex();
+        }
+        return pImpl_->symbols;
+    }
+
+    size_t XmlDocument::getPlaceholderCount() const
+    {
+        if (pImpl_->valid)
+        {
+            pImpl_->buildIndex();
+        }
+        return pImpl_->occurrences.size();
+    }
+
+    int XmlDocument::expandSections(const SectionLookup &sections, const VariableLookup &lookup)
     {
         if (!pImpl_->valid)
         {
             return 0;
         }
 
-        int count = 0;
+        XmlMemoryScope scope(pImpl_->memory, false);
 
-        try
-        {
-            pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(xpath.c_str());
+        std::vector<SectionMarker> markers;
+        collectMarkers(pImpl_->doc.document_element(), markers);
 
-            for (auto &xpathNode : nodes)
-            {
-                pugi::xml_node node = xpathNode.node();
-                if (node)
-                {
-                    std::string text = node.text().as_string();
-                    size_t pos = text.find(oldText);
-                    if (pos != std::string::npos)
-                    {
-                        text.replace(pos, oldText.length(), newText);
-                        node.text().set(text.c_str());
-                        count++;
-                    }
-                }
-            }
-        }
-        catch (const pugi::xpath_exception &e)
+        std::vector<Section> found;
+        pairMarkers(markers, found);
+        if (!markers.empty())
         {
-            lastError_ = std::string("XPath error: ") + e.what();
+            pImpl_->dropIndex();
         }
-
-        return count;
+        return expandAll(found, pImpl_->doc, sections, lookup);
     }
 
-    int XmlDocument::replaceVariables(const std::map<std::string, std::string> &variables)
+    int XmlDocument::mergeSplitPlaceholders()
     {
         if (!pImpl_->valid)
         {
             return 0;
         }
 
-        int totalReplacements = 0;
-        std::regex varRegex(R"(\{\{([^}]+)\}\})");
+        XmlMemoryScope scope(pImpl_->memory, false);
 
-        // Recursive function to traverse and replace in nodes
-        std::function<void(pugi::xml_node)> traverse = [&](pugi::xml_node node)
+        // Only paragraphs with two text runs or more, one holding a brace,
+        // can hold a split placeholder. They are collected first from the
+        // text table: merging removes runs, never paragraphs
+        pImpl_->buildRuns();
+        const auto &runs = pImpl_->runs;
+        std::vector<pugi::xml_node> paragraphs;
+        std::vector<bool> collected(pImpl_->paragraphs.size(), false);
+        for (size_t i = 0; i < runs.size();)
         {
-            pugi::xml_text textNode = node.text();
-            std::string text = textNode.as_string();
-
-            if (!text.empty() && std::regex_search(text, varRegex))
+            uint32_t paragraph = runs[i].paragraph;
+            size_t count = 0;
+            bool brace = false;
+            for (; i < runs.size() && runs[i].paragraph == paragraph; i++, count++)
             {
-                // Replace all variables in this text
-                std::string result = text;
-                std::smatch match;
-                std::string::const_iterator searchStart(result.cbegin());
-
-                // Collect all replacements first
-                std::vector<std::pair<size_t, size_t>> positions;
-                std::vector<std::string> replacements;
-
-                while (std::regex_search(searchStart, result.cend(), match, varRegex))
-                {
-                    std::string varName = match[1].str();
-                    // Trim whitespace
-                    varName.erase(0, varName.find_first_not_of(" \t\n\r"));
-                    varName.erase(varName.find_last_not_of(" \t\n\r") + 1);
-
-                    auto it = variables.find(varName);
-                    if (it != variables.end())
-                    {
-                        size_t pos = std::distance(result.cbegin(), match[0].first);
-                        positions.push_back({pos, match[0].length()});
-                        replacements.push_back(it->second);
-                        totalReplacements++;
-                    }
-
-                    searchStart = match.suffix().first;
-                }
-
-                // Apply replacements from end to beginning
-                for (int i = positions.size() - 1; i >= 0; i--)
-                {
-                    result.replace(positions[i].first, positions[i].second, replacements[i]);
-                }
-
-                // Update the node text
-                if (result != text)
-                {
-                    textNode.set(result.c_str());
-                }
+                brace = brace || std::strpbrk(runs[i].node.value(), "{}") != nullptr;
             }
-
-            // Recurse into children
-            for (pugi::xml_node child : node.children())
+            if (paragraph != Impl::noParagraph && count > 1 && brace && !collected[paragraph])
             {
-                traverse(child);
+                collected[paragraph] = true;
+                paragraphs.push_back(pImpl_->paragraphs[paragraph]);
             }
-        };
+        }
 
-        // Start traversal from root
-        traverse(pImpl_->doc.document_element());
+        int merged = 0;
+        std::vector<RunText> pieces;
+        std::string joined;
+        for (pugi::xml_node paragraph : paragraphs)
+        {
+            merged += mergeParagraph(paragraph, pieces, joined);
+        }
 
-        return totalReplacements;
+        if (merged > 0)
+        {
+            pImpl_->dropIndex();
+            pImpl_->buildIndex();
+        }
+        return merged;
     }
 
     std::string XmlDocument::getTextContent() const
@@ -339,48 +2018,92 @@ namespace json2doc
             return "";
         }
 
-        std::ostringstream oss;
-
-        // Recursive function to collect text
-        std::function<void(pugi::xml_node)> traverse = [&](pugi::xml_node node)
+        // Every element with text and every text node, in document order, each
+        // followed by a space. An element precedes its descendants, so its text
+        // (its first text child) goes before the first run of its subtree:
+        // ancestors of a run not shared with the previous run start there
+        pImpl_->buildRuns();
+        pugi::xml_node top = pImpl_->doc.document_element();
+        std::vector<pugi::xml_node> previous;
+        std::vector<pugi::xml_node> current;
+        std::string result;
+        for (const auto &run : pImpl_->runs)
         {
-            std::string text = node.text().as_string();
-            if (!text.empty())
+            current.clear();
+            for (pugi::xml_node node = run.node.parent(); node && node != top.parent(); node = node.parent())
             {
-                oss << text << " ";
+                current.push_back(node);
             }
+            std::reverse(current.begin(), current.end());
 
-            // Recurse into children
-            for (pugi::xml_node child : node.children())
+            size_t shared = 0;
+            while (shared < current.size() && shared < previous.size() && current[shared] == previous[shared])
             {
-                traverse(child);
+                shared++;
             }
-        };
+            for (size_t i = shared; i < current.size(); i++)
+            {
+                const char *text = current[i].text().get();
+                if (*text != '\0')
+                {
+                    result += text;
+                    result += ' ';
+                }
+            }
+            if (*run.node.value() != '\0')
+            {
+                result += run.node.value();
+                result += ' ';
+            }
+            previous.swap(current);
+        }
+        return result;
+    }
 
-        traverse(pImpl_->doc.document_element());
+    std::vector<std::string> XmlDocument::getParagraphTexts() const
+    {
+        std::vector<std::string> results;
+        if (!pImpl_->valid)
+        {
+            return results;
+        }
 
-        return oss.str();
+        pImpl_->buildRuns();
+        results.resize(pImpl_->paragraphs.size());
+        for (const auto &run : pImpl_->runs)
+        {
+            if (run.paragraph != Impl::noParagraph)
+            {
+                results[run.paragraph] += run.node.value();
+            }
+        }
+        return results;
     }
 
     XmlDocument::XmlNode XmlDocument::getNode(const std::string &xpath) const
+    {
+        return getNode(prepare(xpath));
+    }
+
+    XmlDocument::XmlNode XmlDocument::getNode(const XPathQuery &xpath) const
     {
         XmlNode result;
 
-        if (!pImpl_->valid)
+        if (!pImpl_->valid || !xpath.isValid())
         {
             return result;
         }
 
         try
         {
-            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.c_str());
+            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.compiled_->query);
             pugi::xml_node node = xpathNode.node();
 
             if (node)
             {
                 result.name = node.name();
                 result.value = node.text().as_string();
-                result.path = xpath;
+                result.path = xpath.compiled_->expression;
 
                 for (const auto &attr : node.attributes())
                 {
@@ -398,19 +2121,27 @@ namespace json2doc
 
     bool XmlDocument::setNodeText(const std::string &xpath, const std::string &text)
     {
-        if (!pImpl_->valid)
+        return setNodeText(prepare(xpath), text);
+    }
+
+    bool XmlDocument::setNodeText(const XPathQuery &xpath, const std::string &text)
+    {
+        if (!pImpl_->valid || !xpath.isValid())
         {
             return false;
         }
 
+        XmlMemoryScope scope(pImpl_->memory, false);
+
         try
         {
-            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.c_str());
+            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.compiled_->query);
             pugi::xml_node node = xpathNode.node();
 
             if (node)
             {
                 node.text().set(text.c_str());
+                pImpl_->dropIndex();
                 return true;
             }
         }
@@ -424,14 +2155,19 @@ namespace json2doc
 
     std::string XmlDocument::getAttributeValue(const std::string &xpath, const std::string &attributeName) const
     {
-        if (!pImpl_->valid)
+        return getAttributeValue(prepare(xpath), attributeName);
+    }
+
+    std::string XmlDocument::getAttributeValue(const XPathQuery &xpath, const std::string &attributeName) const
+    {
+        if (!pImpl_->valid || !xpath.isValid())
         {
             return "";
         }
 
         try
         {
-            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.c_str());
+            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.compiled_->query);
             pugi::xml_node node = xpathNode.node();
 
             if (node)
@@ -449,14 +2185,21 @@ namespace json2doc
 
     bool XmlDocument::setAttributeValue(const std::string &xpath, const std::string &attributeName, const std::string &value)
     {
-        if (!pImpl_->valid)
+        return setAttributeValue(prepare(xpath), attributeName, value);
+    }
+
+    bool XmlDocument::setAttributeValue(const XPathQuery &xpath, const std::string &attributeName, const std::string &value)
+    {
+        if (!pImpl_->valid || !xpath.isValid())
         {
             return false;
         }
 
+        XmlMemoryScope scope(pImpl_->memory, false);
+
         try
         {
-            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.c_str());
+            pugi::xpath_node xpathNode = pImpl_->doc.select_node(xpath.compiled_->query);
             pugi::xml_node node = xpathNode.node();
 
             if (node)
@@ -481,6 +2224,122 @@ namespace json2doc
         return false;
     }
 
+    std::vector<size_t> XmlDocument::applyEdits(EditBatch &batch)
+    {
+        std::vector<size_t> hits(batch.operations_.size(), 0);
+        if (!pImpl_->valid)
+        {
+            return hits;
+        }
+
+        // Plan the expressions added since the last call: plain paths join
+        // the trie, the others are compiled, bypassing the cache since the
+        // batch keeps them
+        if (!batch.plan_)
+        {
+            batch.plan_ = std::make_shared<EditBatch::Plan>();
+        }
+        EditBatch::Plan &plan = *batch.plan_;
+        std::vector<std::pair<std::string_view, uint32_t>> steps;
+        for (uint32_t id = static_cast<uint32_t>(plan.queries.size()); id < batch.expressions_.size(); id++)
+        {
+            std::string_view expression = batch.expressions_.name(id);
+            XPathQuery handle;
+            bool plain = splitPlainPath(expression, steps);
+            if (plain)
+            {
+                uint32_t step = 0;
+                for (const auto &[name, position] : steps)
+                {
+                    step = addPathStep(plan.paths, step, name, position);
+                }
+                plan.paths.steps[step].expressions.push_back(id);
+            }
+            else
+            {
+                try
+                {
+                    handle.compiled_ = std::make_shared<const CompiledXPath>(std::string(expression));
+                }
+                catch (const pugi::xpath_exception &e)
+                {
+                    lastError_ = std::string("XPath error: ") + e.what();
+                }
+            }
+            plan.queries.push_back(handle);
+            plan.plain.push_back(plain);
+        }
+
+        XmlMemoryScope scope(pImpl_->memory, false);
+
+        // Resolve every target before changing anything: the plain paths in
+        // one walk, every other expression with one evaluation
+        std::vector<std::vector<pugi::xml_node>> targets(plan.queries.size());
+        resolvePaths(pImpl_->doc, 0, plan.paths, targets);
+        for (uint32_t id = 0; id < plan.queries.size(); id++)
+        {
+            if (plan.plain[id])
+            {
+                continue;
+            }
+            const XPathQuery &query = plan.queries[id];
+            if (!query.isValid())
+            {
+                lastError_ = "XPath error: invalid expression " + std::string(batch.expressions_.name(id));
+                continue;
+            }
+            try
+            {
+                pugi::xpath_node_set nodes = pImpl_->doc.select_nodes(query.compiled_->query);
+                nodes.sort();
+                for (const auto &xpathNode : nodes)
+                {
+                    if (xpathNode.node())
+                    {
+                        targets[id].push_back(xpathNode.node());
+                    }
+                }
+            }
+            catch (const pugi::xpath_exception &e)
+            {
+                lastError_ = std::string("XPath error: ") + e.what();
+            }
+        }
+
+        bool textChanged = false;
+        auto apply = [&](const EditBatch::Operation &operation, pugi::xml_node node)
+        {
+            if (!operation.attribute)
+            {
+                textChanged = true;
+                return node.text().set(operation.value.c_str());
+            }
+            pugi::xml_attribute attr = node.attribute(operation.name.c_str());
+            if (!attr)
+            {
+                attr = node.append_attribute(operation.name.c_str());
+            }
+            return attr.set_value(operation.value.c_str());
+        };
+
+        for (size_t i = 0; i < batch.operations_.size(); i++)
+        {
+            const EditBatch::Operation &operation = batch.operations_[i];
+            const std::vector<pugi::xml_node> &nodes = targets[operation.expression];
+            size_t count = operation.match == EditBatch::Match::First ? std::min<size_t>(nodes.size(), 1) : nodes.size();
+            for (size_t n = 0; n < count; n++)
+            {
+                hits[i] += apply(operation, nodes[n]) ? 1 : 0;
+            }
+        }
+
+        if (textChanged)
+        {
+            pImpl_->dropIndex();
+        }
+        return hits;
+    }
+
     bool XmlDocument::isValid() const
     {
         return pImpl_->valid;
@@ -497,8 +2356,32 @@ namespace json2doc
         {
             pImpl_->doc.reset();
             pImpl_->valid = false;
+            pImpl_->dropIndex();
+            pImpl_->memory->resetPeak();
+            pImpl_->memory->clearLimitExceeded();
         }
         lastError_ = "";
     }
 
+    void XmlDocument::setMemoryLimit(size_t bytes)
+    {
+        pImpl_->memory->setLimit(bytes);
+    }
+
+    XmlDocument::MemoryStats XmlDocument::getMemoryStats() const
+    {
+        MemoryStats stats;
+        stats.bytes = pImpl_->memory->getBytes();
+        stats.peakBytes = pImpl_->memory->getPeakBytes();
+        stats.pages = pImpl_->memory->getPages();
+        stats.limit = pImpl_->memory->getLimit();
+        return stats;
+    }
+
+    std::string XmlDocument::memoryLimitError() const
+    {
+        return "Memory limit exceeded: the document needs more than " + std::to_string(pImpl_->memory->getLimit()) +
+               " bytes";
+    }
+
 } // namespace json2doc
@@ -0,0 +1,260 @@
+#include "json2doc/xml_memory.h"
+#include <pugixml.hpp>
+#include <cstdlib>
+#include <new>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        // Pages larger than this (parse buffers, long strings) bypass the arena
+        const size_t kArenaPageMax = 256 * 1024;
+
+        // Most bytes of freed pages a thread keeps for reuse
+        const size_t kArenaBytes = 8 * 1024 * 1024;
+
+        // Page sizes a thread keeps at once (pugixml uses very few)
+        const size_t kArenaBins = 4;
+
+        // Written before every page: its account and size. The alignment
+        // keeps the page itself aligned for any type
+        struct alignas(std::max_align_t) PageHeader
+        {
+            std::shared_ptr<XmlMemoryAccount> account;
+            size_t size;
+        };
+
+        // Freed pages of this thread, by size. A cached page stores the next
+        // one of its bin in place, so caching never allocates
+        struct ThreadArena
+        {
+            struct Bin
+            {
+                size_t size = 0;
+                size_t count = 0;
+                void *head = nullptr;
+            };
+
+            Bin bins[kArenaBins];
+            size_t cached = 0;
+
+            ~ThreadArena();
+
+            void *take(size_t size)
+            {
+                for (Bin &bin : bins)
+                {
+                    if (bin.count > 0 && bin.size == size)
+                    {
+                        void *block = bin.head;
+                        bin.head = *static_cast<void **>(block);
+                        bin.count--;
+                        cached -= sizeof(PageHeader) + size;
+                        return block;
+                    }
+                }
+                return nullptr;
+            }
+
+            bool keep(void *block, size_t size)
+            {
+                if (cached + sizeof(PageHeader) + size > kArenaBytes)
+                {
+                    return false;
+                }
+                Bin *target = nullptr;
+                for (Bin &bin : bins)
+                {
+                    if (bin.count > 0 && bin.size == size)
+                    {
+                        target = &bin;
+                        break;
+                    }
+                    if (bin.count == 0 && target == nullptr)
+                    {
+                        target = &bin;
+                    }
+                }
+                if (target == nullptr)
+                {
+                    return false;
+                }
+                target->size = size;
+                *static_cast<void **>(block) = target->head;
+                target->head = block;
+                target->count++;
+                cached += sizeof(PageHeader) + size;
+                return true;
+            }
+        };
+
+        // Pages freed while the thread exits, after its arena is gone, go
+        // straight back to the C library
+        thread_local bool arenaClosed = false;
+        thread_local ThreadArena arena;
+
+        ThreadArena::~ThreadArena()
+        {
+            for (Bin &bin : bins)
+            {
+                while (bin.count > 0)
+                {
+                    void *block = bin.head;
+                    bin.head = *static_cast<void **>(block);
+                    bin.count--;
+                    std::free(block);
+                }
+            }
+            arenaClosed = true;
+        }
+
+        // The account charged on this thread (see XmlMemoryScope)
+        thread_local const std::shared_ptr<XmlMemoryAccount> *currentAccount = nullptr;
+        thread_local bool currentEnforce = false;
+
+        // Installed before main(), so every page pugixml ever frees came from allocate()
+        struct HookInstaller
+        {
+            HookInstaller()
+            {
+                pugi::set_memory_management_functions(&XmlMemoryAccount::allocate, &XmlMemoryAccount::deallocate);
+            }
+        } hookInstaller;
+    } // namespace
+
+    XmlMemoryAccount::XmlMemoryAccount()
+        : bytes_(0), peak_(0), pages_(0), limit_(0), exceeded_(false)
+    {
+    }
+
+    size_t XmlMemoryAccount::getBytes() const
+    {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+
+    size_t XmlMemoryAccount::getPeakBytes() const
+    {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+    size_t XmlMemoryAccount::getPages() const
+    {
+        return pages_.load(std::memory_order_relaxed);
+    }
+
+    void XmlMemoryAccount::resetPeak()
+    {
+        peak_.store(bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    void XmlMemoryAccount::setLimit(size_t bytes)
+    {
+        limit_.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t XmlMemoryAccount::getLimit() const
+    {
+        return limit_.load(std::memory_order_relaxed);
+    }
+
+    bool XmlMemoryAccount::limitExceeded() const
+    {
+        return exceeded_.load(std::memory_order_relaxed);
+    }
+
+    void XmlMemoryAccount::clearLimitExceeded()
+    {
+        exceeded_.store(false, std::memory_order_relaxed);
+    }
+
+    bool XmlMemoryAccount::charge(size_t size, bool enforceLimit)
+    {
+        size_t bytes = bytes_.fetch_add(size, std::memory_order_relaxed) + size;
+        size_t limit = limit_.load(std::memory_order_relaxed);
+        if (enforceLimit && limit != 0 && bytes > limit)
+        {
+            bytes_.fetch_sub(size, std::memory_order_relaxed);
+            exceeded_.store(true, std::memory_order_relaxed);
+            return false;
+        }
+
+        pages_.fetch_add(1, std::memory_order_relaxed);
+        size_t peak = peak_.load(std::memory_order_relaxed);
+        while (bytes > peak && !peak_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+        {
+        }
+        return true;
+    }
+
+    void XmlMemoryAccount::credit(size_t size)
+    {
+        bytes_.fetch_sub(size, std::memory_order_relaxed);
+        pages_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void *XmlMemoryAccount::allocate(size_t size)
+    {
+        const std::shared_ptr<XmlMemoryAccount> *account = currentAccount;
+        if (account != nullptr && !(*account)->charge(size, currentEnforce))
+        {
+            return nullptr;
+        }
+
+        void *block = nullptr;
+        if (!arenaClosed && size <= kArenaPageMax)
+        {
+            block = arena.take(size);
+        }
+        if (block == nullptr)
+        {
+            block = std::malloc(sizeof(PageHeader) + size);
+        }
+        if (block == nullptr)
+        {
+            if (account != nullptr)
+            {
+                (*account)->credit(size);
+            }
+            return nullptr;
+        }
+
+        PageHeader *header = new (block) PageHeader{account != nullptr ? *account : nullptr, size};
+        return header + 1;
+    }
+
+    void XmlMemoryAccount::deallocate(void *page)
+    {
+        if (page == nullptr)
+        {
+            return;
+        }
+
+        PageHeader *header = static_cast<PageHeader *>(page) - 1;
+        size_t size = header->size;
+        if (header->account)
+        {
+            header->account->credit(size);
+        }
+        header->~PageHeader();
+
+        if (arenaClosed || size > kArenaPageMax || !arena.keep(header, size))
+        {
+            std::free(header);
+        }
+    }
+
+    XmlMemoryScope::XmlMemoryScope(const std::shared_ptr<XmlMemoryAccount> &account, bool enforceLimit)
+        : previous_(currentAccount), previousEnforce_(currentEnforce)
+    {
+        currentAccount = &account;
+        currentEnforce = enforceLimit;
+    }
+
+    XmlMemoryScope::~XmlMemoryScope()
+    {
+        currentAccount = previous_;
+        currentEnforce = previousEnforce_;
+    }
+
+} // namespace json2doc
@@ -0,0 +1,384 @@
+#include "json2doc/zip_writer.h"
+#include <zlib.h>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+
+namespace json2doc
+{
+
+    namespace
+    {
+        constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+        constexpr uint32_t kDescriptorSignature = 0x08074b50;
+        constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+        constexpr uint32_t kEndSignature = 0x06054b50;
+
+        constexpr uint16_t kVersion = 20;              // 2.0: deflate, directories
+        constexpr uint16_t kFlagDescriptor = 0x0008;   // Sizes and CRC follow the data
+        constexpr uint16_t kFlagUtf8 = 0x0800;         // Names are UTF-8
+        constexpr uint16_t kMethodStore = 0;
+        constexpr uint16_t kMethodDeflate = 8;
+
+        constexpr size_t kEntryBufferSize = 64 * 1024;
+        constexpr size_t kChunkSize = 64 * 1024;
+
+        void put16(std::string &out, uint16_t value)
+        {
+            out += static_cast<char>(value & 0xff);
+            out += static_cast<char>(value >> 8);
+        }
+
+        void put32(std::string &out, uint32_t value)
+        {
+            put16(out, static_cast<uint16_t>(value & 0xffff));
+            put16(out, static_cast<uint16_t>(value >> 16));
+        }
+
+        // MS-DOS date and time of now, as stored in ZIP headers
+        void dosNow(uint16_t &dosTime, uint16_t &dosDate)
+        {
+            std::time_t now = std::time(nullptr);
+            std::tm local;
+            localtime_r(&now, &local);
+            int year = local.tm_year + 1900 < 1980 ? 1980 : local.tm_year + 1900;
+            dosTime = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+            dosDate = static_cast<uint16_t>(((year - 1980) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+        }
+    }
+
+    class ZipWriter::Impl
+    {
+    public:
+        // Central directory record of a written entry
+        struct Entry
+        {
+            std::string name;
+            uint16_t flags;
+            uint16_t method;
+            uint32_t crc;
+            uint64_t compressedSize;
+            uint64_t size;
+            uint64_t offset;
+        };
+
+        // Sink of the open entry: checksums the data, deflates it if needed
+        // and passes the result to the archive sink
+        class EntrySink : public OutputSink
+        {
+        public:
+            explicit EntrySink(Impl &zip)
+                : OutputSink(kEntryBufferSize), zip_(zip)
+            {
+            }
+
+        protected:
+            bool writeOut(const char *data, size_t size) override
+            {
+                Entry &entry = zip_.entries.back();
+                if (size > 0xffffffffu)
+                {
+                    return fail("Entry exceeds 4 GiB: " + entry.name);
+                }
+                entry.crc = static_cast<uint32_t>(crc32(entry.crc, reinterpret_cast<const Bytef *>(data),
+                                                        static_cast<uInt>(size)));
+                entry.size += size;
+                bool ok = entry.method == kMethodStore ? zip_.emit(data, size) : zip_.deflateData(data, size, Z_NO_FLUSH);
+                return ok || fail(zip_.lastError);
+            }
+
+        private:
+            Impl &zip_;
+        };
+
+        OutputSink &out;
+        uint64_t start;
+        int level = Z_DEFAULT_COMPRESSION;
+        z_stream stream;
+        bool streamReady = false;
+        int streamLevel = 0;
+        std::vector<Entry> entries;
+        std::unique_ptr<EntrySink> sink;
+        std::vector<unsigned char> chunk;
+        uint16_t dosTime = 0;
+        uint16_t dosDate = 0;
+        bool finished = false;
+        std::string lastError;
+
+        explicit Impl(OutputSink &output)
+            : out(output), start(output.bytesWritten()), chunk(kChunkSize)
+        {
+            dosNow(dosTime, dosDate);
+        }
+
+        ~Impl()
+        {
+            if (streamReady)
+            {
+                deflateEnd(&stream);
+            }
+        }
+
+        bool error(const std::string &message)
+        {
+            lastError = message;
+            return false;
+        }
+
+        uint64_t offset() const
+        {
+            return out.bytesWritten() - start;
+        }
+
+        bool emit(const char *data, size_t size)
+        {
+            entries.back().compressedSize += size;
+            return out.write(data, size) || error(out.getLastError());
+        }
+
+        bool deflateData(const char *data, size_t size, int flush)
+        {
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+            stream.avail_in = static_cast<uInt>(size);
+            do
+            {
+                stream.next_out = chunk.data();
+                stream.avail_out = static_cast<uInt>(chunk.size());
+                int status = deflate(&stream, flush);
+                if (status == Z_STREAM_ERROR)
+                {
+                    return error("Deflate failed");
+                }
+                size_t produced = chunk.size() - stream.avail_out;
+                if (produced > 0 && !emit(reinterpret_cast<const char *>(chunk.data()), produced))
+                {
+                    return false;
+                }
+            } while (stream.avail_out == 0 || stream.avail_in > 0);
+            return true;
+        }
+
+        bool resetStream()
+        {
+            if (streamReady && streamLevel == level)
+            {
+                return deflateReset(&stream) == Z_OK || error("Deflate reset failed");
+            }
+            if (streamReady)
+            {
+                deflateEnd(&stream);
+                streamReady = false;
+            }
+            stream = z_stream();
+            // Negative window bits: raw deflate data, as ZIP stores it
+            if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                return error("Deflate initialization failed");
+            }
+            streamReady = true;
+            streamLevel = level;
+            return true;
+        }
+
+        bool writeLocalHeader(const Entry &entry)
+        {
+            bool known = (entry.flags & kFlagDescriptor) == 0;
+            std::string header;
+            header.reserve(30 + entry.name.size());
+            put32(header, kLocalHeaderSignature);
+            put16(header, kVersion);
+            put16(header, entry.flags);
+            put16(header, entry.method);
+            put16(header, dosTime);
+            put16(header, dosDate);
+            put32(header, known ? entry.crc : 0);
+            put32(header, known ? static_cast<uint32_t>(entry.compressedSize) : 0);
+            put32(header, known ? static_cast<uint32_t>(entry.size) : 0);
+            put16(header, static_cast<uint16_t>(entry.name.size()));
+            put16(header, 0);
+            header += entry.name;
+            return out.write(header) || error(out.getLastError());
+        }
+
+        bool checkNewEntry(const std::string &name)
+        {
+            if (finished)
+            {
+                return error("Archive already finished");
+            }
+            if (name.empty() || name.size() > 0xffff)
+            {
+                return error("Invalid entry name: " + name);
+            }
+            if (entries.size() >= 0xffff)
+            {
+                return error("Too many entries for a ZIP archive");
+            }
+            if (offset() > 0xffffffffu)
+            {
+                return error("Archive exceeds 4 GiB");
+            }
+            return true;
+        }
+
+        bool endEntry()
+        {
+            if (!sink)
+            {
+                return true;
+            }
+            std::unique_ptr<EntrySink> current = std::move(sink);
+            if (!current->flush())
+            {
+                return error(current->getLastError());
+            }
+
+            Entry &entry = entries.back();
+            if (entry.method == kMethodDeflate && !deflateData(nullptr, 0, Z_FINISH))
+            {
+                return false;
+            }
+            if (entry.size > 0xffffffffu || entry.compressedSize > 0xffffffffu)
+            {
+                return error("Entry exceeds 4 GiB: " + entry.name);
+            }
+
+            std::string descriptor;
+            put32(descriptor, kDescriptorSignature);
+            put32(descriptor, entry.crc);
+            put32(descriptor, static_cast<uint32_t>(entry.compressedSize));
+            put32(descriptor, static_cast<uint32_t>(entry.size));
+            return out.write(descriptor) || error(out.getLastError());
+        }
+    };
+
+    ZipWriter::ZipWriter(OutputSink &out)
+        : pImpl_(std::make_unique<Impl>(out))
+    {
+    }
+
+    ZipWriter::~ZipWriter() = default;
+
+    OutputSink *ZipWriter::beginEntry(const std::string &name, Method method)
+    {
+        if (!endEntry() || !pImpl_->checkNewEntry(name))
+        {
+            return nullptr;
+        }
+        if (method == Method::Deflate && !pImpl_->resetStream())
+        {
+            return nullptr;
+        }
+
+        uint16_t flags = kFlagDescriptor | kFlagUtf8;
+        uint16_t code = method == Method::Deflate ? kMethodDeflate : kMethodStore;
+        pImpl_->entries.push_back({name, flags, code, 0, 0, 0, pImpl_->offset()});
+        if (!pImpl_->writeLocalHeader(pImpl_->entries.back()))
+        {
+            return nullptr;
+        }
+        pImpl_->sink = std::make_unique<Impl::EntrySink>(*pImpl_);
+        return pImpl_->sink.get();
+    }
+
+    bool ZipWriter::endEntry()
+    {
+        return pImpl_->endEntry();
+    }
+
+    bool ZipWriter::addEntry(const std::string &name, std::string_view data, Method method)
+    {
+        if (method == Method::Deflate)
+        {
+            OutputSink *entry = beginEntry(name, method);
+            return entry != nullptr && entry->write(data) && endEntry();
+        }
+
+        // Stored data of known size: sizes go in the local header, so readers
+        // that stream the archive can skip the entry
+        if (!endEntry() || !pImpl_->checkNewEntry(name))
+        {
+            return false;
+        }
+        if (data.size() > 0xffffffffu)
+        {
+            return pImpl_->error("Entry exceeds 4 GiB: " + name);
+        }
+        uint32_t crc = static_cast<uint32_t>(
+            crc32(0, reinterpret_cast<const Bytef *>(data.data()), static_cast<uInt>(data.size())));
+        pImpl_->entries.push_back({name, kFlagUtf8, kMethodStore, crc, data.size(), data.size(), pImpl_->offset()});
+        if (!pImpl_->writeLocalHeader(pImpl_->entries.back()) || !pImpl_->out.write(data))
+        {
+            return pImpl_->error(pImpl_->out.getLastError());
+        }
+        return true;
+    }
+
+    bool ZipWriter::finish()
+    {
+        if (pImpl_->finished)
+        {
+            return true;
+        }
+        if (!endEntry())
+        {
+            return false;
+        }
+
+        uint64_t directoryOffset = pImpl_->offset();
+        std::string directory;
+        for (const Impl::Entry &entry : pImpl_->entries)
+        {
+            put32(directory, kCentralHeaderSignature);
+            put16(directory, kVersion | 0x0300); // Made by: Unix
+            put16(directory, kVersion);
+            put16(directory, entry.flags);
+            put16(directory, entry.method);
+            put16(directory, pImpl_->dosTime);
+            put16(directory, pImpl_->dosDate);
+            put32(directory, entry.crc);
+            put32(directory, static_cast<uint32_t>(entry.compressedSize));
+            put32(directory, static_cast<uint32_t>(entry.size));
+            put16(directory, static_cast<uint16_t>(entry.name.size()));
+            put16(directory, 0); // Extra field
+            put16(directory, 0); // Comment
+            put16(directory, 0); // Disk
+            put16(directory, 0); // Internal attributes
+            put32(directory, 0100644u << 16); // External attributes: regular file, rw-r--r--
+            put32(directory, static_cast<uint32_t>(entry.offset));
+            directory += entry.name;
+        }
+        if (directoryOffset > 0xffffffffu || directory.size() > 0xffffffffu - directoryOffset)
+        {
+            return pImpl_->error("Archive exceeds 4 GiB");
+        }
+
+        uint32_t directorySize = static_cast<uint32_t>(directory.size());
+        put32(directory, kEndSignature);
+        put16(directory, 0); // This disk
+        put16(directory, 0); // Directory disk
+        put16(directory, static_cast<uint16_t>(pImpl_->entries.size()));
+        put16(directory, static_cast<uint16_t>(pImpl_->entries.size()));
+        put32(directory, directorySize);
+        put32(directory, static_cast<uint32_t>(directoryOffset));
+        put16(directory, 0); // Comment
+
+        pImpl_->finished = true;
+        if (!pImpl_->out.write(directory) || !pImpl_->out.flush())
+        {
+            return pImpl_->error(pImpl_->out.getLastError());
+        }
+        return true;
+    }
+
+    void ZipWriter::setCompressionLevel(int level)
+    {
+        pImpl_->level = level < 1 ? 1 : (level > 9 ? 9 : level);
+    }
+
+    std::string ZipWriter::getLastError() const
+    {
+        return pImpl_->lastError;
+    }
+
+} // namespace json2doc
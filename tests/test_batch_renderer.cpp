@@ -0,0 +1,352 @@
+#include "json2doc/batch_renderer.h"
+#include "json2doc/json_merge.h"
+#include "json2doc/xml_document.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+/**
+ * @brief TDD Test Suite for BatchRenderer class
+ */
+
+std::string createTemplateXml()
+{
+    return R"(<?xml version="1.0" encoding="UTF-8"?>
+<w:document xmlns:w="http://schemas.openxmlformats.org/wordprocessingml/2006/main">
+  <w:body>
+    <w:p>
+      <w:r>
+        <w:t>Name: {{name}}</w:t>
+      </w:r>
+    </w:p>
+    <w:p>
+      <w:r>
+        <w:t>Id: {{ record.id }} / {{name}}</w:t>
+      </w:r>
+    </w:p>
+    <w:p>
+      <w:r>
+        <w:t>Missing: {{missing}}</w:t>
+      </w:r>
+    </w:p>
+  </w:body>
+</w:document>)";
+}
+
+std::string createRecord(size_t i)
+{
+    return "{\"name\": \"Person " + std::to_string(i) + "\", \"record\": {\"id\": " + std::to_string(i) + "}}";
+}
+
+// Test 1: Thread count defaults to the hardware
+void testThreadCount()
+{
+    std::cout << "Test 1: Thread count configuration... ";
+    json2doc::BatchRenderer automatic;
+    assert(automatic.getThreadCount() >= 1);
+    json2doc::BatchRenderer fixed(3);
+    assert(fixed.getThreadCount() == 3);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 2: Invalid templates are rejected
+void testInvalidTemplate()
+{
+    std::cout << "Test 2: Invalid template is rejected... ";
+    json2doc::BatchRenderer renderer(2);
+    assert(!renderer.loadTemplateString("<w:document><w:body>"));
+    assert(!renderer.getLastError().empty());
+    assert(!renderer.loadTemplate("/nonexistent/template.docx"));
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 3: Rendering without a template does nothing
+void testRenderWithoutTemplate()
+{
+    std::cout << "Test 3: Render without template... ";
+    json2doc::BatchRenderer renderer(2);
+    std::vector<std::string> records = {createRecord(1)};
+    assert(renderer.renderAll(records).empty());
+    assert(!renderer.getLastError().empty());
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 4: Template variables are collected once
+void testTemplateVariables()
+{
+    std::cout << "Test 4: Template variables... ";
+    json2doc::BatchRenderer renderer(2);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+    const auto &variables = renderer.getTemplateVariables();
+    assert(variables.size() == 3);
+    assert(variables[0] == "name");
+    assert(variables[1] == "record.id");
+    assert(variables[2] == "missing");
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 5: Results match the serial path and arrive in input order
+void testMatchesSerialRendering()
+{
+    std::cout << "Test 5: Parallel output matches serial output... ";
+    json2doc::BatchRenderer renderer(4);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+
+    std::vector<std::string> records;
+    for (size_t i = 0; i < 200; i++)
+    {
+        records.push_back(createRecord(i));
+    }
+
+    std::vector<json2doc::BatchRenderer::Result> results = renderer.renderAll(records);
+    assert(results.size() == records.size());
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        json2doc::XmlDocument doc;
+        json2doc::JsonMerge merger;
+        assert(doc.loadFromString(createTemplateXml()));
+        assert(merger.loadJsonString(records[i]));
+        int replaced = merger.mergeIntoXml(doc);
+
+        assert(results[i].index == i);
+        assert(results[i].ok);
+        assert(results[i].replaced == replaced);
+        assert(results[i].output == doc.toString());
+        assert(results[i].output.find("Person " + std::to_string(i) + "<") != std::string::npos);
+        assert(results[i].output.find("{{missing}}") != std::string::npos);
+    }
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 6: A bad record fails alone
+void testInvalidRecord()
+{
+    std::cout << "Test 6: Invalid record does not stop the batch... ";
+    json2doc::BatchRenderer renderer(3);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+
+    std::vector<std::string> records = {createRecord(0), "{\"name\": ", createRecord(2)};
+    std::vector<json2doc::BatchRenderer::Result> results = renderer.renderAll(records);
+    assert(results.size() == 3);
+    assert(results[0].ok);
+    assert(!results[1].ok);
+    assert(!results[1].error.empty());
+    assert(results[1].output.empty());
+    assert(results[2].ok);
+    assert(results[2].output.find("Person 2") != std::string::npos);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 7: Streaming source and sink keep input order
+void testStreamingOrder()
+{
+    std::cout << "Test 7: Streaming source delivers in order... ";
+    json2doc::BatchRenderer renderer(8);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+
+    const size_t count = 5000;
+    size_t produced = 0;
+    size_t expected = 0;
+    size_t rendered = renderer.render([&](std::string &record)
+                                      {
+                                          if (produced == count)
+                                          {
+                                              return false;
+                                          }
+                                          record = createRecord(produced++);
+                                          return true; },
+                                      [&](json2doc::BatchRenderer::Result &&result)
+                                      {
+                                          assert(result.index == expected);
+                                          assert(result.output.find("Person " + std::to_string(expected) + "<") != std::string::npos);
+                                          expected++;
+                                      });
+    assert(rendered == count);
+    assert(expected == count);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 8: Empty input
+void testEmptyInput()
+{
+    std::cout << "Test 8: Empty input... ";
+    json2doc::BatchRenderer renderer(4);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+    std::vector<std::string> records;
+    assert(renderer.renderAll(records).empty());
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 9: Repeating sections expand per record
+void testRepeatingSections()
+{
+    std::cout << "Test 9: Repeating sections per record... ";
+    std::string xml = R"(<?xml version="1.0" encoding="UTF-8"?>
+<w:document xmlns:w="http://schemas.openxmlformats.org/wordprocessingml/2006/main">
+  <w:body>
+    <w:p><w:r><w:t>Order {{id}}</w:t></w:r></w:p>
+    <w:tbl>
+      <w:tr>
+        <w:tc><w:p><w:r><w:t>{{#lines}}{{sku}}</w:t></w:r></w:p></w:tc>
+        <w:tc><w:p><w:r><w:t>{{qty}}{{/lines}}</w:t></w:r></w:p></w:tc>
+      </w:tr>
+    </w:tbl>
+  </w:body>
+</w:document>)";
+
+    json2doc::BatchRenderer renderer(3);
+    assert(renderer.loadTemplateString(xml));
+
+    std::vector<std::string> records;
+    for (size_t i = 0; i < 30; i++)
+    {
+        std::string lines;
+        for (size_t j = 0; j < i % 5; j++)
+        {
+            lines += std::string(j ? ", " : "") + "{\"sku\": \"S" + std::to_string(i) + "-" + std::to_string(j) +
+                     "\", \"qty\": " + std::to_string(j + 1) + "}";
+        }
+        records.push_back("{\"id\": " + std::to_string(i) + ", \"unused\": {\"x\": 1}, \"lines\": [" + lines + "]}");
+    }
+
+    std::vector<json2doc::BatchRenderer::Result> results = renderer.renderAll(records);
+    assert(results.size() == records.size());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        json2doc::XmlDocument doc;
+        json2doc::JsonMerge merger;
+        assert(doc.loadFromString(xml));
+        assert(merger.loadJsonString(records[i]));
+        merger.mergeIntoXml(doc);
+
+        assert(results[i].ok);
+        assert(results[i].output == doc.toString());
+        assert(doc.query("//w:tr").size() == i % 5);
+        if (i % 5 > 1)
+        {
+            assert(results[i].output.find(">S" + std::to_string(i) + "-1<") != std::string::npos);
+        }
+        assert(results[i].output.find("{{") == std::string::npos);
+    }
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 10: A memory limit fails records instead of the process
+void testMemoryLimit()
+{
+    std::cout << "Test 10: Per-document memory limit... ";
+    json2doc::BatchRenderer renderer(2);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+    std::vector<std::string> records = {createRecord(0), createRecord(1), createRecord(2)};
+
+    renderer.setMemoryLimit(1);
+    std::vector<json2doc::BatchRenderer::Result> results = renderer.renderAll(records);
+    assert(results.size() == records.size());
+    for (const auto &result : results)
+    {
+        assert(!result.ok && result.output.empty());
+        assert(result.error.find("Memory limit exceeded") != std::string::npos);
+    }
+
+    renderer.setMemoryLimit(0);
+    results = renderer.renderAll(records);
+    assert(results.size() == records.size() && results[2].ok);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 11: A throwing sink stops the batch and reaches the caller
+void testSinkException()
+{
+    std::cout << "Test 11: Sink exception is rethrown after the workers stop... ";
+    json2doc::BatchRenderer renderer(4);
+    assert(renderer.loadTemplateString(createTemplateXml()));
+
+    size_t produced = 0;
+    size_t delivered = 0;
+    bool caught = false;
+    try
+    {
+        renderer.render([&produced](std::string &record)
+                        {
+                            if (produced == 1000)
+                            {
+                                return false;
+                            }
+                            record = createRecord(produced++);
+                            return true; },
+                        [&delivered](json2doc::BatchRenderer::Result &&result)
+                        {
+                            assert(result.index == delivered);
+                            if (++delivered == 5)
+                            {
+                                throw std::runtime_error("disk full");
+                            }
+                        });
+    }
+    catch (const std::runtime_error &e)
+    {
+        caught = std::string(e.what()) == "disk full";
+    }
+    assert(caught);
+    assert(delivered == 5);
+    assert(produced < 1000); // The source was not drained after the failure
+    assert(!renderer.getLastError().empty());
+
+    // The renderer is usable again
+    std::vector<json2doc::BatchRenderer::Result> results = renderer.renderAll({createRecord(0), createRecord(1)});
+    assert(results.size() == 2 && results[0].ok && results[1].ok);
+    std::cout << "✓ PASSED\n";
+}
+
+int main()
+{
+    std::cout << "\n";
+    std::cout << "╔════════════════════════════════════════════════════════╗\n";
+    std::cout << "║        BatchRenderer TDD Test Suite                    ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════╝\n";
+    std::cout << "\n";
+
+    int testCount = 0;
+
+    try
+    {
+        testThreadCount();
+        testCount++;
+        testInvalidTemplate();
+        testCount++;
+        testRenderWithoutTemplate();
+        testCount++;
+        testTemplateVariables();
+        testCount++;
+        testMatchesSerialRendering();
+        testCount++;
+        testInvalidRecord();
+        testCount++;
+        testStreamingOrder();
+        testCount++;
+        testEmptyInput();
+        testCount++;
+        testRepeatingSections();
+        testCount++;
+        testMemoryLimit();
+        testCount++;
+        testSinkException();
+        testCount++;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "\n✗ Test failed with exception: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "\n";
+    std::cout << "╔════════════════════════════════════════════════════════╗\n";
+    std::cout << "║  ✓ All " << testCount << " tests passed successfully!                ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════╝\n";
+    std::cout << "\n";
+
+    return 0;
+}
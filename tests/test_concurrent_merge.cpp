@@ -0,0 +1,268 @@
+#include "json2doc/json_merge.h"
+#include "json2doc/xml_document.h"
+#include "json2doc/compiled_template.h"
+#include "json2doc/output_sink.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+/**
+ * @brief Stress test: many threads merging against one loaded JsonMerge
+ *
+ * Every test shares a single JsonMerge (or, for the const XmlDocument
+ * queries, a single XmlDocument) between the threads and checks each
+ * result. Build it with -fsanitize=thread (make test-tsan) to prove the
+ * const API free of data races.
+ */
+
+const size_t kThreads = 8;
+const size_t kIterations = 500;
+
+std::string createJson()
+{
+    return R"({
+        "name": "Ana",
+        "company": {"name": "ACME", "city": "Lisboa"},
+        "items": [{"label": "first"}, {"label": "second"}],
+        "total": 42.5
+    })";
+}
+
+std::string createTemplateXml()
+{
+    return R"(<?xml version="1.0" encoding="UTF-8"?>
+<w:document xmlns:w="http://schemas.openxmlformats.org/wordprocessingml/2006/main">
+  <w:body>
+    <w:p><w:r><w:t>{{name}} works at {{company.name}}</w:t></w:r></w:p>
+    <w:p><w:r><w:t>{{#items}}- {{label}}{{/items}}</w:t></w:r></w:p>
+    <w:p><w:r><w:t>Total {{total}} {{missing}}</w:t></w:r></w:p>
+  </w:body>
+</w:document>)";
+}
+
+// Run body(thread) on kThreads threads at once
+template <typename Body>
+void runThreads(Body body)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&go, &body, t]()
+                             {
+                                 while (!go.load())
+                                 {
+                                     std::this_thread::yield();
+                                 }
+                                 body(t); });
+    }
+    go.store(true);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Test 1: Text merges with per-call stats
+void testConcurrentText()
+{
+    std::cout << "Test 1: Concurrent text merges... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(createJson()));
+
+    const std::string text = "{{name}} / {{company.city}} / {{items.1.label}} / {{nothing}}";
+    const std::string expected = "Ana / Lisboa / second / {{nothing}}";
+    std::atomic<int> failures(0);
+
+    runThreads([&](size_t)
+               {
+                   for (size_t i = 0; i < kIterations; i++)
+                   {
+                       json2doc::JsonMerge::MergeStats stats;
+                       if (merger.replaceVariables(text, stats) != expected || stats.found != 4 ||
+                           stats.replaced != 3 || stats.missing != 1)
+                       {
+                           failures++;
+                       }
+                   } });
+
+    assert(failures == 0);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 2: Compiled templates and typed reads
+void testConcurrentReads()
+{
+    std::cout << "Test 2: Concurrent templates and typed reads... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(createJson()));
+
+    const json2doc::CompiledTemplate tmpl("{{company.name}}: {{total}}");
+    std::atomic<int> failures(0);
+
+    runThreads([&](size_t)
+               {
+                   for (size_t i = 0; i < kIterations; i++)
+                   {
+                       json2doc::JsonMerge::MergeStats stats;
+                       if (merger.replaceVariables(tmpl, stats) != "ACME: 42.5" || stats.replaced != 2)
+                       {
+                           failures++;
+                       }
+                       if (merger.getJsonValue("items").size() != 2 ||
+                           merger.getJsonValue("items.0.label").asString() != "first" ||
+                           merger.getRoot().find("total").asDouble() != 42.5 || !merger.hasKey("company.city"))
+                       {
+                           failures++;
+                       }
+                   } });
+
+    assert(failures == 0);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 3: XML merges of per-thread documents
+void testConcurrentXml()
+{
+    std::cout << "Test 3: Concurrent XML merges... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(createJson()));
+
+    json2doc::XmlDocument reference;
+    assert(reference.loadFromString(createTemplateXml()));
+    json2doc::JsonMerge::MergeStats expectedStats;
+    int expectedReplaced = merger.mergeIntoXml(reference, expectedStats);
+    const std::string expected = reference.toString();
+    assert(expectedStats.found == 6 && expectedStats.replaced == 5 && expectedStats.missing == 1);
+
+    std::atomic<int> failures(0);
+    runThreads([&](size_t)
+               {
+                   json2doc::XmlDocument doc;
+                   for (size_t i = 0; i < kIterations / 10; i++)
+                   {
+                       json2doc::JsonMerge::MergeStats stats;
+                       if (!doc.loadFromString(createTemplateXml()) ||
+                           merger.mergeIntoXml(doc, stats) != expectedReplaced ||
+                           stats.found != expectedStats.found || doc.toString() != expected)
+                       {
+                           failures++;
+                       }
+                   } });
+
+    assert(failures == 0);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 4: The legacy stats API stays race-free
+void testConcurrentLegacyStats()
+{
+    std::cout << "Test 4: Concurrent legacy getStats()... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(createJson()));
+
+    std::atomic<int> failures(0);
+    runThreads([&](size_t t)
+               {
+                   // Even threads replace one variable, odd threads two
+                   const std::string text = t % 2 == 0 ? "{{name}}" : "{{name}} {{total}}";
+                   for (size_t i = 0; i < kIterations; i++)
+                   {
+                       merger.replaceVariables(text);
+                       auto stats = merger.getStats();
+                       if (stats["found"] != stats["replaced"] || stats["found"] < 1 || stats["found"] > 2)
+                       {
+                           failures++;
+                       }
+                   } });
+
+    assert(failures == 0);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 5: Const queries on one shared XmlDocument
+void testConcurrentXmlQueries()
+{
+    std::cout << "Test 5: Concurrent const queries and saves on one document... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(createTemplateXml()));
+    doc.setXPathCacheCapacity(2); // Fewer entries than expressions: hits, misses and evictions
+
+    // An edit drops the text tables, so the first reads rebuild them concurrently
+    assert(doc.setNodeText("/w:document/w:body/w:p[3]/w:r/w:t", "Total {{total}}"));
+
+    json2doc::XmlDocument reference;
+    assert(reference.loadFromString(createTemplateXml()));
+    assert(reference.setNodeText("/w:document/w:body/w:p[3]/w:r/w:t", "Total {{total}}"));
+    const std::string text = reference.getTextContent();
+    const size_t symbols = reference.getSymbols().size();
+    json2doc::MemorySink referenceOutput;
+    assert(reference.save(referenceOutput));
+    const std::string saved = referenceOutput.take();
+
+    const std::vector<std::string> paths = {"//w:t", "/w:document/w:body/w:p[1]/w:r/w:t", "/w:document/w:body/w:p",
+                                            "//w:r"};
+    std::atomic<int> failures(0);
+    runThreads([&](size_t t)
+               {
+                   for (size_t i = 0; i < kIterations; i++)
+                   {
+                       const std::string &path = paths[(t + i) % paths.size()];
+                       json2doc::MemorySink output;
+                       if (!doc.save(output) || output.view() != saved ||
+                           doc.query(path).empty() || doc.select(path).empty() || !doc.selectNode(path).isValid() ||
+                           doc.getNode(path).name.empty() || doc.findTextNodes("//w:t").size() != 3 ||
+                           doc.findTextNodes().size() != 3 ||
+                           doc.getAttributeValue("/w:document", "xmlns:w").empty() ||
+                           doc.getTextContent() != text || doc.getSymbols().size() != symbols)
+                       {
+                           failures++;
+                       }
+                   } });
+
+    assert(failures == 0);
+    json2doc::XmlDocument::XPathCacheStats stats = doc.getXPathCacheStats();
+    assert(stats.entries <= 2 && stats.hits + stats.misses > 0);
+    std::cout << "✓ PASSED\n";
+}
+
+int main()
+{
+    std::cout << "\n";
+    std::cout << "╔════════════════════════════════════════════════════════╗\n";
+    std::cout << "║        JsonMerge Concurrency Stress Test               ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════╝\n";
+    std::cout << "\n";
+
+    int testCount = 0;
+
+    try
+    {
+        testConcurrentText();
+        testCount++;
+        testConcurrentReads();
+        testCount++;
+        testConcurrentXml();
+        testCount++;
+        testConcurrentLegacyStats();
+        testCount++;
+        testConcurrentXmlQueries();
+        testCount++;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "\n✗ Test failed with exception: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "\n";
+    std::cout << "╔════════════════════════════════════════════════════════╗\n";
+    std::cout << "║  ✓ All " << testCount << " tests passed successfully!                ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════╝\n";
+    std::cout << "\n";
+
+    return 0;
+}
@@ -1,8 +1,18 @@
 #include "json2doc/json_merge.h"
+#include "json2doc/structural_index.h"
+#include "json2doc/key_index.h"
+#include "json2doc/compiled_template.h"
+#include "json2doc/placeholder_scanner.h"
 #include <iostream>
 #include <cassert>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <regex>
+#include <random>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
 
 /**
  * @brief TDD Test Suite for JsonMerge class
@@ -361,7 +371,624 @@ void testEmptyTemplate()
     std::cout << "✓ PASSED\n";
 }
 
+// Test 21: Deeply nested objects do not overflow the stack
+void testDeepNesting()
+{
+    std::cout << "Test 21: Deeply nested objects... ";
+    const int depth = 100000;
+    std::string json;
+    json.reserve(depth * 8);
+    for (int i = 0; i < depth; i++)
+    {
+        json += "{\"a\":";
+    }
+    json += "\"leaf\"";
+    json.append(depth, '}');
+
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(json) == true);
+
+    std::vector<std::string> keys = merger.getAllKeys();
+    assert(keys.size() == 1);
+    assert(keys[0].size() == depth * 2 - 1);
+    assert(merger.getValue(keys[0]) == "leaf");
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 22: Escaped quotes, arrays and literals are flattened like before
+void testValueKinds()
+{
+    std::cout << "Test 22: Escaped strings, arrays and literals... ";
+    json2doc::JsonMerge merger;
+    std::string json = R"({
+        "quote": "say \"hi\"",
+        "tags": ["a]", "b", {"c": [1, 2]}],
+        "count": 42 ,
+        "active": true,
+        "nested": {"empty": {}, "deep": {"value": null}},
+        "after": "ok"
+    })";
+    assert(merger.loadJsonString(json) == true);
+
+    assert(merger.getValue("quote") == R"(say \"hi\")");
+    assert(merger.getValue("tags") == R"(["a]", "b", {"c": [1, 2]}])");
+    assert(merger.getValue("count") == "42");
+    assert(merger.getValue("active") == "true");
+    assert(merger.getValue("nested.deep.value") == "null");
+    assert(merger.getValue("after") == "ok");
+    assert(!merger.hasKey("nested.empty"));
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 23: Malformed JSON reports an error
+void testMalformedJson()
+{
+    std::cout << "Test 23: Malformed JSON reports an error... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(R"({"name": "unterminated)") == false);
+    assert(!merger.getLastError().empty());
+    assert(merger.loadJsonString(R"({"a": {"b": "c")") == false);
+
+    // Bytes between delimiters must be a literal or whitespace
+    assert(merger.loadJsonString(R"({"a": 1 "b"})") == false);
+    assert(merger.loadJsonString(R"({"a": [1,]})") == false);
+    assert(merger.loadJsonString(R"({"a": [1, x {"b": 2}]})") == false);
+    assert(merger.loadJsonString(R"({"a": "b" x, "c": 1})") == false);
+    assert(merger.loadJsonString(R"({"a": 1, x "c": 1})") == false);
+    assert(merger.loadJsonString(R"({"a": 1,})") == false);
+    assert(merger.loadJsonString(R"({"a": })") == false);
+    assert(merger.loadJsonString(R"({"a": 1 2})") == false);
+    assert(merger.loadJsonString(R"({"a": true false})") == false);
+    assert(merger.loadJsonString(R"({"a": [1 2]})") == false);
+    assert(merger.loadJsonString(R"({"a": [ ], "b": { }, "c": [ 1 , "x" , {"d": null} ] })") == true);
+    assert(merger.loadJsonString(createSimpleJson()) == true);
+    assert(merger.getLastError().empty());
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 24: Every structural index kernel finds the same positions
+void testStructuralIndexBackends()
+{
+    std::cout << "Test 24: Structural index kernels agree... ";
+    using json2doc::StructuralIndex;
+
+    // Mix of structural characters, text and bytes >= 0x80 (UTF-8), with an
+    // odd length so the padded tail block is exercised
+    std::string text;
+    unsigned int seed = 12345;
+    const std::string alphabet = "\"\\{}[]:, abcZ|+<;=-*2Rrz\xc3\xa9";
+    for (int i = 0; i < 4099; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        text += alphabet[(seed >> 16) % alphabet.size()];
+    }
+
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (std::string("\"\\{}[]:,").find(text[i]) != std::string::npos)
+        {
+            expected.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    const StructuralIndex::Backend backends[] = {StructuralIndex::Backend::Scalar,
+                                                 StructuralIndex::Backend::Sse42,
+                                                 StructuralIndex::Backend::Avx2};
+    for (auto backend : backends)
+    {
+        if (!StructuralIndex::isSupported(backend))
+        {
+            continue;
+        }
+        std::vector<uint32_t> positions;
+        StructuralIndex::classify(text.data(), text.size(), backend, positions);
+        assert(positions == expected);
+    }
+
+    std::cout << "✓ PASSED (" << StructuralIndex::backendName(StructuralIndex::bestBackend()) << ")\n";
+}
+
+// Test 25: Mapped and buffered file loads produce the same data
+void testMappedLoad()
+{
+    std::cout << "Test 25: Mapped vs buffered file load... ";
+    json2doc::JsonMerge mapped;
+    json2doc::JsonMerge buffered;
+
+    if (!mapped.loadJson("data.json", json2doc::JsonMerge::LoadMode::Mapped))
+    {
+        std::cout << "⊘ SKIPPED (file not found)\n";
+        return;
+    }
+    assert(buffered.loadJson("data.json", json2doc::JsonMerge::LoadMode::Buffered));
+
+    std::vector<std::string> keys = mapped.getAllKeys();
+    assert(keys == buffered.getAllKeys());
+    for (const auto &key : keys)
+    {
+        assert(mapped.getValue(key) == buffered.getValue(key));
+    }
+    assert(mapped.getValue("metadata.version") == "1.0.0");
+
+    assert(!mapped.loadJson("does_not_exist.json"));
+    assert(!mapped.getLastError().empty());
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 26: Copies and moves keep values valid after the source goes away
+void testCopyAndMove()
+{
+    std::cout << "Test 26: Copy and move keep loaded values... ";
+    json2doc::JsonMerge copied;
+    json2doc::JsonMerge moved;
+    {
+        json2doc::JsonMerge small;
+        small.loadJsonString(R"({"a": "b"})"); // fits in the short string buffer
+        moved = std::move(small);
+
+        json2doc::JsonMerge fromFile;
+        if (fromFile.loadJson("data.json"))
+        {
+            copied = fromFile;
+        }
+        else
+        {
+            copied.loadJsonString(createNestedJson());
+        }
+    }
+
+    assert(moved.getValue("a") == "b");
+    assert(copied.getValue("metadata.version") == "1.0.0");
+
+    json2doc::JsonMerge again(moved);
+    assert(again.getValue("a") == "b");
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 27: Key index grows, overwrites and misses correctly
+void testKeyIndex()
+{
+    std::cout << "Test 27: Open-addressing key index... ";
+    json2doc::KeyIndex index;
+    json2doc::Arena keys;
+    std::vector<std::string> values;
+    const int count = 100000;
+    for (int i = 0; i < count; i++)
+    {
+        values.push_back("value" + std::to_string(i));
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        index.insert("record" + std::to_string(i) + ".name", values[i], keys);
+    }
+    assert(index.size() == count);
+
+    // Overwriting keeps a single entry
+    index.insert("record7.name", values[8], keys);
+    assert(index.size() == count);
+    assert(index.find("record7.name")->value == "value8");
+
+    for (int i = 0; i < count; i += 997)
+    {
+        const json2doc::KeyIndex::Entry *entry = index.find("record" + std::to_string(i) + ".name");
+        assert(entry != nullptr);
+        assert(entry->key == "record" + std::to_string(i) + ".name");
+    }
+    assert(index.find("record1.missing") == nullptr);
+    assert(index.find("") == nullptr);
+
+    index.clear();
+    assert(index.empty());
+    assert(index.find("record1.name") == nullptr);
+
+    std::cout << "✓ PASSED\n";
+}
+
 // Main test runner
+// Test 28: Keys and the owned JSON text live in one arena that is reused per load
+void testArenaLoad()
+{
+    std::cout << "Test 28: Arena-backed loads... ";
+    std::string json = "{";
+    for (int i = 0; i < 2000; i++)
+    {
+        json += (i > 0 ? ", " : "") + std::string("\"field") + std::to_string(i) + "\": \"value" + std::to_string(i) + "\"";
+    }
+    json += ", \"nested\": {\"inner\": 1}}";
+
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(json));
+    json2doc::Arena::Stats first = merger.getLoadStats();
+    // One copy of the text plus one allocation per distinct key
+    assert(first.allocations == merger.getAllKeys().size() + 1);
+    assert(first.bytesUsed > json.size());
+    assert(first.blockAllocations > 0);
+
+    // Reloading rewinds the arena and reuses its blocks
+    assert(merger.loadJsonString(json));
+    json2doc::Arena::Stats second = merger.getLoadStats();
+    assert(second.allocations == first.allocations);
+    assert(second.bytesUsed == first.bytesUsed);
+    assert(second.blockAllocations == 0);
+    assert(second.bytesReserved == first.bytesReserved);
+    assert(merger.getValue("field1999") == "value1999");
+    assert(merger.getValue("nested.inner") == "1");
+
+    // Moving keeps the arena blocks, so the moved-to object stays usable
+    json2doc::JsonMerge moved(std::move(merger));
+    assert(moved.getValue("field42") == "value42");
+    assert(merger.getAllKeys().empty());
+
+    moved.clear();
+    assert(moved.getLoadStats().bytesUsed == 0);
+    assert(moved.getLoadStats().allocations == 0);
+
+    // Aligned allocations and allocations larger than a block
+    json2doc::Arena arena(64);
+    arena.allocate(3);
+    char *aligned = arena.allocate(16, 16);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 16 == 0);
+    std::string big(1000, 'x');
+    assert(arena.copy(big) == big);
+    assert(arena.getStats().allocations == 3);
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 29: Compiled templates render exactly like the text path
+void testCompiledTemplate()
+{
+    std::cout << "Test 29: Compiled template rendering... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(createNestedJson()));
+
+    const std::string templates[] = {
+        "",
+        "no placeholders here",
+        "{{title}}",
+        "Title: {{title}}, Version: {{ metadata.version }}!",
+        "{{title}}{{author}}{{missing}}{{title}}",
+        "{{{title}}} {{}} {{ }} {{title}",
+        "Unclosed {{title and {{author}} after",
+        "<w:t>{{metadata.status}}</w:t><w:t>{{sections}}</w:t>"};
+
+    for (const auto &text : templates)
+    {
+        std::string expected = merger.replaceVariables(text);
+        auto expectedStats = merger.getStats();
+
+        json2doc::CompiledTemplate tmpl(text);
+        std::string rendered = merger.replaceVariables(tmpl);
+        assert(rendered == expected);
+        assert(merger.getStats() == expectedStats);
+        assert(tmpl.getVariableCount() == static_cast<size_t>(expectedStats["found"]));
+    }
+
+    // One compiled template serves many records
+    json2doc::CompiledTemplate tmpl("Dear {{ name }}, you owe {{amount}}.");
+    for (int i = 0; i < 50; i++)
+    {
+        assert(merger.loadJsonString("{\"name\": \"N" + std::to_string(i) + "\", \"amount\": " + std::to_string(i) + "}"));
+        assert(merger.replaceVariables(tmpl) == "Dear N" + std::to_string(i) + ", you owe " + std::to_string(i) + ".");
+    }
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 30: The placeholder scanner finds exactly what the old regex found
+void testPlaceholderScanner()
+{
+    std::cout << "Test 30: Regex-free placeholder scanner... ";
+    std::regex varRegex(R"(\{\{([^}]+)\}\})");
+    const char alphabet[] = {'{', '}', 'a', ' ', '.'};
+    std::mt19937 rng(7);
+
+    for (int round = 0; round < 20000; round++)
+    {
+        std::string text;
+        size_t length = rng() % 24;
+        for (size_t i = 0; i < length; i++)
+        {
+            text += alphabet[rng() % sizeof(alphabet)];
+        }
+
+        std::vector<std::pair<size_t, std::string>> expected;
+        std::smatch match;
+        std::string::const_iterator searchStart(text.cbegin());
+        while (std::regex_search(searchStart, text.cend(), match, varRegex))
+        {
+            expected.push_back({static_cast<size_t>(std::distance(text.cbegin(), match[0].first)), match[0].str()});
+            searchStart = match.suffix().first;
+        }
+
+        std::vector<std::pair<size_t, std::string>> actual;
+        json2doc::PlaceholderScanner scanner(text);
+        json2doc::PlaceholderScanner::Match found;
+        while (scanner.next(found))
+        {
+            actual.push_back({found.offset, std::string(found.placeholder)});
+        }
+
+        assert(actual == expected);
+        assert(json2doc::PlaceholderScanner::contains(text) == !expected.empty());
+    }
+
+    // Names are trimmed views into the text
+    std::string text = "x {{  metadata.version\t}} y";
+    json2doc::PlaceholderScanner scanner(text);
+    json2doc::PlaceholderScanner::Match found;
+    assert(scanner.next(found));
+    assert(found.name == "metadata.version");
+    assert(found.name.data() == text.data() + 6);
+    assert(!scanner.next(found));
+
+    // Long runs of unmatched braces stay linear
+    std::string braces(1 << 20, '{');
+    assert(!json2doc::PlaceholderScanner::contains(braces));
+    braces += "a}";
+    assert(!json2doc::PlaceholderScanner::contains(braces));
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 31: Required variables limit what is materialized
+void testRequiredVariables()
+{
+    std::cout << "Test 31: Demand-driven materialization... ";
+    std::string json = R"({
+        "title": "Report",
+        "skipped": {"deep": {"deeper": [1, {"x": "}"}], "s": "{[\"]"}, "n": 2},
+        "metadata": {"version": "1.0.0", "status": "draft", "extra": {"a": 1}},
+        "tags": ["a", "b"],
+        "count": 42,
+        "after": "tail"
+    })";
+
+    json2doc::JsonMerge full;
+    assert(full.loadJsonString(json));
+
+    json2doc::JsonMerge merger;
+    merger.setRequiredVariables({"title", " metadata.version ", "tags", "count", "missing.key", "after"});
+    assert(merger.getRequiredVariables().size() == 6);
+    assert(merger.loadJsonString(json));
+
+    std::vector<std::string> keys = merger.getAllKeys();
+    std::vector<std::string> expected = {"after", "count", "metadata.version", "tags", "title"};
+    assert(keys == expected);
+    for (const auto &key : keys)
+    {
+        assert(merger.getValue(key) == full.getValue(key));
+    }
+    assert(!merger.hasKey("metadata.status"));
+    assert(!merger.hasKey("skipped.n"));
+
+    std::string text = "{{title}} {{metadata.version}} {{metadata.status}}";
+    assert(merger.replaceVariables(text) == "Report 1.0.0 {{metadata.status}}");
+
+    // The selection survives clear() and is copied with the object
+    merger.clear();
+    assert(merger.loadJsonString(json));
+    json2doc::JsonMerge copy(merger);
+    assert(copy.loadJsonString(json));
+    assert(copy.getAllKeys() == expected);
+
+    // Malformed skipped subtrees are still rejected
+    assert(!merger.loadJsonString(R"({"skipped": {"a": "unterminated})"));
+
+    // An empty selection materializes everything again
+    merger.setRequiredVariables({});
+    assert(merger.loadJsonString(json));
+    assert(merger.getAllKeys() == full.getAllKeys());
+
+    // A moved-from object keeps no selection: it materializes everything
+    merger.setRequiredVariables({"title"});
+    json2doc::JsonMerge moved(std::move(merger));
+    assert(merger.loadJsonString(json));
+    assert(merger.getAllKeys() == full.getAllKeys());
+    json2doc::JsonMerge assigned;
+    assigned = std::move(moved);
+    assert(moved.loadJsonString(json));
+    assert(moved.getAllKeys() == full.getAllKeys());
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 32: Typed values and indexed array access
+void testTypedValues()
+{
+    std::cout << "Test 32: Typed values and array indexing... ";
+    std::string json = R"({
+        "title": "Line\nbreak \"q\" é😀",
+        "sections": [
+            {"heading": "Intro", "pages": 3},
+            {"heading": "Body", "tags": ["x", [1, 2.5e1]], "draft": false},
+            "plain", -7, null, []
+        ],
+        "ratio": 0.25,
+        "big": 123456789012,
+        "meta": {"ok": true}
+    })";
+
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(json));
+
+    // Flattened keys are unchanged: array elements are reached by index only
+    std::vector<std::string> keys = {"big", "meta.ok", "ratio", "sections", "title"};
+    assert(merger.getAllKeys() == keys);
+
+    assert(merger.getValue("sections.1.heading") == "Body");
+    assert(merger.getValue(" sections.0.pages ") == "3");
+    assert(merger.getValue("sections.1.tags.1.1") == "2.5e1");
+    assert(merger.getValue("sections.1.tags.1") == "[1, 2.5e1]");
+    assert(merger.getValue("sections.2") == "plain");
+    assert(!merger.hasKey("sections.6"));
+    assert(!merger.hasKey("sections.x"));
+    assert(!merger.hasKey("meta.0"));
+    assert(merger.replaceVariables("{{sections.0.heading}}/{{sections.1.heading}}") == "Intro/Body");
+    json2doc::CompiledTemplate tmpl("{{sections.1.heading}} {{sections.9.heading}}");
+    assert(merger.replaceVariables(tmpl) == "Body {{sections.9.heading}}");
+
+    json2doc::JsonValue sections = merger.getJsonValue("sections");
+    assert(sections.isArray() && sections.size() == 6);
+    assert(sections[0].isObject() && sections[0].get("heading").asString() == "Intro");
+    assert(sections[0].get("pages").getType() == json2doc::JsonType::Int);
+    assert(sections[0].get("pages").asInt() == 3);
+    assert(sections[1].get("draft").isBool() && !sections[1].get("draft").asBool(true));
+    assert(sections[1].find("tags.1.1").asDouble() == 25.0);
+    assert(sections[3].asInt() == -7);
+    assert(sections[4].isNull());
+    assert(sections[5].isArray() && sections[5].size() == 0 && sections[5].getText() == "[]");
+    assert(!sections[6].isValid());
+
+    assert(merger.getJsonValue("ratio").asDouble() == 0.25);
+    assert(merger.getJsonValue("big").asInt() == 123456789012LL);
+    assert(merger.getJsonValue("meta").isObject());
+    assert(merger.getJsonValue("meta.ok").asBool());
+    assert(merger.getJsonValue("title").asString() == "Line\nbreak \"q\" \xc3\xa9\xf0\x9f\x98\x80");
+    assert(merger.getRoot().size() == 5 && merger.getRoot().get("ratio").getKey() == "ratio");
+
+    // Indexing works on copies, and with a required-variable selection that
+    // only names an element of the array
+    json2doc::JsonMerge copy(merger);
+    assert(copy.getValue("sections.1.heading") == "Body");
+    assert(copy.getJsonValue("sections")[1].get("heading").asString() == "Body");
+
+    json2doc::JsonMerge filtered;
+    filtered.setRequiredVariables({"sections.1.heading"});
+    assert(filtered.loadJsonString(json));
+    assert(filtered.getAllKeys().empty());
+    assert(filtered.getValue("sections.1.heading") == "Body");
+    assert(!filtered.getJsonValue("meta").isExpanded());
+
+    // Malformed arrays are rejected now that they are parsed
+    assert(!merger.loadJsonString(R"({"a": [1, 2})"));
+    assert(!merger.loadJsonString(R"({"a": [1 }, "b": 2})"));
+    assert(merger.loadJsonString(R"({"a": [], "b": [[]]})"));
+    assert(merger.getJsonValue("b")[0].isArray());
+
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 33: Patches overlay the loaded data and report changed keys
+void testApplyPatch()
+{
+    std::cout << "Test 33: Apply JSON patch... ";
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(R"({"name": "Ana", "meta": {"version": "1.0", "tags": ["a"]}, "rows": [{"v": 1}]})"));
+
+    std::vector<std::string> changed = merger.applyPatch(R"({"meta": {"version": "2.0", "owner": "Bruno"}, "name": "Ana"})");
+    std::sort(changed.begin(), changed.end());
+    assert((changed == std::vector<std::string>{"meta.owner", "meta.version"}));
+    assert(merger.getValue("meta.version") == "2.0");
+    assert(merger.getValue("meta.owner") == "Bruno");
+    assert(merger.getValue("name") == "Ana");
+    assert(merger.getValue("meta.tags.0") == "a");
+
+    // The typed tree follows: merged objects keep their other members
+    assert(merger.getJsonValue("meta.owner").asString() == "Bruno");
+    assert(merger.getRoot().get("meta").size() == 3);
+    assert(merger.getRoot().find("meta.version").asString() == "2.0");
+
+    // Arrays are replaced as a whole and stay indexable
+    changed = merger.applyPatch(R"({"rows": [{"v": 5}, {"v": 6}], "count": 2})");
+    std::sort(changed.begin(), changed.end());
+    assert((changed == std::vector<std::string>{"count", "rows"}));
+    assert(merger.getValue("rows.1.v") == "6");
+    assert(merger.getJsonValue("rows").size() == 2);
+    assert(merger.getJsonValue("count").asInt() == 2);
+
+    // Copies own the patch text too
+    json2doc::JsonMerge copy(merger);
+    merger.clear();
+    assert(copy.getValue("meta.owner") == "Bruno");
+    assert(copy.getValue("rows.0.v") == "5");
+    assert(copy.getJsonValue("meta").get("version").asString() == "2.0");
+
+    // Nothing changes on an identical or malformed patch
+    assert(copy.applyPatch(R"({"count": 2})").empty());
+    assert(copy.applyPatch(R"({"count": 3)").empty());
+    assert(!copy.getLastError().empty());
+    assert(copy.getValue("count") == "2");
+
+    // A replaced object or array leaves no keys behind, and they are reported
+    json2doc::JsonMerge replaced;
+    assert(replaced.loadJsonString(R"({"a": {"b": 1, "c": {"d": 2}}, "ab": 3, "s": "x", "t": [1]})"));
+    changed = replaced.applyPatch(R"({"a": 2})");
+    std::sort(changed.begin(), changed.end());
+    assert((changed == std::vector<std::string>{"a", "a.b", "a.c.d"}));
+    assert(!replaced.hasKey("a.b") && !replaced.hasKey("a.c.d"));
+    assert(replaced.getValue("a") == "2" && replaced.getValue("ab") == "3");
+    assert(replaced.getAllKeys().size() == 4);
+
+    // ... and neither does a scalar or array replaced by an object
+    changed = replaced.applyPatch(R"({"s": {"y": "z"}, "t": {"u": 4}})");
+    std::sort(changed.begin(), changed.end());
+    assert((changed == std::vector<std::string>{"s", "s.y", "t", "t.u"}));
+    assert(!replaced.hasKey("s") && !replaced.hasKey("t"));
+    assert(replaced.getValue("s.y") == "z" && replaced.getValue("t.u") == "4");
+    assert(replaced.getRoot().get("s").get("y").asString() == "z");
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 34: Binary snapshot round trip
+void testSnapshot()
+{
+    std::cout << "Test 34: Binary snapshot round trip... ";
+    const std::string path = "/tmp/test_json_merge_" + std::to_string(getpid()) + ".snap";
+    {
+        json2doc::JsonMerge merger;
+        assert(merger.loadJsonString(R"({"name": "Ana", "meta": {"version": "1.0", "n": 3}, "rows": [{"v": 1}, {"v": 2}], "ok": true})"));
+        assert(merger.saveSnapshot(path));
+    }
+
+    json2doc::JsonMerge merger;
+    assert(merger.loadSnapshot(path));
+    assert(merger.getValue("name") == "Ana");
+    assert(merger.getValue("meta.version") == "1.0");
+    assert(merger.getValue("rows.1.v") == "2");
+    assert(!merger.hasKey("missing"));
+    assert((merger.getAllKeys() == std::vector<std::string>{"meta.n", "meta.version", "name", "ok", "rows"}));
+    assert(merger.getJsonValue("meta.n").asInt() == 3);
+    assert(merger.getJsonValue("rows").size() == 2);
+    assert(merger.getJsonValue("ok").asBool());
+    assert(merger.getRoot().find("rows.0.v").asInt() == 1);
+    assert(merger.replaceVariables("{{name}} v{{meta.version}}") == "Ana v1.0");
+
+    // Copies and moves keep working after the original is gone
+    json2doc::JsonMerge copy(merger);
+    json2doc::JsonMerge moved(std::move(merger));
+    assert(copy.getValue("rows.0.v") == "1");
+    assert(moved.getJsonValue("meta").get("version").asString() == "1.0");
+
+    // Patching copies the index into memory; saving again keeps the patch
+    assert((copy.applyPatch(R"({"meta": {"version": "2.0"}})") == std::vector<std::string>{"meta.version"}));
+    assert(copy.getValue("meta.version") == "2.0");
+    assert(copy.getValue("name") == "Ana");
+    assert(copy.saveSnapshot(path));
+    json2doc::JsonMerge reloaded;
+    assert(reloaded.loadSnapshot(path));
+    assert(reloaded.getValue("meta.version") == "2.0");
+    assert(reloaded.getJsonValue("meta.n").asInt() == 3);
+    assert(reloaded.getRoot().get("meta").size() == 2);
+
+    // Anything but a snapshot is rejected
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "{\"name\": \"not a snapshot\"}";
+    }
+    assert(!reloaded.loadSnapshot(path));
+    assert(!reloaded.getLastError().empty());
+    assert(!reloaded.hasKey("name"));
+    std::remove(path.c_str());
+    std::cout << "✓ PASSED\n";
+}
+
 int main()
 {
     std::cout << "\n";
@@ -414,6 +1041,34 @@ int main()
         testCount++;
         testEmptyTemplate();
         testCount++;
+        testDeepNesting();
+        testCount++;
+        testValueKinds();
+        testCount++;
+        testMalformedJson();
+        testCount++;
+        testStructuralIndexBackends();
+        testCount++;
+        testMappedLoad();
+        testCount++;
+        testCopyAndMove();
+        testCount++;
+        testKeyIndex();
+        testCount++;
+        testArenaLoad();
+        testCount++;
+        testCompiledTemplate();
+        testCount++;
+        testPlaceholderScanner();
+        testCount++;
+        testRequiredVariables();
+        testCount++;
+        testTypedValues();
+        testCount++;
+        testApplyPatch();
+        testCount++;
+        testSnapshot();
+        testCount++;
     }
     catch (const std::exception &e)
     {
@@ -1,6 +1,18 @@
 #include "json2doc/xml_document.h"
+#include "json2doc/json_merge.h"
+#include "json2doc/output_sink.h"
+#include "json2doc/zip_writer.h"
+#include "json2doc/prepared_template.h"
+#include "json2doc/splice_template.h"
+#include "json2doc/edit_batch.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <cassert>
+#include <cstdio>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
 
 /**
  * @brief TDD Test Suite for XmlDocument class
@@ -347,6 +359,721 @@ void testPartialReplacement()
     std::cout << "✓ PASSED\n";
 }
 
+// Test 21: Repeating sections
+void testExpandSections()
+{
+    std::cout << "Test 21: Expand {{#section}} blocks... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+<w:document xmlns:w="http://schemas.openxmlformats.org/wordprocessingml/2006/main">
+  <w:body>
+    <w:p><w:r><w:t>{{title}}</w:t></w:r></w:p>
+    <w:tbl>
+      <w:tr><w:tc><w:p><w:r><w:t>Name</w:t></w:r></w:p></w:tc></w:tr>
+      <w:tr>
+        <w:tc><w:p><w:r><w:t>{{#rows}}{{name}}</w:t></w:r></w:p></w:tc>
+        <w:tc><w:p><w:r><w:t>{{title}}{{/rows}}</w:t></w:r></w:p></w:tc>
+      </w:tr>
+    </w:tbl>
+    <w:p><w:r><w:t>{{#tags}}[{{.}}]{{/tags}}</w:t></w:r></w:p>
+    <w:p><w:r><w:t>{{#none}}gone{{/none}}</w:t></w:r></w:p>
+    <w:p><w:r><w:t>{{#groups}}{{label}}:</w:t></w:r></w:p>
+    <w:p><w:r><w:t>{{#items}}({{label}}){{/items}}</w:t></w:r></w:p>
+    <w:p><w:r><w:t>{{/groups}}</w:t></w:r></w:p>
+  </w:body>
+</w:document>)"));
+
+    std::map<std::string, std::string> values = {
+        {"title", "Report"},
+        {"rows.0.name", "Ana"},
+        {"rows.1.name", "Bruno"},
+        {"rows.2.name", "Carla"},
+        {"tags.0", "a"},
+        {"tags.1", "b"},
+        {"groups.0.label", "G0"},
+        {"groups.0.items.0.label", "x"},
+        {"groups.1.label", "G1"},
+        {"groups.1.items.0.label", "y"},
+        {"groups.1.items.1.label", "z"}};
+    std::map<std::string, size_t> counts = {{"rows", 3}, {"tags", 2}, {"groups", 2}, {"groups.0.items", 1}, {"groups.1.items", 2}};
+
+    auto lookup = [&values](std::string_view name, std::string_view &value)
+    {
+        auto it = values.find(std::string(name));
+        if (it == values.end())
+        {
+            return false;
+        }
+        value = it->second;
+        return true;
+    };
+    auto sections = [&counts](std::string_view name)
+    {
+        auto it = counts.find(std::string(name));
+        return it == counts.end() ? size_t(0) : it->second;
+    };
+
+    assert(doc.expandSections(sections, lookup) == 6);
+    assert(doc.query("//w:tr").size() == 4);
+    assert(doc.query("//w:p").size() == 1 + 1 + 3 * 2 + 2 + 3 + 4);
+
+    doc.replaceVariables(lookup);
+    std::string xml = doc.toString();
+    size_t ana = xml.find(">Ana<");
+    size_t bruno = xml.find(">Bruno<");
+    size_t carla = xml.find(">Carla<");
+    assert(ana != std::string::npos && ana < bruno && bruno < carla);
+    assert(xml.find(">[a]<") < xml.find(">[b]<"));
+    assert(xml.find("gone") == std::string::npos);
+    assert(xml.find(">G0:<") < xml.find(">(x)<"));
+    assert(xml.find(">(x)<") < xml.find(">G1:<"));
+    assert(xml.find(">G1:<") < xml.find(">(y)<") && xml.find(">(y)<") < xml.find(">(z)<"));
+    assert(xml.find("{{") == std::string::npos);
+
+    // Unbalanced markers are left alone
+    json2doc::XmlDocument broken;
+    assert(broken.loadFromString("<root><p>{{#rows}}{{name}}</p></root>"));
+    assert(broken.expandSections(sections, lookup) == 0);
+    assert(broken.toString().find("{{#rows}}{{name}}") != std::string::npos);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 22: Interned placeholder symbols
+void testSymbols()
+{
+    std::cout << "Test 22: Placeholder symbol table... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString("<root><a>{{name}} and {{ name }}</a><b>{{city}}</b><c><![CDATA[{{name}}]]></c><d>{{unknown}}</d></root>"));
+
+    const json2doc::SymbolTable &symbols = doc.getSymbols();
+    assert(symbols.size() == 3);
+    assert(symbols.name(0) == "name");
+    assert(symbols.name(1) == "city");
+    assert(symbols.name(2) == "unknown");
+    assert(symbols.find("city") == 1);
+    assert(symbols.find("missing") == json2doc::SymbolTable::npos);
+
+    // Bind by id; the unbound id keeps its placeholder
+    json2doc::SymbolValues values;
+    values.reset(symbols.size());
+    values.set(symbols.find("name"), "Ana");
+    values.set(symbols.find("city"), "");
+    assert(values.boundCount() == 2);
+    assert(doc.replaceVariables(values) == 4);
+
+    std::string xml = doc.toString();
+    assert(xml.find("Ana and Ana") != std::string::npos);
+    assert(xml.find("{{city}}") == std::string::npos);
+    assert(xml.find("Ana]]>") != std::string::npos);
+
+    // The index is rebuilt from the new text
+    assert(doc.getSymbols().size() == 1);
+    assert(doc.getSymbols().name(0) == "unknown");
+    assert(xml.find("{{unknown}}") != std::string::npos);
+
+    // The lookup overload resolves each distinct name once
+    assert(doc.loadFromString("<root><p>{{x}}{{x}}{{y}}</p><p>{{x}}</p></root>"));
+    int calls = 0;
+    int replaced = doc.replaceVariables([&calls](std::string_view name, std::string_view &value)
+                                        {
+                                            calls++;
+                                            value = name == "x" ? "1" : "2";
+                                            return true; });
+    assert(replaced == 4);
+    assert(calls == 2);
+    assert(doc.toString().find("112") != std::string::npos);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 23: Bound documents re-render only the nodes of changed variables
+void testIncrementalUpdate()
+{
+    std::cout << "Test 23: Incremental re-render... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString("<root><p>{{name}} in {{city}}</p><p>{{city}}</p><p>{{other}}</p><q>fixed</q></root>"));
+
+    std::map<std::string, std::string> data = {{"name", "Ana"}, {"city", "Lisboa"}};
+    auto lookup = [&data](std::string_view name, std::string_view &value)
+    {
+        auto it = data.find(std::string(name));
+        if (it == data.end())
+        {
+            return false;
+        }
+        value = it->second;
+        return true;
+    };
+
+    const json2doc::SymbolTable &symbols = doc.getSymbols();
+    json2doc::SymbolValues values;
+    values.reset(symbols.size());
+    for (uint32_t id = 0; id < symbols.size(); id++)
+    {
+        std::string_view value;
+        if (lookup(symbols.name(id), value))
+        {
+            values.set(id, value);
+        }
+    }
+    assert(doc.bindVariables(values) == 3);
+    assert(doc.isBound());
+    assert(doc.toString().find("Ana in Lisboa") != std::string::npos);
+
+    // Only the two nodes using {{city}} are rewritten
+    data["city"] = "Porto";
+    std::vector<std::string> paths;
+    assert(doc.updateVariables({symbols.find("city")}, lookup, &paths) == 2);
+    assert((paths == std::vector<std::string>{"/root/p[1]", "/root/p[2]"}));
+    std::string xml = doc.toString();
+    assert(xml.find("Ana in Porto") != std::string::npos);
+    assert(xml.find("<p>Porto</p>") != std::string::npos);
+    assert(xml.find("{{other}}") != std::string::npos);
+
+    // A variable that disappears brings its placeholder back
+    data.erase("name");
+    assert(doc.updateVariables({symbols.find("name")}, lookup) == 1);
+    assert(doc.toString().find("{{name}} in Porto") != std::string::npos);
+
+    // Unchanged output is not reported
+    assert(doc.updateVariables({symbols.find("other")}, lookup) == 0);
+
+    // Other edits end the binding
+    assert(doc.setNodeText("/root/q", "edited"));
+    assert(!doc.isBound());
+    assert(doc.updateVariables({0}, lookup) == -1);
+
+    // Through JsonMerge: patch the data, then update the bound document
+    json2doc::JsonMerge merger;
+    assert(merger.loadJsonString(R"({"title": "Report", "rows": [{"n": "a"}, {"n": "b"}], "meta": {"v": "1"}})"));
+    json2doc::XmlDocument report;
+    assert(report.loadFromString("<root><h>{{title}} v{{meta.v}}</h><t><r>{{#rows}}{{n}}{{/rows}}</r></t><f>{{meta.v}}</f></root>"));
+    assert(merger.bindToXml(report) == 5);
+
+    std::vector<std::string> keys = merger.applyPatch(R"({"meta": {"v": "2"}})");
+    assert((keys == std::vector<std::string>{"meta.v"}));
+    paths.clear();
+    assert(merger.updateXml(report, keys, &paths) == 2);
+    assert((paths == std::vector<std::string>{"/root/h", "/root/f"}));
+    xml = report.toString();
+    assert(xml.find("Report v2") != std::string::npos && xml.find("<f>2</f>") != std::string::npos);
+
+    // Replacing the array updates the expanded section copies
+    keys = merger.applyPatch(R"({"rows": [{"n": "x"}, {"n": "y"}]})");
+    assert(merger.updateXml(report, keys) == 2);
+    xml = report.toString();
+    assert(xml.find(">x<") < xml.find(">y<"));
+    assert(xml.find(">a<") == std::string::npos);
+
+    json2doc::XmlDocument unbound;
+    assert(unbound.loadFromString("<root>{{title}}</root>"));
+    assert(merger.updateXml(unbound, keys) == -1);
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 24: Compiled XPath cache and prepared queries
+void testXPathCache()
+{
+    std::cout << "Test 24: XPath cache and prepare()... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(createSampleXml()));
+
+    // Repeated strings are compiled once
+    assert(doc.query("//paragraph").size() == 2);
+    assert(doc.query("//paragraph").size() == 2);
+    assert(doc.getNode("/document/metadata/title").value == "Sample Document");
+    json2doc::XmlDocument::XPathCacheStats stats = doc.getXPathCacheStats();
+    assert(stats.misses == 2 && stats.hits == 1 && stats.entries == 2 && stats.capacity == 64);
+
+    // Prepared handles give the same results and work on other documents
+    json2doc::XmlDocument::XPathQuery title = doc.prepare("/document/metadata/title");
+    assert(title.isValid());
+    assert(title.getExpression() == "/document/metadata/title");
+    assert(doc.getNode(title).path == "/document/metadata/title");
+    assert(doc.setNodeText(title, "Renamed"));
+    assert(doc.getNode("/document/metadata/title").value == "Renamed");
+    assert(doc.setAttributeValue(title, "lang", "pt"));
+    assert(doc.getAttributeValue(title, "lang") == "pt");
+    assert(doc.replaceText(title, "Renamed", "Again") == 1);
+    assert(doc.findTextNodes(doc.prepare("/document/metadata/author")) == std::vector<std::string>{"John Doe"});
+
+    json2doc::XmlDocument other;
+    assert(other.loadFromString(createSampleXml()));
+    assert(other.getNode(title).value == "Sample Document");
+
+    // Invalid expressions are reported and not cached
+    json2doc::XmlDocument::XPathQuery bad = doc.prepare("!!not xpath");
+    assert(!bad.isValid());
+    assert(!doc.getLastError().empty());
+    assert(doc.query(bad).empty());
+    assert(doc.getNode(json2doc::XmlDocument::XPathQuery()).name.empty());
+
+    // Least recently used expressions are dropped first
+    doc.setXPathCacheCapacity(2);
+    assert(doc.getXPathCacheStats().entries == 2);
+    doc.query("/document/body");
+    doc.query("//paragraph");
+    doc.query("/document/metadata");
+    stats = doc.getXPathCacheStats();
+    assert(stats.entries == 2);
+    doc.query("//paragraph");
+    assert(doc.getXPathCacheStats().hits == stats.hits + 1);
+    doc.query("/document/body");
+    assert(doc.getXPathCacheStats().misses == stats.misses + 1);
+
+    doc.setXPathCacheCapacity(0);
+    assert(doc.getXPathCacheStats().entries == 0);
+    assert(doc.query("//paragraph").size() == 2);
+    assert(doc.getXPathCacheStats().entries == 0);
+    assert(title.isValid());
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 25: Lazy node handles
+void testNodeHandles()
+{
+    std::cout << "Test 25: Lazy node handles from select()... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(createSampleXml()));
+
+    json2doc::XmlDocument::NodeList paragraphs = doc.select("//paragraph");
+    assert(paragraphs.size() == 2 && paragraphs.isInline());
+    assert(paragraphs[0].name() == "paragraph");
+    assert(paragraphs[1].value() == "Your position is {{position}}.");
+
+    // Handles agree with the eager XmlNode copies of query()
+    std::vector<json2doc::XmlDocument::XmlNode> eager = doc.query("//paragraph");
+    json2doc::XmlDocument::XmlNode converted = paragraphs[0].toXmlNode("//paragraph");
+    assert(converted.value == eager[0].value && converted.fullText == eager[0].fullText);
+    assert(converted.path == eager[0].path && converted.name == eager[0].name);
+    assert(doc.selectNode("/document/metadata").fullText() == doc.query("/document/metadata")[0].fullText);
+
+    // Attributes are read in place
+    assert(doc.setAttributeValue("/document/metadata/title", "lang", "pt"));
+    json2doc::XmlDocument::NodeRef title = doc.selectNode("/document/metadata/title");
+    assert(title.isValid() && title.attribute("lang") == "pt" && title.attribute("missing").empty());
+    assert(title.attributes().size() == 1);
+    assert(!doc.selectNode("//nothing").isValid());
+    assert(doc.selectNode("//nothing").toXmlNode().name.empty());
+
+    // Past eight matches the list moves to the heap
+    std::string xml = "<list>";
+    for (int i = 0; i < 20; i++)
+    {
+        xml += "<item>" + std::to_string(i) + "</item>";
+    }
+    assert(doc.loadFromString(xml + "</list>"));
+    json2doc::XmlDocument::NodeList items = doc.select("//item");
+    assert(items.size() == 20 && !items.isInline());
+    json2doc::XmlDocument::NodeList moved(std::move(items));
+    assert(moved.size() == 20 && items.empty());
+    assert(moved[19].value() == "19");
+    std::cout << "✓ PASSED\n";
+}
+
+// Test 26: Template-node index with positional paths
+void testTemplateIndex()
+{
+    std::cout << "Test 26: Template-node index and positional paths... ";
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(createSampleXml()));
+
+    // Both paragraphs are named the same, so their paths need positions
+    auto nodes = doc.findTemplateNodes();
+    assert(nodes.size() == 2);
+    assert(nodes[0].path == "/document/body/paragraph[1]");
+    assert(nodes[1].path == "/document/body/paragraph[2]");
+    for (const auto &node : nodes)
+    {
+        assert(doc.getNode(node.path).value == node.value);
+    }
+    json2doc::XmlDocument::NodeList handles = doc.templateNodes();
+    assert(handles.size() == 2 && handles[1].value() == nodes[1].value);
+
+    // Replacing keeps the index: finished nodes drop out, placeholders
+    // coming from values are picked up
+    std::map<std::string, std::string> variables = {{"name", "Ana"}, {"company", "{{brand}}"}};
+    assert(doc.replaceVariables(variables) == 2);
+    nodes = doc.findTemplateNodes();
+    assert(nodes.size() == 2);
+    assert(nodes[0].value == "Hello Ana, welcome to {{brand}}!");
+    assert(doc.getSymbols().find("brand") != json2doc::SymbolTable::npos);
+    assert(doc.getSymbols().find("name") == json2doc::SymbolTable::npos);
+
+    variables = {{"brand", "ACME"}, {"position", "CTO"}};
+    assert(doc.replaceVariables(variables) == 2);
+    assert(doc.findTemplateNodes().empty() && doc.templateNodes().empty());
+
+    // Direct edits are indexed again on the next use
+    assert(doc.setNodeText(doc.prepare("/document/metadata/author"), "{{author}}"));
+    nodes = doc.findTemplateNodes();
+    assert(nodes.size() == 1 && nodes[0].path == "/document/metadata/author");
+    std::cout << "✓ PASSED\n";
+}
+
+std::string readFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+std::string readZipEntry(const std::string &archive, const std::string &entry)
+{
+    std::string command = "unzip -p \"" + archive + "\" \"" + entry + "\" 2>/dev/null";
+    FILE *pipe = popen(command.c_str(), "r");
+    assert(pipe != nullptr);
+    std::string result;
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+    {
+        result.append(buffer, count);
+    }
+    assert(pclose(pipe) == 0);
+    return result;
+}
+
+void testStreamingSave()
+{
+    std::cout << "Test 27: Streaming save to sinks and ZIP entries... ";
+    json2doc::XmlDocument doc;
+    json2doc::MemorySink unloaded;
+    assert(!doc.save(unloaded));
+    assert(doc.loadFromString(createSampleXml()));
+
+    // Raw output adds no whitespace; indented output matches toString()
+    json2doc::MemorySink raw;
+    assert(doc.save(raw));
+    std::string xml = raw.take();
+    assert(xml.find("<document><metadata><title>") != std::string::npos);
+    json2doc::MemorySink indented;
+    assert(doc.save(indented, json2doc::XmlDocument::SaveFormat::Indented));
+    assert(indented.view() == doc.toString());
+
+    json2doc::XmlDocument reloaded;
+    assert(reloaded.loadFromString(xml));
+    assert(reloaded.findTemplateNodes().size() == 2);
+
+    std::string base = "/tmp/test_xml_save_" + std::to_string(getpid());
+    assert(doc.saveToFile(base + ".xml"));
+    assert(readFile(base + ".xml") == xml);
+    assert(!doc.saveToFile("/nonexistent/dir/out.xml"));
+
+    // A package written entry by entry through a small stdio buffer
+    FILE *file = fopen((base + ".zip").c_str(), "wb");
+    assert(file != nullptr);
+    {
+        json2doc::FileSink sink(file, 7);
+        json2doc::ZipWriter zip(sink);
+        assert(zip.addEntry("content.xml", "<Types/>", json2doc::ZipWriter::Method::Store));
+        json2doc::OutputSink *entry = zip.beginEntry("word/document.xml");
+        assert(entry != nullptr);
+        assert(doc.save(*entry));
+        assert(zip.addEntry("word/empty.xml", ""));
+        assert(zip.finish());
+        assert(zip.beginEntry("late.xml") == nullptr);
+    }
+    assert(fclose(file) == 0);
+    assert(readZipEntry(base + ".zip", "content.xml") == "<Types/>");
+    assert(readZipEntry(base + ".zip", "word/document.xml") == xml);
+    assert(readZipEntry(base + ".zip", "word/empty.xml").empty());
+
+    std::remove((base + ".xml").c_str());
+    std::remove((base + ".zip").c_str());
+    std::cout << "✓ PASSED\n";
+}
+
+void testPreparedTemplate()
+{
+    std::cout << "Test 28: Prepared template copies... ";
+    json2doc::PreparedTemplate prepared;
+    json2doc::XmlDocument doc;
+    assert(!prepared.instantiate(doc) && !doc.isValid());
+    assert(!prepared.load("<broken>"));
+    assert(prepared.load(createSampleXml()));
+    assert((prepared.getVariables() == std::vector<std::string>{"name", "company", "position"}));
+
+    json2doc::XmlDocument parsed;
+    assert(parsed.loadFromString(createSampleXml()));
+
+    // A copy renders exactly like a freshly parsed document, and rendering
+    // it leaves the template untouched for the next copy
+    std::map<std::string, std::string> variables = {{"name", "Ana"}, {"company", "ACME"}, {"position", "CTO"}};
+    for (int round = 0; round < 2; round++)
+    {
+        assert(prepared.instantiate(doc));
+        assert(doc.toString() == parsed.toString());
+        auto nodes = doc.findTemplateNodes();
+        assert(nodes.size() == 2 && nodes[1].path == "/document/body/paragraph[2]");
+        assert(doc.getSymbols().size() == 3);
+        assert(doc.replaceVariables(variables) == 3);
+        assert(doc.findTemplateNodes().empty());
+    }
+    assert(parsed.replaceVariables(variables) == 3);
+    assert(doc.toString() == parsed.toString());
+
+    // An edited document is copied with its current index
+    json2doc::XmlDocument edited;
+    assert(edited.loadFromString(createSampleXml()));
+    assert(edited.setNodeText(edited.prepare("/document/metadata/title"), "{{title}}"));
+    assert(edited.getSymbols().size() == 4);
+    assert(doc.copyFrom(edited));
+    assert(doc.findTemplateNodes().size() == 3);
+    assert(doc.getNode(doc.findTemplateNodes()[0].path).value == "{{title}}");
+
+    json2doc::XmlDocument empty;
+    assert(!doc.copyFrom(empty) && !doc.isValid());
+    std::cout << "✓ PASSED\n";
+}
+
+void testSpliceTemplate()
+{
+    std::cout << "Test 29: Splice rendering without a DOM... ";
+
+    const std::string xml = createSampleXml();
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(xml));
+
+    // The template is kept as toString() writes it
+    json2doc::SpliceTemplate splice;
+    assert(splice.load(xml));
+    assert(splice.getXml() == doc.toString());
+    assert(splice.getSymbols().size() == 3 && splice.getPlaceholders().size() == 3);
+    for (const auto &placeholder : splice.getPlaceholders())
+    {
+        std::string_view name = splice.getSymbols().name(placeholder.symbol);
+        assert(splice.getXml().substr(placeholder.offset, placeholder.length) == "{{" + std::string(name) + "}}");
+    }
+
+    // Same bytes as replaceVariables() + toString(), including escaped values,
+    // unbound names and a value long enough to be gathered in place
+    std::vector<std::map<std::string, std::string>> cases = {
+        {{"name", "Ana"}, {"company", "ACME"}, {"position", "CTO"}},
+        {{"name", "R&D <team>"}, {"company", "{{name}}"}},
+        {{"position", std::string(10000, 'x') + "&"}},
+        {}};
+    for (const auto &variables : cases)
+    {
+        json2doc::XmlDocument expected;
+        assert(expected.loadFromString(xml));
+        int replacedDom = expected.replaceVariables(variables);
+        const std::string domOutput = expected.toString();
+
+        json2doc::MemorySink output;
+        assert(splice.render(variables, output) == replacedDom);
+        assert(output.view() == domOutput);
+
+        std::string path = "/tmp/test_splice_" + std::to_string(getpid()) + ".xml";
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        {
+            json2doc::FdSink sink(fd, 1024);
+            assert(splice.render(variables, sink) == replacedDom);
+        }
+        close(fd);
+        assert(readFile(path) == domOutput);
+        std::remove(path.c_str());
+    }
+
+    // Malformed or unsupported templates are rejected
+    assert(!splice.load("<a>{{x}}</b>") && !splice.isLoaded());
+    assert(!splice.load("<a/><b/>"));
+    assert(!splice.load("<a><!-- open</a>"));
+    assert(!splice.load("<a>{{x}}"));
+    assert(!splice.load("<a>{{a&amp;b}}</a>"));
+
+    // References are decoded at load, as the DOM decodes them
+    const std::string encoded = "<a>&#123;{x}} &lt;{{y}}&gt;</a>";
+    assert(splice.load(encoded));
+    std::map<std::string, std::string> values = {{"x", "1"}, {"y", "<2>"}};
+    json2doc::XmlDocument encodedDoc;
+    assert(encodedDoc.loadFromString(encoded));
+    json2doc::MemorySink encodedOutput;
+    assert(splice.render(values, encodedOutput) == encodedDoc.replaceVariables(values));
+    assert(encodedOutput.view() == encodedDoc.toString());
+    assert(splice.load("<a x=\"{{attr}}\"><![CDATA[{{c}}]]><!-- {{comment}} -->&amp;{{t}}</a>"));
+    assert(splice.getSymbols().size() == 2 && splice.getPlaceholders()[0].cdata);
+    std::cout << "✓ PASSED\n";
+}
+
+void testMergeSplitPlaceholders()
+{
+    std::cout << "Test 30: Placeholders split across Word runs... ";
+    const std::string xml =
+        "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>"
+        "<w:p><w:r><w:rPr><w:b/></w:rPr><w:t>Dear {{cust</w:t></w:r><w:proofErr w:type=\"spellStart\"/>"
+        "<w:r><w:t>omer.na</w:t></w:r><w:r><w:t xml:space=\"preserve\">me}}, </w:t></w:r>"
+        "<w:r><w:t>see {{date}}</w:t></w:r></w:p>"
+        "<w:p><w:r><w:t>{{a</w:t><w:tab/><w:t>b}}</w:t></w:r></w:p>"
+        "<w:p><w:r><w:t>{{x}</w:t></w:r><w:r><w:rPr><w:i/></w:rPr><w:t>} and {</w:t></w:r><w:r><w:t>{y}}</w:t></w:r></w:p>"
+        "</w:body></w:document>";
+
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(xml));
+    assert(doc.getSymbols().find("customer.name") == json2doc::SymbolTable::npos);
+    assert(doc.mergeSplitPlaceholders() == 3);
+    assert(doc.mergeSplitPlaceholders() == 0);
+
+    // The placeholder moved into the first run; the emptied run is gone
+    auto texts = doc.query("/w:document/w:body/w:p/w:r/w:t");
+    std::vector<std::string> values;
+    for (const auto &text : texts)
+    {
+        values.push_back(text.value);
+    }
+    assert((values == std::vector<std::string>{"Dear {{customer.name}}", ", ", "see {{date}}", "{{a", "b}}", "{{x}}",
+                                               " and {{y}}"}));
+    assert(texts[6].attributes.at("xml:space") == "preserve");
+    assert(doc.query("/w:document/w:body/w:p/w:r").size() == 6);
+
+    // The tab keeps {{a and b}} apart
+    assert(doc.getSymbols().find("ab") == json2doc::SymbolTable::npos);
+    std::map<std::string, std::string> variables = {{"customer.name", "Ana"}, {"date", "Mon"}, {"x", "1"}, {"y", "2"}};
+    assert(doc.replaceVariables(variables) == 4);
+
+    // Templates are merged once, when prepared
+    json2doc::PreparedTemplate prepared;
+    assert(prepared.load(xml));
+    assert((prepared.getVariables() == std::vector<std::string>{"customer.name", "date", "x", "y"}));
+    std::cout << "✓ PASSED\n";
+}
+
+void testTextTable()
+{
+    std::cout << "Test 31: Text run table... ";
+    const std::string xml =
+        "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>"
+        "<w:p><w:pPr><w:jc w:val=\"left\"/></w:pPr><w:r><w:rPr><w:b/></w:rPr><w:t>Hello </w:t></w:r>"
+        "<w:r><w:t>{{name}}</w:t></w:r></w:p>"
+        "<w:p><w:r><w:t>Box: </w:t><w:pict><w:p><w:r><w:t>inner</w:t></w:r></w:p></w:pict><w:t>after</w:t></w:r></w:p>"
+        "<w:p/><w:sectPr><w:pgSz w:w=\"12240\"/></w:sectPr>"
+        "</w:body></w:document>";
+
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(xml));
+    assert((doc.getParagraphTexts() == std::vector<std::string>{"Hello {{name}}", "Box: after", "inner", ""}));
+    // getTextContent() keeps its format: every element's text() and every text node, each followed by a space
+    assert(doc.getTextContent() == "Hello  Hello  {{name}} {{name}} Box:  Box:  inner inner after after ");
+    assert((doc.findTextNodes() == std::vector<std::string>{"Hello ", "{{name}}", "Box: ", "inner", "after"}));
+
+    // The table follows structural changes and copies
+    assert(doc.setNodeText("/w:document/w:body/w:p[3]", "new"));
+    assert(doc.getParagraphTexts().back() == "new");
+    std::map<std::string, std::string> variables = {{"name", "Ana"}};
+    assert(doc.replaceVariables(variables) == 1);
+    json2doc::XmlDocument copy;
+    assert(copy.copyFrom(doc));
+    doc.clear();
+    assert(copy.getTextContent() == "Hello  Hello  Ana Ana Box:  Box:  inner inner after after new new ");
+    assert(doc.getParagraphTexts().empty() && doc.getTextContent().empty());
+
+    // Outside WordprocessingML every text node stands alone
+    assert(doc.loadFromString("<a><b>one</b><c><![CDATA[two]]></c></a>"));
+    assert(doc.getTextContent() == "one one two two " && doc.getParagraphTexts().empty());
+
+    // An element's text comes before its descendants, even when it follows them
+    assert(doc.loadFromString("<a>top<b><c>deep</c>late</b>tail</a>"));
+    assert(doc.getTextContent() == "top top late deep deep late tail ");
+    std::cout << "✓ PASSED\n";
+}
+
+void testMemoryAccounting()
+{
+    std::cout << "Test 32: pugixml memory accounting and limit... ";
+    std::string xml = "<root>";
+    for (int i = 0; i < 2000; i++)
+    {
+        xml += "<item id=\"" + std::to_string(i) + "\">text {{v}}</item>";
+    }
+    xml += "</root>";
+
+    json2doc::XmlDocument doc;
+    assert(doc.getMemoryStats().bytes == 0 && doc.getMemoryStats().pages == 0);
+    assert(doc.loadFromString(xml));
+    json2doc::XmlDocument::MemoryStats stats = doc.getMemoryStats();
+    assert(stats.bytes > xml.size() && stats.pages > 0 && stats.peakBytes >= stats.bytes && stats.limit == 0);
+
+    // Edits are charged to the document that makes them
+    std::map<std::string, std::string> variables = {{"v", std::string(100, 'x')}};
+    assert(doc.replaceVariables(variables) == 2000);
+    assert(doc.getMemoryStats().peakBytes >= stats.bytes);
+
+    // Loads and copies over the limit fail and leave nothing behind
+    json2doc::XmlDocument limited;
+    limited.setMemoryLimit(stats.bytes / 2);
+    assert(!limited.loadFromString(xml) && !limited.isValid());
+    assert(limited.getLastError().find("Memory limit exceeded") != std::string::npos);
+    assert(limited.getMemoryStats().bytes == 0 && limited.getMemoryStats().limit == stats.bytes / 2);
+    assert(!limited.copyFrom(doc) && !limited.isValid());
+    assert(limited.getLastError().find("Memory limit exceeded") != std::string::npos);
+    assert(limited.getMemoryStats().bytes == 0);
+    limited.setMemoryLimit(0);
+    assert(limited.copyFrom(doc) && limited.getMemoryStats().pages > 0);
+    assert(limited.toString() == doc.toString());
+
+    // Freed pages are credited, and the peak restarts
+    doc.clear();
+    assert(doc.getMemoryStats().bytes == 0 && doc.getMemoryStats().pages == 0);
+    assert(doc.getMemoryStats().peakBytes == 0);
+    std::cout << "✓ PASSED\n";
+}
+
+void testEditBatch()
+{
+    std::cout << "Test 33: Batched text and attribute edits... ";
+    const std::string xml =
+        "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>"
+        "<w:p><w:pPr><w:jc w:val=\"left\"/></w:pPr><w:r><w:t>One</w:t></w:r></w:p>"
+        "<w:p><w:pPr><w:jc w:val=\"left\"/></w:pPr><w:r><w:t>Two {{x}}</w:t></w:r></w:p>"
+        "<w:p><w:r><w:t>Three</w:t></w:r></w:p>"
+        "</w:body></w:document>";
+
+    json2doc::EditBatch batch;
+    assert(batch.empty());
+    size_t first = batch.setText("/w:document/w:body/w:p/w:r/w:t", "First");
+    size_t all = batch.setAttribute("//w:jc", "w:val", "center", json2doc::EditBatch::Match::All);
+    size_t added = batch.setAttribute("/w:document/w:body/w:p[3]/w:r", "w:rsidR", "00A1");
+    size_t last = batch.setText("/w:document/w:body/w:p[3]/w:r/w:t", "Last", json2doc::EditBatch::Match::All);
+    size_t missing = batch.setText("//w:tbl", "none", json2doc::EditBatch::Match::All);
+    size_t invalid = batch.setText("not an xpath", "none");
+    batch.setText("/w:document/w:body/w:p/w:r/w:t", "Again", json2doc::EditBatch::Match::All);
+    assert(batch.size() == 7 && batch.getExpressions().size() == 6 && first == 0 && invalid == 5);
+
+    json2doc::XmlDocument doc;
+    assert(doc.loadFromString(xml));
+    assert(doc.getPlaceholderCount() == 1);
+    std::vector<size_t> hits = doc.applyEdits(batch);
+    assert((hits == std::vector<size_t>{1, 2, 1, 1, 0, 0, 3}));
+    assert(doc.getLastError().find("XPath error") != std::string::npos);
+    assert(hits[all] == 2 && hits[added] == 1 && hits[last] == 1 && hits[missing] == 0);
+
+    // The last operation on a node wins; the placeholder index follows the text
+    assert((doc.findTextNodes() == std::vector<std::string>{"Again", "Again", "Again"}));
+    assert(doc.query("//w:jc")[1].attributes.at("w:val") == "center");
+    assert(doc.getAttributeValue("/w:document/w:body/w:p[3]/w:r", "w:rsidR") == "00A1");
+    assert(doc.getPlaceholderCount() == 0);
+
+    // The batch keeps its compiled expressions for the next document, and
+    // gives the same result as the calls one at a time
+    json2doc::XmlDocument sequential;
+    assert(doc.loadFromString(xml) && sequential.loadFromString(xml));
+    assert(doc.applyEdits(batch) == hits);
+    assert(sequential.setNodeText("/w:document/w:body/w:p/w:r/w:t", "First"));
+    for (int i = 1; i <= 2; i++)
+    {
+        assert(sequential.setAttributeValue("/w:document/w:body/w:p[" + std::to_string(i) + "]/w:pPr/w:jc", "w:val",
+                                            "center"));
+    }
+    assert(sequential.setAttributeValue("/w:document/w:body/w:p[3]/w:r", "w:rsidR", "00A1"));
+    for (int i = 1; i <= 3; i++)
+    {
+        assert(sequential.setNodeText("/w:document/w:body/w:p[" + std::to_string(i) + "]/w:r/w:t", "Again"));
+    }
+    assert(doc.toString() == sequential.toString());
+    std::cout << "✓ PASSED\n";
+}
+
 int main()
 {
     std::cout << "\n";
@@ -399,6 +1126,32 @@ int main()
         testCount++;
         testPartialReplacement();
         testCount++;
+        testExpandSections();
+        testCount++;
+        testSymbols();
+        testCount++;
+        testIncrementalUpdate();
+        testCount++;
+        testXPathCache();
+        testCount++;
+        testNodeHandles();
+        testCount++;
+        testTemplateIndex();
+        testCount++;
+        testStreamingSave();
+        testCount++;
+        testPreparedTemplate();
+        testCount++;
+        testSpliceTemplate();
+        testCount++;
+        testMergeSplitPlaceholders();
+        testCount++;
+        testTextTable();
+        testCount++;
+        testMemoryAccounting();
+        testCount++;
+        testEditBatch();
+        testCount++;
     }
     catch (const std::exception &e)
     {